@@ -17,6 +17,8 @@
  * Author: Manuel Requena <manuel.requena@cttc.es>
  */
 
+#include "../scenario/lib/lte-epc-topology.h"
+
 #include "ns3/config-store.h"
 #include "ns3/core-module.h"
 #include "ns3/lte-module.h"
@@ -54,25 +56,22 @@ main(int argc, char* argv[])
     // Parse again so you can override default values from the command line
     cmd.Parse(argc, argv);
 
+    LteEpcTopology topology;
+    topology.SetUseEpc(false);
     if (useCa)
     {
-        Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(useCa));
-        Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(2));
-        Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager",
-                           StringValue("ns3::RrComponentCarrierManager"));
+        topology.SetCarrierAggregation(useCa);
     }
 
-    Ptr<LteHelper> lteHelper = CreateObject<LteHelper>();
+    // Create Nodes: eNodeB and UE
+    topology.Create(1, 1);
+    Ptr<LteHelper> lteHelper = topology.GetLteHelper();
+    NodeContainer enbNodes = topology.GetEnbNodes();
+    NodeContainer ueNodes = topology.GetUeNodes();
 
     // Uncomment to enable logging
     //  lteHelper->EnableLogComponents ();
 
-    // Create Nodes: eNodeB and UE
-    NodeContainer enbNodes;
-    NodeContainer ueNodes;
-    enbNodes.Create(1);
-    ueNodes.Create(1);
-
     // Install Mobility Model
     MobilityHelper mobility;
     mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
@@ -83,16 +82,14 @@ main(int argc, char* argv[])
     BuildingsHelper::Install(ueNodes);
 
     // Create Devices and install them in the Nodes (eNB and UE)
-    NetDeviceContainer enbDevs;
-    NetDeviceContainer ueDevs;
     // Default scheduler is PF, uncomment to use RR
     // lteHelper->SetSchedulerType ("ns3::RrFfMacScheduler");
 
-    enbDevs = lteHelper->InstallEnbDevice(enbNodes);
-    ueDevs = lteHelper->InstallUeDevice(ueNodes);
+    topology.InstallLteDevices();
+    NetDeviceContainer ueDevs = topology.GetUeDevices();
 
     // Attach a UE to a eNB
-    lteHelper->Attach(ueDevs, enbDevs.Get(0));
+    topology.Attach(0, 0);
 
     // Activate a data radio bearer
     EpsBearer::Qci q = EpsBearer::GBR_CONV_VOICE;
@@ -18,6 +18,10 @@
  *          Manuel Requena <manuel.requena@cttc.es>
  */
 
+#include "scenario/lib/lte-epc-topology.h"
+#include "scenario/lib/lte-trace-output.h"
+#include "scenario/lib/traffic-installer.h"
+
 #include "ns3/applications-module.h"
 #include "ns3/config-store-module.h"
 #include "ns3/core-module.h"
@@ -48,9 +52,11 @@ main(int argc, char* argv[])
     bool disableDl = false;
     bool disableUl = false;
     bool disablePl = false;
+    LteTraceOutput lteTraces;
 
     // Command line arguments
     CommandLine cmd(__FILE__);
+    lteTraces.AddCommandLineValues(cmd);
     cmd.AddValue("numNodePairs", "Number of eNodeBs + UE pairs", numNodePairs);
     cmd.AddValue("simTime", "Total duration of the simulation", simTime);
     cmd.AddValue("distance", "Distance between eNBs [m]", distance);
@@ -67,48 +73,20 @@ main(int argc, char* argv[])
     // parse again so you can override default values from the command line
     cmd.Parse(argc, argv);
 
+    LteEpcTopology topology;
     if (useCa)
     {
-        Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(useCa));
-        Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(2));
-        Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager",
-                           StringValue("ns3::RrComponentCarrierManager"));
+        topology.SetCarrierAggregation(useCa);
     }
+    topology.SetBackhaul(DataRate("100Gb/s"), 1500, MilliSeconds(10));
 
-    Ptr<LteHelper> lteHelper = CreateObject<LteHelper>();
-    Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper>();
-    lteHelper->SetEpcHelper(epcHelper);
-
-    Ptr<Node> pgw = epcHelper->GetPgwNode();
-
-    // Create a single RemoteHost
-    NodeContainer remoteHostContainer;
-    remoteHostContainer.Create(1);
-    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
-    InternetStackHelper internet;
-    internet.Install(remoteHostContainer);
-
-    // Create the Internet
-    PointToPointHelper p2ph;
-    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
-    p2ph.SetDeviceAttribute("Mtu", UintegerValue(1500));
-    p2ph.SetChannelAttribute("Delay", TimeValue(MilliSeconds(10)));
-    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
-    Ipv4AddressHelper ipv4h;
-    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
-    Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(internetDevices);
-    // interface 0 is localhost, 1 is the p2p device
-    Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress(1);
-
-    Ipv4StaticRoutingHelper ipv4RoutingHelper;
-    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
-        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
-    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
-
-    NodeContainer ueNodes;
-    NodeContainer enbNodes;
-    enbNodes.Create(numNodePairs);
-    ueNodes.Create(numNodePairs);
+    // EPC core, a single RemoteHost behind the Internet link, eNodeBs and UEs
+    topology.Create(numNodePairs, numNodePairs);
+    Ptr<LteHelper> lteHelper = topology.GetLteHelper();
+    Ptr<Node> remoteHost = topology.GetRemoteHost();
+    Ipv4Address remoteHostAddr = topology.GetRemoteHostAddress();
+    NodeContainer ueNodes = topology.GetUeNodes();
+    NodeContainer enbNodes = topology.GetEnbNodes();
 
     // Install Mobility Model
     Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
@@ -122,86 +100,45 @@ main(int argc, char* argv[])
     mobility.Install(enbNodes);
     mobility.Install(ueNodes);
 
-    // Install LTE Devices to the nodes
-    NetDeviceContainer enbLteDevs = lteHelper->InstallEnbDevice(enbNodes);
-    NetDeviceContainer ueLteDevs = lteHelper->InstallUeDevice(ueNodes);
-
-    // Install the IP stack on the UEs
-    internet.Install(ueNodes);
-    Ipv4InterfaceContainer ueIpIface;
-    ueIpIface = epcHelper->AssignUeIpv4Address(NetDeviceContainer(ueLteDevs));
-    // Assign IP address to UEs, and install applications
-    for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
-    {
-        Ptr<Node> ueNode = ueNodes.Get(u);
-        // Set the default gateway for the UE
-        Ptr<Ipv4StaticRouting> ueStaticRouting =
-            ipv4RoutingHelper.GetStaticRouting(ueNode->GetObject<Ipv4>());
-        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
-    }
+    // Install LTE Devices to the nodes, the IP stack and default routes to the UEs
+    topology.InstallLteDevices();
+    Ipv4InterfaceContainer ueIpIface = topology.GetUeInterfaces();
 
     // Attach one UE per eNodeB
     for (uint16_t i = 0; i < numNodePairs; i++)
     {
-        lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(i));
-        // side effect: the default EPS bearer will be activated
+        topology.Attach(i, i);
     }
 
-    // Install and start applications on UEs and remote host
+    // Install and start applications on UEs and remote host, one pass per direction
     uint16_t dlPort = 1100;
     uint16_t ulPort = 2000;
     uint16_t otherPort = 3000;
-    ApplicationContainer clientApps;
-    ApplicationContainer serverApps;
-    for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
+    std::vector<Ipv4Address> ueAddresses = TrafficInstaller::GetAddresses(ueIpIface);
+    TrafficInstaller traffic("ns3::UdpClient", "ns3::UdpSocketFactory");
+    traffic.SetClientAttribute("Interval", TimeValue(interPacketInterval));
+    traffic.SetClientAttribute("MaxPackets", UintegerValue(1000000));
+    traffic.SetStartTime(MilliSeconds(500));
+    if (!disableDl)
+    {
+        traffic.InstallDownlink(remoteHost, ueNodes, ueAddresses, dlPort);
+    }
+    if (!disableUl)
+    {
+        traffic.InstallUplink(ueNodes, remoteHost, remoteHostAddr, ulPort + 1);
+    }
+    if (!disablePl && numNodePairs > 1)
     {
-        if (!disableDl)
-        {
-            PacketSinkHelper dlPacketSinkHelper("ns3::UdpSocketFactory",
-                                                InetSocketAddress(Ipv4Address::GetAny(), dlPort));
-            serverApps.Add(dlPacketSinkHelper.Install(ueNodes.Get(u)));
-
-            UdpClientHelper dlClient(ueIpIface.GetAddress(u), dlPort);
-            dlClient.SetAttribute("Interval", TimeValue(interPacketInterval));
-            dlClient.SetAttribute("MaxPackets", UintegerValue(1000000));
-            clientApps.Add(dlClient.Install(remoteHost));
-        }
-
-        if (!disableUl)
-        {
-            ++ulPort;
-            PacketSinkHelper ulPacketSinkHelper("ns3::UdpSocketFactory",
-                                                InetSocketAddress(Ipv4Address::GetAny(), ulPort));
-            serverApps.Add(ulPacketSinkHelper.Install(remoteHost));
-
-            UdpClientHelper ulClient(remoteHostAddr, ulPort);
-            ulClient.SetAttribute("Interval", TimeValue(interPacketInterval));
-            ulClient.SetAttribute("MaxPackets", UintegerValue(1000000));
-            clientApps.Add(ulClient.Install(ueNodes.Get(u)));
-        }
-
-        if (!disablePl && numNodePairs > 1)
-        {
-            ++otherPort;
-            PacketSinkHelper packetSinkHelper("ns3::UdpSocketFactory",
-                                              InetSocketAddress(Ipv4Address::GetAny(), otherPort));
-            serverApps.Add(packetSinkHelper.Install(ueNodes.Get(u)));
-
-            UdpClientHelper client(ueIpIface.GetAddress(u), otherPort);
-            client.SetAttribute("Interval", TimeValue(interPacketInterval));
-            client.SetAttribute("MaxPackets", UintegerValue(1000000));
-            clientApps.Add(client.Install(ueNodes.Get((u + 1) % numNodePairs)));
-        }
+        traffic.InstallPeer(ueNodes, ueAddresses, otherPort + 1);
     }
 
-    serverApps.Start(MilliSeconds(500));
-    clientApps.Start(MilliSeconds(500));
-    lteHelper->EnableTraces();
+    lteTraces.Start(lteHelper);
     // Uncomment to enable PCAP tracing
-    // p2ph.EnablePcapAll("lena-simple-epc");
+    // topology.GetBackhaulHelper().EnablePcapAll("lena-simple-epc");
 
     Simulator::Stop(simTime);
     Simulator::Run();
+    lteTraces.Close();
 
     /*GtkConfigStore config;
     config.ConfigureAttributes();*/
@@ -21,6 +21,13 @@
 #include <fstream>
 #include <string>
 
+#include "scenario/lib/animation-output.h"
+#include "scenario/lib/flow-post-processor.h"
+#include "scenario/lib/flow-stats-sampler.h"
+#include "scenario/lib/lte-epc-topology.h"
+#include "scenario/lib/lte-trace-output.h"
+#include "scenario/lib/results-writer.h"
+
 #include "ns3/lte-helper.h"
 #include "ns3/epc-helper.h"
 #include "ns3/core-module.h"
@@ -53,21 +60,44 @@ int main(int argc, char *argv[]) {
   double distance = 60.0;
   double interPacketInterval = 100;
   bool useCa = false;
+  double flowSampleInterval = 0; // s
+  std::string resultsFile = "";
+  std::string resultsFormat = "binary";
+  bool flowmonXml = true;
+
+  // NetAnim output (--animation=off|mobility|sampled|full)
+  AnimationOutput animation;
+  animation.SetPollInterval (Seconds (1)); // step 1
+  animation.EnablePacketMetadata(true); // step 5
+
+  // LTE statistics (--lteTraces=off|ns3|async|binary|kpi)
+  LteTraceOutput lteTraces;
+
+  // Flow statistics, summary per class and the delay/datarate Gnuplot files
+  FlowPostProcessor post;
+  post.SetClasses("bulk9:9,bulk33:33");
+  post.SetPlots(true);
 
   // Command line arguments
   CommandLine cmd;
+  animation.AddCommandLineValues(cmd);
+  lteTraces.AddCommandLineValues(cmd);
+  post.AddCommandLineValues(cmd);
   cmd.AddValue("numberOfNodes", "Number of eNodeBs + UE pairs", numberOfNodes);
   cmd.AddValue("simTime", "Total duration of the simulation [s])", simTime);
   cmd.AddValue("distance", "Distance between eNBs [m]", distance);
   cmd.AddValue("interPacketInterval", "Inter packet interval [ms])", interPacketInterval);
   cmd.AddValue("useCa", "Whether to use carrier aggregation.", useCa);
+  cmd.AddValue("flowSampleInterval", "If > 0, sample per-flow statistics into the results every this many seconds [s]", flowSampleInterval);
+  cmd.AddValue("resultsFile", "If set, per-flow and per-interval results are written with this prefix", resultsFile);
+  cmd.AddValue("resultsFormat", "Format of the results file (binary or csv)", resultsFormat);
+  cmd.AddValue("flowmonXml", "Whether to write the full FlowMonitor XML file", flowmonXml);
   cmd.Parse(argc, argv);
 
-  if (useCa) {
-      Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(useCa));
-      Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(2));
-      Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager", StringValue("ns3::RrComponentCarrierManager"));
-  }
+  NS_ABORT_MSG_IF(flowSampleInterval > 0 && resultsFile.empty(), "Flow sampling writes into the results, set --resultsFile");
+
+  LteEpcTopology topology;
+  topology.SetCarrierAggregation (useCa);
 
   ConfigStore inputConfig;
   inputConfig.ConfigureDefaults();
@@ -75,45 +105,20 @@ int main(int argc, char *argv[]) {
   // parse again so you can override default values from the command line
   cmd.Parse(argc, argv);
 
-  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> (); // create LteHelper object
-  Ptr<PointToPointEpcHelper>  epcHelper = CreateObject<PointToPointEpcHelper> (); // PointToPointEpcHelper
-  lteHelper->SetEpcHelper (epcHelper); // enable the use of EPC by LTE helper
-
   /*
-   lteHelper->SetEnbDeviceAttribute("DlBandwidth", UintegerValue(25));
-   lteHelper->SetEnbDeviceAttribute("UlBandwidth", UintegerValue(25));
+   topology.SetBandwidth (25, 25);
    */
-  //std::cout << "param: " << lteHelper->m_enbNetDeviceFactory.m_parameters.Begin();
-
-  Ptr<Node> pgw = epcHelper->GetPgwNode (); // get the PGW node
-
-  // Create a single RemoteHost
-  NodeContainer remoteHostContainer; // container for remote node
-  remoteHostContainer.Create (1); // create 1 node
-  Ptr<Node> remoteHost = remoteHostContainer.Get (0);
-  InternetStackHelper internet;
-  internet.Install (remoteHostContainer); // aggregate stack implementations (ipv4, ipv6, udp, tcp) to remote node
-
-  // Create the Internet
-  PointToPointHelper p2ph;
-  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s"))); // p2p data rate
-  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (1500)); // p2p mtu
-  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0.010))); // p2p delay
-  NetDeviceContainer internetDevices = p2ph.Install (pgw, remoteHost);
-  Ipv4AddressHelper ipv4h;
-  ipv4h.SetBase ("1.0.0.0", "255.0.0.0"); // allocates IP addresses (network number and  mask), p2p interface
-  Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign (internetDevices); // assign IPs to each p2p device
-  // interface 0 is localhost, 1 is the p2p device
-  Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress (1);
-
-  Ipv4StaticRoutingHelper ipv4RoutingHelper;
-  Ptr<Ipv4StaticRouting> remoteHostStaticRouting = ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
-  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
-
-  NodeContainer ueNodes;
-  NodeContainer enbNodes;
-  enbNodes.Create(numberOf_eNodeBs); // create eNB nodes
-  ueNodes.Create(numberOfNodes); // create UE nodes
+
+  // EPC core, remote host behind a 100Gb/s p2p link (10 ms, mtu 1500), eNBs and UEs
+  topology.Create (numberOf_eNodeBs, numberOfNodes);
+  Ptr<LteHelper> lteHelper = topology.GetLteHelper ();
+
+  Ptr<Node> pgw = topology.GetPgw (); // get the PGW node
+  Ptr<Node> remoteHost = topology.GetRemoteHost ();
+  Ipv4Address remoteHostAddr = topology.GetRemoteHostAddress ();
+
+  NodeContainer ueNodes = topology.GetUeNodes ();
+  NodeContainer enbNodes = topology.GetEnbNodes ();
 
   // Install Mobility Model
   MobilityHelper mobility;
@@ -139,22 +144,8 @@ int main(int argc, char *argv[]) {
   mobility.Install(enbNodes);
   mobility.Install(ueNodes);
 
-  // Install LTE Devices to the nodes
-  NetDeviceContainer enbLteDevs = lteHelper->InstallEnbDevice (enbNodes); // add eNB nodes to the container
-  NetDeviceContainer ueLteDevs = lteHelper->InstallUeDevice (ueNodes); // add UE nodes to the container
-
-  // Install the IP stack on the UEs
-  internet.Install (ueNodes);
-  Ipv4InterfaceContainer ueIpIface;
-  ueIpIface = epcHelper->AssignUeIpv4Address (NetDeviceContainer (ueLteDevs));
-  // Assign IP address to UEs, and install applications
-  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
-    {
-      Ptr<Node> ueNode = ueNodes.Get (u);
-      // Set the default gateway for the UE
-      Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNode->GetObject<Ipv4> ());
-      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1); // default route
-    }
+  // Install LTE Devices to the nodes, the IP stack and default routes to the UEs
+  topology.InstallLteDevices ();
 
   // Attach one UE per eNodeB
   for (uint16_t i = 0; i < numberOfNodes; i++)
@@ -164,10 +155,10 @@ int main(int argc, char *argv[]) {
 
       if (i < 2) {
           //std::cout << "0 i: " << i << std::endl;
-          lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(0));
+          topology.Attach(i, 0);
       } else {
           //std::cout << "1 i: " << i << std::endl;
-          lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(0));
+          topology.Attach(i, 0);
       }
 
       // side effect: the default EPS bearer will be activated
@@ -216,125 +207,94 @@ int main(int argc, char *argv[]) {
   sinkApps2.Stop(Seconds(10.0));
 
   // enable traces
-  lteHelper->EnableTraces();
+  lteTraces.Start(lteHelper);
 
   // Animation definition
-  unsigned long long testValue = 0xFFFFFFFFFFFFFFFF;
   AnimationInterface::SetConstantPosition(remoteHost, 30, 50);
   AnimationInterface::SetConstantPosition(pgw, 30, 40);
-  AnimationInterface anim("rcasanovama.xml");
-
-  /// Optional steps
-  anim.SetMobilityPollInterval (Seconds (1)); // step 1
-  anim.EnablePacketMetadata(true); // step 5
-
-  //*R
-  anim.SetMaxPktsPerTraceFile(testValue);
-  anim.UpdateNodeDescription(pgw, "PGW");
-  anim.UpdateNodeDescription(remoteHost, "Remote_Host");
-  // anim.UpdateNodeDescription(ueNodes.Get(0), "Ue_Dev");
-  // anim.UpdateNodeDescription(enbNodes.Get(0), "eNodeB");
-
   for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
     {
-      anim.UpdateNodeDescription(ueNodes.Get(u), "Ue_" + std::to_string(u));
       AnimationInterface::SetConstantPosition(ueNodes.Get(u), 10 + 15 * u, 20);
-      anim.UpdateNodeColor(ueNodes.Get(u), 0, 0, 255); // Optional
-   }
-
+    }
   for (uint32_t u = 0; u < enbNodes.GetN(); ++u)
     {
-      anim.UpdateNodeDescription(enbNodes.Get(u), "eNodeB_" + std::to_string(u));
-      anim.UpdateNodeColor(enbNodes.Get(u), 0, 255, 0); // Optional
       AnimationInterface::SetConstantPosition(enbNodes.Get(u), 10 + 40 * u, 30);
     }
 
+  //*R
+  if (AnimationInterface* anim = animation.Start("rcasanovama.xml"))
+    {
+      anim->UpdateNodeDescription(pgw, "PGW");
+      anim->UpdateNodeDescription(remoteHost, "Remote_Host");
+      // anim->UpdateNodeDescription(ueNodes.Get(0), "Ue_Dev");
+      // anim->UpdateNodeDescription(enbNodes.Get(0), "eNodeB");
+
+      for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
+        {
+          anim->UpdateNodeDescription(ueNodes.Get(u), "Ue_" + std::to_string(u));
+          anim->UpdateNodeColor(ueNodes.Get(u), 0, 0, 255); // Optional
+        }
+
+      for (uint32_t u = 0; u < enbNodes.GetN(); ++u)
+        {
+          anim->UpdateNodeDescription(enbNodes.Get(u), "eNodeB_" + std::to_string(u));
+          anim->UpdateNodeColor(enbNodes.Get(u), 0, 255, 0); // Optional
+        }
+    }
+
   // Uncomment to enable PCAP tracing
-  // p2ph.EnablePcapAll("lte-full");
+  // topology.GetBackhaulHelper().EnablePcapAll("lte-full");
 
   Ptr <FlowMonitor> monitor; // = flowMonHelper.InstallAll();
   FlowMonitorHelper flowMonHelper;
   monitor = flowMonHelper.Install(enbNodes);
   monitor = flowMonHelper.Install(ueNodes);
   monitor = flowMonHelper.Install(remoteHost);
+  Ptr <Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+
+  ResultsWriter results;
+  if (!resultsFile.empty()) {
+      results.SetFormat(ResultsWriter::ParseFormat(resultsFormat));
+      results.AddParameter("numberOfNodes", numberOfNodes);
+      results.AddParameter("simTime", simTime);
+      results.AddParameter("useCa", useCa);
+      results.AddParameter("RngSeed", RngSeedManager::GetSeed());
+      results.AddParameter("RngRun", RngSeedManager::GetRun());
+      results.Open(resultsFile);
+  }
+
+  // Time series of the flows, written while the simulation runs
+  FlowStatsSampler flowSampler;
+  if (flowSampleInterval > 0) {
+      flowSampler.SetInterval(Seconds(flowSampleInterval));
+      flowSampler.Start(monitor, &results);
+  }
 
   Simulator::Stop(Seconds(simTime));
   Simulator::Run();
-
-  // GnuPlot
-  std::string jmenoSouboru = "delay";
-  std::string graphicsFileName = jmenoSouboru + ".png";
-  std::string plotFileName = jmenoSouboru + ".plt";
-  std::string plotTitle = "Average delay";
-  std::string dataTitle = "Delay [ms]";
-  Gnuplot gnuplot(graphicsFileName);
-  gnuplot.SetTitle(plotTitle);
-  gnuplot.SetTerminal("png");
-  gnuplot.SetLegend("IDs of data streams", "Delay [ms]");
-  gnuplot.AppendExtra("set xrange [1:" + std::to_string(numberOfNodes * 2) + "]");
-  gnuplot.AppendExtra("set yrange [0:100]");
-  gnuplot.AppendExtra("set grid");
-  Gnuplot2dDataset dataset;
-
-  jmenoSouboru = "datarate";
-  graphicsFileName = jmenoSouboru + ".png";
-  std::string plotFileNameDR = jmenoSouboru + ".plt";
-  plotTitle = "Data rate for IDs";
-  dataTitle = "Data rate [kbps]";
-  Gnuplot gnuplot_DR(graphicsFileName);
-  gnuplot_DR.SetTitle(plotTitle);
-  gnuplot_DR.SetTerminal("png");
-  gnuplot_DR.SetLegend("IDs of all streams", "Data rate [kbps]");
-  gnuplot_DR.AppendExtra("set xrange [1:" + std::to_string(numberOfNodes * 2) + "]");
-  gnuplot_DR.AppendExtra("set yrange [0:1000]");
-  gnuplot_DR.AppendExtra("set grid");
-  Gnuplot2dDataset dataset_rate;
+  flowSampler.Stop();
+  lteTraces.Close();
 
   monitor->CheckForLostPackets();
-  Ptr <Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
-  std::map <FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
-
-  monitor->SerializeToXmlFile("manetrouting.flowmon", true, true);
-
-  std::cout << std::endl << "*** Flow monitor statistic ***" << std::endl;
-  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin(); i != stats.end(); ++i) {
-
-      // if (i-> first > 2) {
-      double Delay, DataRate;
-      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
-      std::cout << "Flow ID: " << i->first << std::endl;
-      std::cout << "Src add: " << t.sourceAddress << "-> Dst add: " << t.destinationAddress << std::endl;
-      std::cout << "Src port: " << t.sourcePort << "-> Dst port: " << t.destinationPort << std::endl;
-      std::cout << "Tx Packets/Bytes: " << i->second.txPackets << "/" << i->second.txBytes << std::endl;
-      std::cout << "Rx Packets/Bytes: " << i->second.rxPackets << "/" << i->second.rxBytes << std::endl;
-      std::cout << "Throughput: " << i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds()) / 1024 << "kb/s" << std::endl;
-      std::cout << "Delay sum: " << i->second.delaySum.GetMilliSeconds() << "ms" << std::endl;
-      std::cout << "Mean delay: " << (i->second.delaySum.GetSeconds() / i->second.rxPackets) * 1000 << "ms" << std::endl;
-
-      // gnuplot Delay
-      Delay = (i->second.delaySum.GetSeconds() / i->second.rxPackets) * 1000;
-      DataRate = i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds()) / 1024;
-
-      dataset.Add((double) i->first, (double) Delay);
-      dataset_rate.Add((double) i->first, (double) DataRate);
-      std::cout << "Jitter sum: " << i->second.jitterSum.GetMilliSeconds() << "ms" << std::endl;
-      std::cout << "Mean jitter: " << (i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1)) * 1000 << "ms" << std::endl;
-      // std::cout << "Lost Packets: " << i->second.lostPackets << std::endl;
-      std::cout << "Lost Packets: " << i->second.txPackets - i->second.rxPackets << std::endl;
-      std::cout << "Packet loss: " << (((i->second.txPackets - i->second.rxPackets) * 1.0) / i->second.txPackets) * 100 << "%" << std::endl;
-      std::cout << "------------------------------------------------" << std::endl;
 
+  if (flowmonXml) {
+      monitor->SerializeToXmlFile("manetrouting.flowmon", true, true);
   }
 
-  // Gnuplot - continuation
-  gnuplot.AddDataset(dataset);
-  std::ofstream plotFile(plotFileName.c_str());
-  gnuplot.GenerateOutput(plotFile);
-  plotFile.close();
-  gnuplot_DR.AddDataset(dataset_rate);
-  std::ofstream plotFileDR(plotFileNameDR.c_str());
-  gnuplot_DR.GenerateOutput(plotFileDR);
-  plotFileDR.close();
+  post.Process(monitor, classifier);
+  if (results.IsOpen()) {
+      for (const FlowRecord& flow : post.GetFlows()) {
+          results.Write(flow);
+      }
+  }
+  post.Print(std::cout);
+  results.Close();
+
+  // delay.plt and datarate.plt, on the axes the plots always had
+  std::string xrange = "set xrange [1:" + std::to_string(numberOfNodes * 2) + "]";
+  post.AppendPlotExtra(xrange, xrange);
+  post.AppendPlotExtra("set yrange [0:100]", "set yrange [0:1000]");
+  post.WritePlots();
 
   Simulator::Destroy();
   return 0;
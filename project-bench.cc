@@ -0,0 +1,233 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Wall-clock and event-rate benchmark of the project scenario.
+//
+// Builds and runs the scenario of project.cc (topology, mobility, video and FTP
+// flows and a FlowMonitor, but no NetAnim, pcap or printing) for every
+// combination of --ues and --enbs, and reports per configuration the setup and
+// run wall-clock time, simulated seconds per wall-clock second, the number of
+// events processed and the peak resident set size. Every configuration runs in
+// a forked process, one at a time, so the peak RSS is its own and runs do not
+// compete for cores. The other project parameters (--simTime, --useCa, ...)
+// apply to every configuration; --numberOfUes and --numberOfEnbs are replaced
+// by the lists. The layout defaults to --layout=hex, which spreads the UEs
+// over all eNB sites.
+//
+// The report is a CSV file with one row per run; --label tags the rows, e.g.
+// with the revision being measured, so reports can be concatenated and compared.
+//
+//   ./ns3 run "project-bench --ues=15,60,240,1000 --enbs=3,10,30 --layout=hex --label=<revision>"
+
+#include "scenario/lib/phase-timer.h"
+#include "scenario/lib/project-scenario.h"
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ProjectBench");
+
+/// Measurements of one benchmark run, passed from the child through a pipe
+struct BenchResult
+{
+    double setupSeconds{0};        //!< wall time to build the scenario [s]
+    double applicationsSeconds{0}; //!< part of the setup installing the applications [s]
+    double runSeconds{0};          //!< wall time of Simulator::Run() [s]
+    uint64_t events{0};            //!< events executed
+    uint64_t peakRssKb{0};         //!< peak resident set size [KiB]
+};
+
+/**
+ * Split a comma separated list of numbers.
+ *
+ * \param text the list
+ * \return the numbers
+ */
+static std::vector<uint16_t>
+ParseList(const std::string& text)
+{
+    std::vector<uint16_t> values;
+    std::stringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (!token.empty())
+        {
+            values.push_back(std::stoul(token));
+        }
+    }
+    return values;
+}
+
+/**
+ * Build and run the scenario once, in the calling process.
+ *
+ * \param params the scenario parameters
+ * \param flowMonitor whether to install a FlowMonitor like project does
+ * \return the measurements
+ */
+static BenchResult
+RunScenario(const ProjectParameters& params, bool flowMonitor)
+{
+    using Clock = std::chrono::steady_clock;
+    BenchResult result;
+
+    // Only a handful of setup phases, for the applicationsSeconds column
+    PhaseTimer::Enable();
+    auto start = Clock::now();
+    ProjectScenario scenario(params);
+    scenario.ConfigureDefaults();
+    scenario.Build();
+    FlowMonitorHelper flowMonHelper;
+    if (flowMonitor)
+    {
+        LteEpcTopology& topology = scenario.GetTopology();
+        flowMonHelper.Install(topology.GetEnbNodes());
+        flowMonHelper.Install(topology.GetUeNodes());
+        flowMonHelper.Install(topology.GetRemoteHost());
+    }
+    auto built = Clock::now();
+
+    Simulator::Stop(Seconds(params.simTime));
+    Simulator::Run();
+    auto finished = Clock::now();
+
+    result.setupSeconds = std::chrono::duration<double>(built - start).count();
+    result.applicationsSeconds = PhaseTimer::GetSeconds("InstallApplications");
+    result.runSeconds = std::chrono::duration<double>(finished - built).count();
+    result.events = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    // ru_maxrss is in KiB on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKb = usage.ru_maxrss;
+    return result;
+}
+
+/**
+ * Run the scenario in a child process and collect its measurements.
+ *
+ * \param params the scenario parameters
+ * \param flowMonitor whether to install a FlowMonitor
+ * \param result the measurements, valid if true is returned
+ * \return whether the child completed
+ */
+static bool
+RunChild(const ProjectParameters& params, bool flowMonitor, BenchResult& result)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+
+    std::cout.flush();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        BenchResult r = RunScenario(params, flowMonitor);
+        bool ok = write(fds[1], &r, sizeof(r)) == static_cast<ssize_t>(sizeof(r));
+        close(fds[1]);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t n = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return n == static_cast<ssize_t>(sizeof(result)) && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    ProjectParameters params;
+    params.simTime = 10.0;
+    // The line layout keeps the UEs in a fixed box while its eNBs go on along
+    // x, so larger eNB counts would only add unreachable cells
+    params.layout = "hex";
+    std::string ues = "15,60,240,1000";
+    std::string enbs = "3,10,30";
+    uint32_t repetitions = 1;
+    bool flowMonitor = true;
+    std::string report = "project-bench.csv";
+    std::string label = "";
+
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    cmd.AddValue("ues", "Comma separated list of UE counts", ues);
+    cmd.AddValue("enbs", "Comma separated list of eNB counts", enbs);
+    cmd.AddValue("repetitions", "Runs of every configuration", repetitions);
+    cmd.AddValue("flowMonitor", "Whether to install a FlowMonitor like project", flowMonitor);
+    cmd.AddValue("report", "CSV file receiving the measurements", report);
+    cmd.AddValue("label", "Tag written in every row of the report", label);
+    cmd.Parse(argc, argv);
+
+    std::ofstream out(report);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << report);
+    out << "label,numberOfUes,numberOfEnbs,simTime,repetition,status,setupSeconds,"
+           "applicationsSeconds,runSeconds,simSecondsPerWallSecond,events,eventsPerWallSecond,"
+           "peakRssKb\n";
+
+    for (uint16_t numberOfEnbs : ParseList(enbs))
+    {
+        for (uint16_t numberOfUes : ParseList(ues))
+        {
+            params.numberOfUes = numberOfUes;
+            params.numberOfEnbs = numberOfEnbs;
+            for (uint32_t rep = 0; rep < repetitions; rep++)
+            {
+                std::cout << numberOfUes << " UEs, " << numberOfEnbs << " eNBs, run " << rep
+                          << ": " << std::flush;
+
+                BenchResult r;
+                bool ok = RunChild(params, flowMonitor, r);
+                out << label << "," << numberOfUes << "," << numberOfEnbs << ","
+                    << params.simTime << "," << rep << "," << (ok ? "ok" : "failed");
+                if (!ok)
+                {
+                    out << ",,,,,,,\n";
+                    std::cout << "FAILED\n";
+                    continue;
+                }
+                double rate = params.simTime / r.runSeconds;
+                double eventRate = r.events / r.runSeconds;
+                out << "," << r.setupSeconds << "," << r.applicationsSeconds << ","
+                    << r.runSeconds << "," << rate << ","
+                    << r.events << "," << eventRate << "," << r.peakRssKb << "\n";
+                out.flush();
+                std::cout << r.setupSeconds << " s setup (" << r.applicationsSeconds
+                          << " s applications), " << r.runSeconds << " s run, "
+                          << rate << " sim-s/s, " << r.events << " events, " << r.peakRssKb
+                          << " KiB peak RSS\n";
+            }
+        }
+    }
+    std::cout << "Report written to " << report << std::endl;
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Distributed (MPI) run of the project scenario.
+//
+// The scenario of project.cc split over two ranks: rank 0 simulates the EPC
+// core, the eNBs and the UEs with their LTE devices and applications, rank 1
+// the remote host with the video servers. The LTE spectrum channel and the
+// zero-delay S1 links cannot be cut, so the PGW - remote host link is the only
+// partition boundary and its 10 ms delay the lookahead. Run with one rank the
+// program behaves like project.cc without the output options.
+//
+// Requires ns-3 configured with --enable-mpi:
+//
+//   mpirun -np 2 ./build/scratch/ns3.39-project-mpi-default --simTime=30
+//   mpirun -np 2 ./build/scratch/ns3.39-project-mpi-default --nullmsg=true
+
+#include "scenario/lib/project-scenario.h"
+
+#include "ns3/config-store-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ProjectMpi");
+
+#ifdef NS3_MPI
+
+int
+main(int argc, char* argv[])
+{
+    ProjectParameters params;
+    bool nullmsg = false;
+    bool printFlows = true;
+
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    cmd.AddValue("nullmsg",
+                 "Use the null message instead of the granted time window algorithm",
+                 nullmsg);
+    cmd.AddValue("printFlows",
+                 "Whether to print the per-flow statistics of every rank",
+                 printFlows);
+    cmd.Parse(argc, argv);
+
+    GlobalValue::Bind("SimulatorImplementationType",
+                      StringValue(nullmsg ? "ns3::NullMessageSimulatorImpl"
+                                          : "ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(&argc, &argv);
+    uint32_t systemId = MpiInterface::GetSystemId();
+    uint32_t systemCount = MpiInterface::GetSize();
+    NS_ABORT_MSG_IF(systemCount > 2, "The project scenario splits into at most 2 ranks");
+
+    ProjectScenario scenario(params);
+    scenario.ConfigureDefaults();
+    ConfigStore inputConfig;
+    inputConfig.ConfigureDefaults();
+    cmd.Parse(argc, argv);
+
+    scenario.SetPartition(systemId, systemCount);
+    scenario.Build();
+
+    // Probes only on the nodes simulated by this rank
+    LteEpcTopology& topology = scenario.GetTopology();
+    FlowMonitorHelper flowMonHelper;
+    Ptr<FlowMonitor> monitor;
+    if (scenario.IsRadioLocal())
+    {
+        flowMonHelper.Install(topology.GetEnbNodes());
+        monitor = flowMonHelper.Install(topology.GetUeNodes());
+    }
+    if (scenario.IsRemoteHostLocal())
+    {
+        monitor = flowMonHelper.Install(topology.GetRemoteHost());
+    }
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+
+    Simulator::Stop(Seconds(params.simTime));
+    Simulator::Run();
+
+    // A flow crossing the partition is seen sending on one rank and receiving
+    // on the other, so only the local half of its counters is meaningful here
+    monitor->CheckForLostPackets();
+    if (printFlows)
+    {
+        std::cout << "\n*** Rank " << systemId << " of " << systemCount << " ***\n";
+        for (const auto& [flowId, stats] : monitor->GetFlowStats())
+        {
+            Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flowId);
+            std::cout << "Flow " << flowId << " (" << t.sourceAddress << ":" << t.sourcePort
+                      << " -> " << t.destinationAddress << ":" << t.destinationPort << ")\n";
+            std::cout << "Tx Packets: " << stats.txPackets << "\n";
+            std::cout << "Rx Packets: " << stats.rxPackets << "\n";
+            std::cout << "Rx Bytes: " << stats.rxBytes << "\n";
+            std::cout << "------------------------------------------------\n";
+        }
+    }
+
+    Simulator::Destroy();
+    MpiInterface::Disable();
+    return 0;
+}
+
+#else
+
+int
+main(int argc, char* argv[])
+{
+    std::cerr << "project-mpi requires ns-3 configured with --enable-mpi" << std::endl;
+    return 1;
+}
+
+#endif
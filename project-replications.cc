@@ -0,0 +1,347 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Independent replications of the project scenario in one invocation.
+//
+// Runs the scenario of project.cc --replications times with consecutive RngRun
+// values starting at --firstRun, either one after the other in this process
+// (default, resetting the simulator between replications) or each in a forked
+// child (--fork=true, full isolation at the cost of a fork per replication).
+// Module registration and ConfigStore parsing happen once. At the end the
+// throughput, delay, jitter and loss of every flow, identified by its
+// five-tuple, are aggregated into mean, standard deviation and 95% confidence
+// interval over the replications and written to a CSV file.
+//
+//   ./ns3 run "project-replications --replications=10 --simTime=30"
+
+#include "scenario/lib/convergence-detector.h"
+#include "scenario/lib/project-scenario.h"
+#include "scenario/lib/results-writer.h"
+#include "scenario/lib/running-stats.h"
+
+#include "ns3/config-store-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ProjectReplications");
+
+/// Options applying to every replication
+struct ReplicationOptions
+{
+    std::string resultsFile;   //!< per-replication results prefix, empty for none
+    std::string resultsFormat; //!< results format
+    bool stopOnConvergence;    //!< stop each replication on convergence
+};
+
+/// Metrics of one flow in one replication
+struct FlowSample
+{
+    std::string flow;      //!< five-tuple of the flow
+    double throughputKbps; //!< throughput [kb/s]
+    double meanDelayMs;    //!< mean delay [ms]
+    double meanJitterMs;   //!< mean jitter [ms]
+    double lossPercent;    //!< packet loss [%]
+};
+
+/// Aggregated metrics of one flow
+struct FlowSummary
+{
+    RunningStats throughputKbps; //!< throughput [kb/s]
+    RunningStats meanDelayMs;    //!< mean delay [ms]
+    RunningStats meanJitterMs;   //!< mean jitter [ms]
+    RunningStats lossPercent;    //!< packet loss [%]
+};
+
+/**
+ * \param r a flow record
+ * \return "src:port>dst:port/protocol", stable across replications
+ */
+static std::string
+FlowKey(const FlowRecord& r)
+{
+    std::ostringstream oss;
+    oss << r.srcAddress << ":" << r.srcPort << ">" << r.dstAddress << ":" << r.dstPort << "/"
+        << static_cast<uint32_t>(r.protocol);
+    return oss.str();
+}
+
+/**
+ * Build and run one replication in this process.
+ *
+ * \param scenario the scenario, reused across replications
+ * \param run the RngRun of the replication
+ * \param options the replication options
+ * \return the flows of the replication
+ */
+static std::vector<FlowSample>
+RunReplication(ProjectScenario& scenario, uint32_t run, const ReplicationOptions& options)
+{
+    const ProjectParameters& params = scenario.GetParameters();
+    RngSeedManager::SetRun(run);
+    // Simulator::Destroy() keeps the stream counter; without a reset, every
+    // replication after the first would draw on other streams than
+    // project --RngRun=<run> does
+    RngSeedManager::ResetNextStreamIndex();
+
+    ResultsWriter results;
+    if (!options.resultsFile.empty())
+    {
+        results.SetFormat(ResultsWriter::ParseFormat(options.resultsFormat));
+        params.AddResultsParameters(results);
+        results.Open(options.resultsFile + "-r" + std::to_string(run));
+    }
+
+    scenario.Build();
+    LteEpcTopology& topology = scenario.GetTopology();
+    FlowMonitorHelper flowMonHelper;
+    flowMonHelper.Install(topology.GetEnbNodes());
+    flowMonHelper.Install(topology.GetUeNodes());
+    Ptr<FlowMonitor> monitor = flowMonHelper.Install(topology.GetRemoteHost());
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+
+    ConvergenceDetector convergence;
+    if (options.stopOnConvergence)
+    {
+        convergence.Start(monitor);
+    }
+    Simulator::Stop(Seconds(params.simTime));
+    Simulator::Run();
+    convergence.Stop();
+
+    monitor->CheckForLostPackets();
+    std::vector<FlowSample> flows;
+    for (const auto& [flowId, stats] : monitor->GetFlowStats())
+    {
+        FlowRecord r = MakeFlowRecord(flowId, classifier->FindFlow(flowId), stats);
+        if (results.IsOpen())
+        {
+            results.Write(r);
+        }
+        flows.push_back(
+            {FlowKey(r), r.throughputKbps, r.meanDelayMs, r.meanJitterMs, r.lossPercent});
+    }
+    results.Close();
+
+    std::cout << "Replication RngRun=" << run << ": " << flows.size() << " flows";
+    if (convergence.HasConverged())
+    {
+        std::cout << ", converged at " << convergence.GetConvergenceTime().GetSeconds() << " s";
+    }
+    std::cout << std::endl;
+
+    Simulator::Destroy();
+    return flows;
+}
+
+/**
+ * Run one replication in a forked child, which sends its flows back as text.
+ *
+ * \param scenario the scenario
+ * \param run the RngRun of the replication
+ * \param options the replication options
+ * \param flows the flows of the replication
+ * \return whether the child completed
+ */
+static bool
+RunForked(ProjectScenario& scenario,
+          uint32_t run,
+          const ReplicationOptions& options,
+          std::vector<FlowSample>& flows)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+
+    std::cout.flush();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        std::ostringstream oss;
+        oss.precision(17);
+        for (const auto& f : RunReplication(scenario, run, options))
+        {
+            oss << f.flow << " " << f.throughputKbps << " " << f.meanDelayMs << " "
+                << f.meanJitterMs << " " << f.lossPercent << "\n";
+        }
+        std::cout.flush();
+        std::string text = oss.str();
+        std::size_t written = 0;
+        while (written < text.size())
+        {
+            ssize_t n = write(fds[1], text.data() + written, text.size() - written);
+            if (n <= 0)
+            {
+                _exit(1);
+            }
+            written += n;
+        }
+        close(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    std::string text;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        text.append(buffer, n);
+    }
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return false;
+    }
+
+    std::istringstream in(text);
+    FlowSample f;
+    while (in >> f.flow >> f.throughputKbps >> f.meanDelayMs >> f.meanJitterMs >> f.lossPercent)
+    {
+        flows.push_back(f);
+    }
+    return true;
+}
+
+/**
+ * Write mean, standard deviation and CI half-width of a metric.
+ *
+ * \param out the output
+ * \param stats the metric
+ */
+static void
+WriteStats(std::ostream& out, const RunningStats& stats)
+{
+    out << "," << stats.GetMean() << "," << stats.GetStddev() << ","
+        << stats.GetConfidenceHalfWidth();
+}
+
+int
+main(int argc, char* argv[])
+{
+    ProjectParameters params;
+    uint32_t replications = 10;
+    uint32_t firstRun = 1;
+    bool useFork = false;
+    std::string output = "project-replications.csv";
+    ReplicationOptions options{"", "csv", false};
+
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    cmd.AddValue("replications", "Number of independent replications", replications);
+    cmd.AddValue("firstRun", "RngRun of the first replication", firstRun);
+    cmd.AddValue("fork", "Whether to run every replication in a forked child", useFork);
+    cmd.AddValue("output", "CSV file receiving the per-flow aggregates", output);
+    cmd.AddValue("resultsFile",
+                 "If set, per-replication results are written with this prefix and -r<RngRun>",
+                 options.resultsFile);
+    cmd.AddValue("resultsFormat",
+                 "Format of the results files (binary or csv)",
+                 options.resultsFormat);
+    cmd.AddValue("stopOnConvergence",
+                 "Whether to stop every replication once its flow metrics have converged",
+                 options.stopOnConvergence);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(replications == 0, "Nothing to run");
+
+    ProjectScenario scenario(params);
+    scenario.ConfigureDefaults();
+    ConfigStore inputConfig;
+    inputConfig.ConfigureDefaults();
+    cmd.Parse(argc, argv);
+
+    // Aggregates per flow, in order of first appearance
+    std::vector<std::string> order;
+    std::map<std::string, FlowSummary> summaries;
+    uint32_t completed = 0;
+    for (uint32_t run = firstRun; run < firstRun + replications; run++)
+    {
+        std::vector<FlowSample> flows;
+        if (useFork)
+        {
+            if (!RunForked(scenario, run, options, flows))
+            {
+                std::cout << "Replication RngRun=" << run << " FAILED" << std::endl;
+                continue;
+            }
+        }
+        else
+        {
+            flows = RunReplication(scenario, run, options);
+        }
+        completed++;
+
+        for (const auto& f : flows)
+        {
+            auto [it, inserted] = summaries.try_emplace(f.flow);
+            if (inserted)
+            {
+                order.push_back(f.flow);
+            }
+            it->second.throughputKbps.Add(f.throughputKbps);
+            it->second.meanDelayMs.Add(f.meanDelayMs);
+            it->second.meanJitterMs.Add(f.meanJitterMs);
+            it->second.lossPercent.Add(f.lossPercent);
+        }
+    }
+
+    std::ofstream out(output);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << output);
+    out << "flow,replications";
+    for (const char* metric : {"throughputKbps", "meanDelayMs", "meanJitterMs", "lossPercent"})
+    {
+        out << "," << metric << "Mean," << metric << "Stddev," << metric << "Ci95";
+    }
+    out << "\n";
+
+    std::cout << "\n*** " << completed << " replications, mean +- 95% CI per flow ***\n";
+    for (const auto& flow : order)
+    {
+        const FlowSummary& s = summaries[flow];
+        out << flow << "," << s.throughputKbps.GetCount();
+        WriteStats(out, s.throughputKbps);
+        WriteStats(out, s.meanDelayMs);
+        WriteStats(out, s.meanJitterMs);
+        WriteStats(out, s.lossPercent);
+        out << "\n";
+
+        std::cout << flow << " (" << s.throughputKbps.GetCount() << " replications)\n";
+        std::cout << "Throughput: " << s.throughputKbps.GetMean() << " +- "
+                  << s.throughputKbps.GetConfidenceHalfWidth() << " kb/s\n";
+        std::cout << "Mean delay: " << s.meanDelayMs.GetMean() << " +- "
+                  << s.meanDelayMs.GetConfidenceHalfWidth() << " ms\n";
+        std::cout << "Mean jitter: " << s.meanJitterMs.GetMean() << " +- "
+                  << s.meanJitterMs.GetConfidenceHalfWidth() << " ms\n";
+        std::cout << "Packet loss: " << s.lossPercent.GetMean() << " +- "
+                  << s.lossPercent.GetConfidenceHalfWidth() << "%\n";
+        std::cout << "------------------------------------------------\n";
+    }
+    std::cout << "Aggregates written to " << output << std::endl;
+    return completed == replications ? 0 : 1;
+}
@@ -0,0 +1,422 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Parameter sweep driver for project.cc.
+//
+// Every parameter takes a comma separated list of values; the sweep runs the
+// cartesian product of all lists, once per RngRun value. Instead of a grid, a
+// parameter file with one set per line ("numberOfUes=60 distance=500 ...") can
+// be given. Runs are executed as separate project processes, at most --jobs at
+// a time (default: one per core), and the per-run flow results written via
+// project's --resultsFile are merged into a single CSV table. The output options
+// the sweep passes (CSV results, no printing, NetAnim or pcap) come before the
+// swept parameters, which may override them. Input files of project
+// (--scenario, --ns3::ConfigStore::Filename) and other values that are paths
+// to existing files (containing a '/') are made absolute, since every run
+// works in its own directory.
+//
+//   ./ns3 run "project-sweep --numberOfUes=15,30 --distance=300,500 --runs=1-5"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ProjectSweep");
+
+/// One project invocation of the sweep
+struct SweepRun
+{
+    uint32_t id;                                            //!< index in the sweep
+    std::vector<std::pair<std::string, std::string>> params; //!< --name=value pairs
+    uint32_t rngRun;                                        //!< value of --RngRun
+    pid_t pid{-1};                                          //!< worker process
+    int status{-1};                                         //!< exit status
+};
+
+/**
+ * Split a string on a separator, dropping empty tokens.
+ *
+ * \param text the string to split
+ * \param sep the separator
+ * \return the tokens
+ */
+static std::vector<std::string>
+Split(const std::string& text, char sep)
+{
+    std::vector<std::string> tokens;
+    std::stringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, sep))
+    {
+        if (!token.empty())
+        {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+/**
+ * Parse a list of RngRun values such as "1,2,5-8".
+ *
+ * \param text the list
+ * \return the run numbers
+ */
+static std::vector<uint32_t>
+ParseRuns(const std::string& text)
+{
+    std::vector<uint32_t> runs;
+    for (const auto& token : Split(text, ','))
+    {
+        std::size_t dash = token.find('-');
+        if (dash == std::string::npos)
+        {
+            runs.push_back(std::stoul(token));
+            continue;
+        }
+        uint32_t first = std::stoul(token.substr(0, dash));
+        uint32_t last = std::stoul(token.substr(dash + 1));
+        NS_ABORT_MSG_IF(last < first, "Bad run range " << token);
+        for (uint32_t r = first; r <= last; r++)
+        {
+            runs.push_back(r);
+        }
+    }
+    return runs;
+}
+
+/**
+ * \param path a path, relative to the working directory or absolute
+ * \return the absolute path
+ */
+static std::string
+GetAbsolutePath(const std::string& path)
+{
+    if (!path.empty() && path.front() == '/')
+    {
+        return path;
+    }
+    char cwd[4096];
+    NS_ABORT_MSG_IF(getcwd(cwd, sizeof(cwd)) == nullptr, "getcwd() failed");
+    return std::string(cwd) + "/" + path;
+}
+
+/**
+ * \param name a parameter name
+ * \param value its value
+ * \return whether the value is a relative path to an existing input file
+ */
+static bool
+IsRelativeInputFile(const std::string& name, const std::string& value)
+{
+    // A bare value like "1" is a number, even if a file of that name exists
+    bool fileParameter = name == "scenario" || name == "ns3::ConfigStore::Filename";
+    bool path = value.find('/') != std::string::npos;
+    return (fileParameter || path) && !value.empty() && value.front() != '/' &&
+           access(value.c_str(), F_OK) == 0;
+}
+
+/**
+ * Start one project process for a run inside its own directory below outputDir;
+ * the console output of the run goes to output.log there.
+ *
+ * \param program absolute path of the project executable
+ * \param run the run to start
+ * \param outputDir directory for the per-run directories
+ */
+static void
+StartRun(const std::string& program, SweepRun& run, const std::string& outputDir)
+{
+    std::string runDir = outputDir + "/run-" + std::to_string(run.id);
+    mkdir(runDir.c_str(), 0755);
+
+    // The sweep's defaults come first, so that the parameters can override them
+    std::vector<std::string> args{program,
+                                  "--resultsFile=results",
+                                  "--resultsFormat=csv",
+                                  "--printFlows=false",
+                                  "--animation=off",
+                                  "--pcap=off"};
+    for (const auto& [name, value] : run.params)
+    {
+        args.push_back("--" + name + "=" + value);
+    }
+    args.push_back("--RngRun=" + std::to_string(run.rngRun));
+
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        // Every run writes its traces into its own directory
+        if (chdir(runDir.c_str()) != 0)
+        {
+            _exit(127);
+        }
+        int log = open("output.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0)
+        {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+            close(log);
+        }
+        std::vector<char*> argv;
+        for (auto& arg : args)
+        {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    run.pid = pid;
+}
+
+int
+main(int argc, char* argv[])
+{
+    // Parameters of project.cc that can be swept; each one is a list of values
+    std::vector<std::pair<std::string, std::string>> axes{{"numberOfUes", ""},
+                                                          {"numberOfEnbs", ""},
+                                                          {"distance", ""},
+                                                          {"txPower", ""},
+                                                          {"walkSpeed", ""},
+                                                          {"interval", ""},
+                                                          {"useCa", ""},
+                                                          {"simTime", ""}};
+    std::string runList = "1";
+    std::string paramFile = "";
+    std::string program = "";
+    std::string outputDir = "project-sweep";
+    std::string output = "project-sweep.csv";
+    uint32_t jobs = 0;
+
+    CommandLine cmd(__FILE__);
+    for (auto& [name, values] : axes)
+    {
+        cmd.AddValue(name, "Comma separated values of project's --" + name, values);
+    }
+    cmd.AddValue("runs", "RngRun values to repeat every parameter set with, e.g. 1-10", runList);
+    cmd.AddValue("paramFile",
+                 "File with one parameter set per line (name=value ...), replaces the grid",
+                 paramFile);
+    cmd.AddValue("program", "Path of the project executable", program);
+    cmd.AddValue("outputDir", "Directory for the per-run output directories", outputDir);
+    cmd.AddValue("output", "Merged flow statistics table", output);
+    cmd.AddValue("jobs", "Number of parallel runs, 0 for one per core", jobs);
+    cmd.Parse(argc, argv);
+
+    if (program.empty())
+    {
+        // project is built next to this executable with the same name decoration
+        program = argv[0];
+        std::size_t pos = program.rfind("project-sweep");
+        NS_ABORT_MSG_IF(pos == std::string::npos, "Cannot guess the project path, use --program");
+        program.replace(pos, std::string("project-sweep").size(), "project");
+    }
+    program = GetAbsolutePath(program);
+    outputDir = GetAbsolutePath(outputDir);
+    NS_ABORT_MSG_IF(access(program.c_str(), X_OK) != 0, "Cannot execute " << program);
+
+    if (jobs == 0)
+    {
+        jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // Parameter sets, either from the file or as the cartesian product of the lists
+    std::vector<std::vector<std::pair<std::string, std::string>>> paramSets;
+    if (!paramFile.empty())
+    {
+        std::ifstream in(paramFile);
+        NS_ABORT_MSG_IF(!in.is_open(), "Cannot open " << paramFile);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::vector<std::pair<std::string, std::string>> params;
+            std::stringstream ss(line);
+            std::string token;
+            while (ss >> token)
+            {
+                std::size_t eq = token.find('=');
+                NS_ABORT_MSG_IF(eq == std::string::npos, "Expected name=value, got " << token);
+                std::size_t start = token.find_first_not_of('-');
+                params.emplace_back(token.substr(start, eq - start), token.substr(eq + 1));
+            }
+            paramSets.push_back(params);
+        }
+    }
+    else
+    {
+        paramSets.emplace_back();
+        for (const auto& [name, values] : axes)
+        {
+            if (values.empty())
+            {
+                continue;
+            }
+            std::vector<std::vector<std::pair<std::string, std::string>>> expanded;
+            for (const auto& set : paramSets)
+            {
+                for (const auto& value : Split(values, ','))
+                {
+                    expanded.push_back(set);
+                    expanded.back().emplace_back(name, value);
+                }
+            }
+            paramSets = expanded;
+        }
+    }
+
+    // Runs execute in their own directories; input files such as --scenario
+    // or --ns3::ConfigStore::Filename must still be found there
+    for (auto& params : paramSets)
+    {
+        for (auto& [name, value] : params)
+        {
+            if (IsRelativeInputFile(name, value))
+            {
+                value = GetAbsolutePath(value);
+            }
+        }
+    }
+
+    std::vector<SweepRun> runs;
+    for (const auto& params : paramSets)
+    {
+        for (uint32_t rngRun : ParseRuns(runList))
+        {
+            runs.push_back({static_cast<uint32_t>(runs.size()), params, rngRun});
+        }
+    }
+    NS_ABORT_MSG_IF(runs.empty(), "Nothing to run");
+
+    mkdir(outputDir.c_str(), 0755);
+    std::cout << "Running " << runs.size() << " simulations, " << jobs << " at a time"
+              << std::endl;
+
+    // Worker pool: keep up to 'jobs' processes busy until every run has finished
+    std::map<pid_t, SweepRun*> active;
+    std::size_t next = 0;
+    std::size_t done = 0;
+    while (done < runs.size())
+    {
+        while (active.size() < jobs && next < runs.size())
+        {
+            StartRun(program, runs[next], outputDir);
+            active[runs[next].pid] = &runs[next];
+            next++;
+        }
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            continue;
+        }
+        auto it = active.find(pid);
+        if (it == active.end())
+        {
+            continue;
+        }
+        SweepRun* run = it->second;
+        active.erase(it);
+        run->status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        done++;
+        std::cout << "[" << done << "/" << runs.size() << "] run " << run->id
+                  << (run->status == 0 ? " finished" : " FAILED") << std::endl;
+    }
+
+    // Merge the per-run tables. The rows of project's results already carry its
+    // own parameters; swept names it does not know (e.g. attributes) are added.
+    std::ofstream merged(output);
+    NS_ABORT_MSG_IF(!merged.is_open(), "Cannot open " << output);
+    std::vector<std::string> columns;
+    bool header = false;
+    uint32_t failed = 0;
+    for (const auto& run : runs)
+    {
+        std::ifstream in(outputDir + "/run-" + std::to_string(run.id) + "/results-flows.csv");
+        if (run.status != 0 || !in.is_open())
+        {
+            failed++;
+            continue;
+        }
+        std::string line;
+        std::getline(in, line);
+        if (!header)
+        {
+            std::vector<std::string> known = Split(line, ',');
+            for (const auto& r : runs)
+            {
+                for (const auto& param : r.params)
+                {
+                    if (std::find(known.begin(), known.end(), param.first) == known.end() &&
+                        std::find(columns.begin(), columns.end(), param.first) == columns.end())
+                    {
+                        columns.push_back(param.first);
+                    }
+                }
+            }
+            merged << "run";
+            for (const auto& column : columns)
+            {
+                merged << "," << column;
+            }
+            merged << "," << line << "\n";
+            header = true;
+        }
+        std::ostringstream prefix;
+        prefix << run.id;
+        for (const auto& column : columns)
+        {
+            prefix << ",";
+            for (const auto& param : run.params)
+            {
+                if (param.first == column)
+                {
+                    prefix << param.second;
+                }
+            }
+        }
+        prefix << ",";
+        while (std::getline(in, line))
+        {
+            merged << prefix.str() << line << "\n";
+        }
+    }
+
+    std::cout << "Merged " << runs.size() - failed << " runs into " << output;
+    if (failed > 0)
+    {
+        std::cout << ", " << failed << " failed (see " << outputDir << "/run-*/output.log)";
+    }
+    std::cout << std::endl;
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Warm start of the project scenario from an attached network.
+//
+// ns-3 cannot serialize its object graph, so the snapshot is the process
+// itself: the network of project.cc is built without applications and run
+// until every UE has completed its RRC connection and default bearer setup
+// (at the latest until the applications would start at 2 s). Then one child
+// per traffic variant is forked from that state; each child installs its
+// applications and runs to --simTime, the parent only pays the startup once.
+// The copies share memory with the parent until they write to it.
+//
+// Variants set traffic parameters only (interval, packet and data sizes,
+// trafficMix), "name=value" separated by spaces, variants separated by ';' or
+// given one per line in --variantFile:
+//
+//   ./ns3 run "project-warmstart --variants='interval=20;interval=10 videoPacketSize=1000'"
+
+#include "scenario/lib/project-scenario.h"
+#include "scenario/lib/results-writer.h"
+
+#include "ns3/config-store-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/lte-module.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ProjectWarmStart");
+
+/// IMSIs of the UEs whose RRC connection was reconfigured with their bearer
+static std::set<uint64_t> g_attached;
+
+/// Number of UEs to wait for
+static uint32_t g_ues = 0;
+
+/// Stop once every bearer is set up
+static EventId g_snapshot;
+
+/// Stop when the applications would start
+static EventId g_deadline;
+
+/// Stop the simulation at the snapshot point
+static void
+TakeSnapshot()
+{
+    Simulator::Stop();
+}
+
+/**
+ * LteEnbRrc ConnectionReconfiguration sink; schedules the snapshot once every
+ * UE has its default bearer.
+ *
+ * \param context the trace context
+ * \param imsi the UE's IMSI
+ * \param cellId the cell
+ * \param rnti the UE's RNTI
+ */
+static void
+BearerSetUp(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    // With carrier aggregation a UE is reconfigured more than once
+    bool inserted = g_attached.insert(imsi).second;
+    if (inserted && g_attached.size() == g_ues)
+    {
+        // Leave the reconfiguration the time to complete
+        g_snapshot = Simulator::Schedule(MilliSeconds(10), &TakeSnapshot);
+    }
+}
+
+/**
+ * Split the variants given inline and in a file.
+ *
+ * \param list variants separated by ';'
+ * \param filename file with one variant per line, empty for none
+ * \return the variants
+ */
+static std::vector<std::string>
+ReadVariants(const std::string& list, const std::string& filename)
+{
+    std::vector<std::string> variants;
+    std::stringstream ss(list);
+    std::string variant;
+    while (std::getline(ss, variant, ';'))
+    {
+        variants.push_back(variant);
+    }
+    if (!filename.empty())
+    {
+        std::ifstream in(filename);
+        NS_ABORT_MSG_IF(!in.is_open(), "Cannot open " << filename);
+        while (std::getline(in, variant))
+        {
+            if (!variant.empty() && variant[0] != '#')
+            {
+                variants.push_back(variant);
+            }
+        }
+    }
+    return variants;
+}
+
+/**
+ * Apply a variant's "name=value" pairs to the parameters.
+ *
+ * \param variant the variant
+ * \param params the parameters
+ */
+static void
+ApplyVariant(const std::string& variant, ProjectParameters& params)
+{
+    ProjectParameters network = params;
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    std::vector<std::string> args{"project-warmstart"};
+    std::istringstream in(variant);
+    std::string assignment;
+    while (in >> assignment)
+    {
+        args.push_back("--" + assignment);
+    }
+    cmd.Parse(args);
+
+    // The network already exists, only the traffic can change
+    NS_ABORT_MSG_IF(params.numberOfUes != network.numberOfUes ||
+                        params.numberOfEnbs != network.numberOfEnbs ||
+                        params.dlBandwidth != network.dlBandwidth ||
+                        params.upBandwidth != network.upBandwidth ||
+                        params.distance != network.distance || params.txPower != network.txPower ||
+                        params.walkSpeed != network.walkSpeed || params.useCa != network.useCa ||
+                        params.layout != network.layout || params.clusters != network.clusters ||
+                        params.clusterRadius != network.clusterRadius ||
+                        params.pathlossCache != network.pathlossCache ||
+                        params.positionStore != network.positionStore ||
+                        params.cullThreshold != network.cullThreshold ||
+                        params.simTime != network.simTime,
+                    "Variant \"" << variant << "\" changes more than the traffic parameters");
+}
+
+/**
+ * Install a variant's applications in the forked copy of the network and
+ * run it to the end.
+ *
+ * \param scenario the scenario, attached
+ * \param variant the variant
+ * \param id index of the variant
+ * \param resultsFile results prefix, empty for none
+ * \param resultsFormat results format
+ */
+static void
+RunVariant(ProjectScenario& scenario,
+           const std::string& variant,
+           uint32_t id,
+           const std::string& resultsFile,
+           const std::string& resultsFormat)
+{
+    ProjectParameters& params = scenario.GetParameters();
+    ApplyVariant(variant, params);
+
+    ResultsWriter results;
+    if (!resultsFile.empty())
+    {
+        results.SetFormat(ResultsWriter::ParseFormat(resultsFormat));
+        params.AddResultsParameters(results);
+        results.Open(resultsFile + "-v" + std::to_string(id));
+    }
+
+    scenario.InstallApplications();
+    LteEpcTopology& topology = scenario.GetTopology();
+    FlowMonitorHelper flowMonHelper;
+    flowMonHelper.Install(topology.GetEnbNodes());
+    flowMonHelper.Install(topology.GetUeNodes());
+    Ptr<FlowMonitor> monitor = flowMonHelper.Install(topology.GetRemoteHost());
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+
+    Simulator::Stop(Seconds(params.simTime) - Simulator::Now());
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    double throughputKbps = 0;
+    uint32_t flows = 0;
+    for (const auto& [flowId, stats] : monitor->GetFlowStats())
+    {
+        FlowRecord r = MakeFlowRecord(flowId, classifier->FindFlow(flowId), stats);
+        if (results.IsOpen())
+        {
+            results.Write(r);
+        }
+        throughputKbps += r.throughputKbps;
+        flows++;
+    }
+    results.Close();
+    std::cout << "Variant " << id << " (" << variant << "): " << flows
+              << " flows, total throughput " << throughputKbps << " kb/s" << std::endl;
+    Simulator::Destroy();
+}
+
+int
+main(int argc, char* argv[])
+{
+    ProjectParameters params;
+    std::string variants = "";
+    std::string variantFile = "";
+    std::string resultsFile = "";
+    std::string resultsFormat = "csv";
+
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    cmd.AddValue("variants",
+                 "Traffic variants separated by ';', each a list of name=value",
+                 variants);
+    cmd.AddValue("variantFile", "File with one traffic variant per line", variantFile);
+    cmd.AddValue("resultsFile",
+                 "If set, per-variant results are written with this prefix and -v<index>",
+                 resultsFile);
+    cmd.AddValue("resultsFormat", "Format of the results files (binary or csv)", resultsFormat);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> variantList = ReadVariants(variants, variantFile);
+    if (variantList.empty())
+    {
+        // The traffic of the command line
+        variantList.emplace_back("");
+    }
+
+    ProjectScenario scenario(params);
+    scenario.ConfigureDefaults();
+    ConfigStore inputConfig;
+    inputConfig.ConfigureDefaults();
+    cmd.Parse(argc, argv);
+
+    // Run the network up to the attachment of every UE
+    scenario.BuildNetwork();
+    g_ues = params.numberOfUes;
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionReconfiguration",
+                    MakeCallback(&BearerSetUp));
+    g_deadline = Simulator::Schedule(Seconds(2.0), &TakeSnapshot);
+    Simulator::Run();
+    // Whichever did not fire would stop the variants
+    g_snapshot.Cancel();
+    g_deadline.Cancel();
+    Config::Disconnect("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionReconfiguration",
+                       MakeCallback(&BearerSetUp));
+    std::cout << "Snapshot at " << Simulator::Now().GetSeconds() << " s, " << g_attached.size()
+              << " of " << g_ues << " UEs attached, " << Simulator::GetEventCount()
+              << " events" << std::endl;
+
+    uint32_t failed = 0;
+    for (uint32_t id = 0; id < variantList.size(); id++)
+    {
+        std::cout.flush();
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+        if (pid == 0)
+        {
+            RunVariant(scenario, variantList[id], id, resultsFile, resultsFormat);
+            std::cout.flush();
+            _exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cout << "Variant " << id << " FAILED" << std::endl;
+            failed++;
+        }
+    }
+
+    Simulator::Destroy();
+    return failed == 0 ? 0 : 1;
+}
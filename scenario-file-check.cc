@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Check of the [flows] parser of ScenarioFile.
+//
+// Writes a scenario file with a udp, a bulk and an application TypeId flow,
+// loads it and compares the parsed flows with the expected ones. Files whose
+// flow type is unknown or not an application must be rejected; each of those
+// is loaded in a forked child, which has to abort. The program aborts on the
+// first mismatch and prints "ok" otherwise.
+//
+//   ./ns3 run scenario-file-check
+
+#include "scenario/lib/scenario-file.h"
+
+#include "ns3/core-module.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ScenarioFileCheck");
+
+/**
+ * Write a scenario file with one [flows] section.
+ *
+ * \param filename the file
+ * \param flows the lines of the section
+ */
+static void
+WriteFlows(const std::string& filename, const std::string& flows)
+{
+    std::ofstream out(filename);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << filename);
+    out << "[flows]\n" << flows;
+}
+
+/**
+ * \param filename a scenario file
+ * \return whether loading it in a child process aborts
+ */
+static bool
+IsRejected(const std::string& filename)
+{
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        ScenarioFile file;
+        file.Load(filename);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string filename = "scenario-file-check.scenario";
+
+    CommandLine cmd;
+    cmd.AddValue("file", "Scratch scenario file written by the check", filename);
+    cmd.Parse(argc, argv);
+
+    WriteFlows(filename,
+               "udp from=remote to=ue:0 port=100 Interval=20ms\n"
+               "bulk from=ue:1 to=remote port=21 start=3 stop=9\n"
+               "ns3::OnOffApplication from=remote to=ue:2 port=5000 socket=udp "
+               "DataRate=1Mbps\n");
+    ScenarioFile file;
+    file.Load(filename);
+    const std::vector<FlowSpec>& flows = file.GetFlows();
+    NS_ABORT_MSG_IF(flows.size() != 3, "Expected 3 flows, parsed " << flows.size());
+
+    NS_ABORT_MSG_IF(flows[0].client != "ns3::UdpClient" ||
+                        flows[0].socketFactory != "ns3::UdpSocketFactory" ||
+                        flows[0].from != "remote" || flows[0].to != "ue:0" ||
+                        flows[0].port != 100 || flows[0].attributes.size() != 1 ||
+                        flows[0].attributes[0].first != "Interval" ||
+                        flows[0].attributes[0].second != "20ms",
+                    "Wrong udp flow");
+    NS_ABORT_MSG_IF(flows[1].client != "ns3::BulkSendApplication" ||
+                        flows[1].socketFactory != "ns3::TcpSocketFactory" ||
+                        flows[1].port != 21 || flows[1].start != 3 || flows[1].stop != 9,
+                    "Wrong bulk flow");
+    NS_ABORT_MSG_IF(flows[2].client != "ns3::OnOffApplication" ||
+                        flows[2].socketFactory != "ns3::UdpSocketFactory" ||
+                        flows[2].port != 5000 || flows[2].attributes.size() != 1 ||
+                        flows[2].attributes[0].first != "DataRate",
+                    "Wrong TypeId flow");
+
+    WriteFlows(filename, "ns3::NoSuchApplication from=remote to=ue:0 port=1 socket=udp\n");
+    NS_ABORT_MSG_IF(!IsRejected(filename), "An unknown flow type was accepted");
+    WriteFlows(filename, "ns3::Node from=remote to=ue:0 port=1 socket=udp\n");
+    NS_ABORT_MSG_IF(!IsRejected(filename), "A flow type that is no application was accepted");
+
+    std::remove(filename.c_str());
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "animation-output.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AnimationOutput");
+
+AnimationOutput::Mode
+AnimationOutput::ParseMode(const std::string& name)
+{
+    if (name == "off")
+    {
+        return OFF;
+    }
+    if (name == "mobility")
+    {
+        return MOBILITY;
+    }
+    if (name == "sampled")
+    {
+        return SAMPLED;
+    }
+    if (name == "full")
+    {
+        return FULL;
+    }
+    NS_FATAL_ERROR("Unknown animation mode " << name << ", use off, mobility, sampled or full");
+}
+
+AnimationOutput::AnimationOutput()
+    : m_mode("full"),
+      m_pollInterval(0.25),
+      m_chunkPackets(100000),
+      m_windowStart(2.0),
+      m_windowStop(12.0),
+      m_packetMetadata(false)
+{
+}
+
+AnimationOutput::~AnimationOutput() = default;
+
+void
+AnimationOutput::AddCommandLineValues(CommandLine& cmd)
+{
+    cmd.AddValue("animation", "NetAnim output: off, mobility, sampled or full", m_mode);
+    cmd.AddValue("animPollInterval",
+                 "Time between two NetAnim position updates [s]",
+                 m_pollInterval);
+    cmd.AddValue("animChunkPackets",
+                 "Packets per NetAnim file, further packets go to numbered files",
+                 m_chunkPackets);
+    cmd.AddValue("animStart", "Start of the sampled NetAnim window [s]", m_windowStart);
+    cmd.AddValue("animStop", "End of the sampled NetAnim window [s]", m_windowStop);
+}
+
+void
+AnimationOutput::SetMode(Mode mode)
+{
+    const char* names[] = {"off", "mobility", "sampled", "full"};
+    m_mode = names[mode];
+}
+
+void
+AnimationOutput::SetPollInterval(Time interval)
+{
+    m_pollInterval = interval.GetSeconds();
+}
+
+void
+AnimationOutput::SetChunkPackets(uint64_t packets)
+{
+    m_chunkPackets = packets;
+}
+
+void
+AnimationOutput::SetWindow(Time start, Time stop)
+{
+    m_windowStart = start.GetSeconds();
+    m_windowStop = stop.GetSeconds();
+}
+
+void
+AnimationOutput::EnablePacketMetadata(bool enable)
+{
+    m_packetMetadata = enable;
+}
+
+AnimationOutput::Mode
+AnimationOutput::GetMode() const
+{
+    return ParseMode(m_mode);
+}
+
+AnimationInterface*
+AnimationOutput::Start(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename << m_mode);
+    NS_ABORT_MSG_IF(m_anim, "Animation already started");
+    NS_ABORT_MSG_IF(m_chunkPackets == 0, "A NetAnim file needs at least one packet");
+
+    Mode mode = GetMode();
+    if (mode == OFF)
+    {
+        return nullptr;
+    }
+
+    m_anim = std::make_unique<AnimationInterface>(filename);
+    m_anim->SetMobilityPollInterval(Seconds(m_pollInterval));
+    m_anim->SetMaxPktsPerTraceFile(m_chunkPackets);
+    if (mode == MOBILITY)
+    {
+        m_anim->SkipPacketTracing();
+    }
+    else
+    {
+        m_anim->EnablePacketMetadata(m_packetMetadata);
+    }
+    if (mode == SAMPLED)
+    {
+        NS_ABORT_MSG_IF(m_windowStop <= m_windowStart, "Empty NetAnim window");
+        m_anim->SetStartTime(Seconds(m_windowStart));
+        m_anim->SetStopTime(Seconds(m_windowStop));
+    }
+    return m_anim.get();
+}
+
+AnimationInterface*
+AnimationOutput::Get() const
+{
+    return m_anim.get();
+}
+
+} // namespace ns3
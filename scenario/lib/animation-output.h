@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ANIMATION_OUTPUT_H
+#define ANIMATION_OUTPUT_H
+
+#include "ns3/command-line.h"
+#include "ns3/netanim-module.h"
+#include "ns3/nstime.h"
+
+#include <memory>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Optional NetAnim output of a scenario.
+ *
+ * Modes:
+ * - "off": no AnimationInterface at all, for batch runs
+ * - "mobility": node positions only, packets are not traced
+ * - "sampled": positions and packets only inside a time window (NetAnim's
+ *   start/stop time), e.g. a few seconds of a long run
+ * - "full": positions and packets of the whole run
+ *
+ * Packet traces are rotated into numbered files of at most a given number of
+ * packets each, so no single XML file grows without bound.
+ *
+ * \code
+ *   AnimationOutput animation;
+ *   animation.AddCommandLineValues(cmd);
+ *   ...
+ *   if (AnimationInterface* anim = animation.Start("project.xml"))
+ *   {
+ *       anim->UpdateNodeDescription(pgw, "PGW");
+ *   }
+ * \endcode
+ */
+class AnimationOutput
+{
+  public:
+    /// Animation modes
+    enum Mode
+    {
+        OFF,
+        MOBILITY,
+        SAMPLED,
+        FULL
+    };
+
+    /**
+     * \param name "off", "mobility", "sampled" or "full"
+     * \return the mode
+     */
+    static Mode ParseMode(const std::string& name);
+
+    AnimationOutput();
+    ~AnimationOutput();
+
+    /**
+     * Register --animation, --animPollInterval, --animChunkPackets, --animStart
+     * and --animStop with the command line.
+     *
+     * \param cmd the command line
+     */
+    void AddCommandLineValues(CommandLine& cmd);
+
+    /**
+     * \param mode the animation mode
+     */
+    void SetMode(Mode mode);
+
+    /**
+     * \param interval time between two position updates
+     */
+    void SetPollInterval(Time interval);
+
+    /**
+     * \param packets packets per trace file before a new file is started
+     */
+    void SetChunkPackets(uint64_t packets);
+
+    /**
+     * Set the time window of the "sampled" mode.
+     *
+     * \param start start of the window
+     * \param stop end of the window
+     */
+    void SetWindow(Time start, Time stop);
+
+    /**
+     * \param enable whether to record packet metadata in the trace
+     */
+    void EnablePacketMetadata(bool enable);
+
+    /// \return the animation mode
+    Mode GetMode() const;
+
+    /**
+     * Create the AnimationInterface for the configured mode. Nodes must exist.
+     *
+     * \param filename the (first) trace file
+     * \return the animation interface, or nullptr if the mode is "off"
+     */
+    AnimationInterface* Start(const std::string& filename);
+
+    /// \return the animation interface, or nullptr before Start() or if off
+    AnimationInterface* Get() const;
+
+  private:
+    std::string m_mode;                         //!< animation mode name
+    double m_pollInterval;                      //!< position update interval [s]
+    uint64_t m_chunkPackets;                    //!< packets per trace file
+    double m_windowStart;                       //!< sampled window start [s]
+    double m_windowStop;                        //!< sampled window end [s]
+    bool m_packetMetadata;                      //!< record packet metadata
+    std::unique_ptr<AnimationInterface> m_anim; //!< the animation
+};
+
+} // namespace ns3
+
+#endif /* ANIMATION_OUTPUT_H */
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-trace-writer.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncTraceWriter");
+
+AsyncTraceWriter::AsyncTraceWriter()
+    : m_bufferSize(1 << 20),
+      m_queueLimit(64 << 20),
+      m_records(0),
+      m_stalls(0),
+      m_queued(0),
+      m_stop(false)
+{
+}
+
+AsyncTraceWriter::~AsyncTraceWriter()
+{
+    Close();
+}
+
+void
+AsyncTraceWriter::SetBufferSize(std::size_t bytes)
+{
+    NS_ABORT_MSG_IF(bytes == 0, "The buffer size must be positive");
+    m_bufferSize = bytes;
+}
+
+void
+AsyncTraceWriter::SetQueueLimit(std::size_t bytes)
+{
+    m_queueLimit = bytes;
+}
+
+uint32_t
+AsyncTraceWriter::Open(const std::string& filename,
+                       std::size_t recordSize,
+                       const std::string& header,
+                       Formatter formatter)
+{
+    NS_LOG_FUNCTION(this << filename << recordSize);
+    auto stream = std::make_unique<Stream>();
+    stream->file.open(filename, formatter ? std::ios::out : std::ios::out | std::ios::binary);
+    NS_ABORT_MSG_IF(!stream->file.is_open(), "Cannot open " << filename);
+    stream->file << header;
+    stream->recordSize = recordSize;
+    stream->formatter = formatter;
+    stream->data.reserve(m_bufferSize + recordSize);
+
+    // The writer only touches the files of queued chunks, so opening more
+    // streams while it runs is safe as long as m_streams does not move
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.push_back(std::move(stream));
+    if (!m_thread.joinable())
+    {
+        m_stop = false;
+        m_thread = std::thread(&AsyncTraceWriter::Run, this);
+    }
+    return m_streams.size() - 1;
+}
+
+void
+AsyncTraceWriter::Flush(uint32_t stream)
+{
+    Stream& s = *m_streams[stream];
+    if (s.data.empty())
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_queued >= m_queueLimit)
+    {
+        m_stalls++;
+        m_done.wait(lock, [this] { return m_queued < m_queueLimit; });
+    }
+    m_queued += s.data.size();
+    m_queue.push_back({stream, std::move(s.data)});
+    lock.unlock();
+    m_ready.notify_one();
+
+    s.data = std::vector<uint8_t>();
+    s.data.reserve(m_bufferSize + s.recordSize);
+}
+
+void
+AsyncTraceWriter::Run()
+{
+    std::string text;
+    while (true)
+    {
+        Chunk chunk;
+        Stream* stream;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+            chunk = std::move(m_queue.front());
+            m_queue.pop_front();
+            stream = m_streams[chunk.stream].get();
+        }
+
+        if (stream->formatter == nullptr)
+        {
+            stream->file.write(reinterpret_cast<const char*>(chunk.data.data()),
+                               chunk.data.size());
+        }
+        else
+        {
+            text.clear();
+            for (std::size_t offset = 0; offset < chunk.data.size(); offset += stream->recordSize)
+            {
+                stream->formatter(chunk.data.data() + offset, text);
+            }
+            stream->file.write(text.data(), text.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queued -= chunk.data.size();
+        }
+        m_done.notify_one();
+    }
+}
+
+void
+AsyncTraceWriter::Close()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+    for (uint32_t stream = 0; stream < m_streams.size(); stream++)
+    {
+        Flush(stream);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_ready.notify_one();
+    m_thread.join();
+    for (auto& stream : m_streams)
+    {
+        stream->file.close();
+    }
+    m_streams.clear();
+}
+
+uint64_t
+AsyncTraceWriter::GetRecords() const
+{
+    return m_records;
+}
+
+uint64_t
+AsyncTraceWriter::GetStalls() const
+{
+    return m_stalls;
+}
+
+} // namespace ns3
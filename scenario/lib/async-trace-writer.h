@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_TRACE_WRITER_H
+#define ASYNC_TRACE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Trace files written by a background thread.
+ *
+ * Each stream holds fixed-size binary records. Write() only copies a record
+ * into the stream's buffer; full buffers are queued for the writer thread,
+ * which either writes them as they are (binary streams) or formats every
+ * record as a text line first. The event loop thus never formats text nor
+ * waits for the disk, unless more than the queue limit is pending, in which
+ * case Write() blocks until the writer has caught up (counted as a stall).
+ *
+ * \code
+ *   AsyncTraceWriter writer;
+ *   uint32_t stream = writer.Open("DlMacStats.txt", sizeof(MacRecord), header, &FormatMac);
+ *   writer.Write(stream, record); // in a trace sink
+ *   writer.Close();
+ * \endcode
+ */
+class AsyncTraceWriter
+{
+  public:
+    /**
+     * Append the text line of one record.
+     *
+     * \param record the record
+     * \param line the output
+     */
+    typedef void (*Formatter)(const uint8_t* record, std::string& line);
+
+    AsyncTraceWriter();
+    ~AsyncTraceWriter();
+
+    AsyncTraceWriter(const AsyncTraceWriter&) = delete;
+    AsyncTraceWriter& operator=(const AsyncTraceWriter&) = delete;
+
+    /**
+     * \param bytes buffer size per stream before it is handed to the writer
+     */
+    void SetBufferSize(std::size_t bytes);
+
+    /**
+     * \param bytes bytes queued for the writer before Write() blocks
+     */
+    void SetQueueLimit(std::size_t bytes);
+
+    /**
+     * Open a stream; the writer thread starts with the first one.
+     *
+     * \param filename the file
+     * \param recordSize size of every record [B]
+     * \param header written at the start of the file
+     * \param formatter text formatter, nullptr to write the records as they are
+     * \return the stream id
+     */
+    uint32_t Open(const std::string& filename,
+                  std::size_t recordSize,
+                  const std::string& header,
+                  Formatter formatter);
+
+    /**
+     * Append a record to a stream.
+     *
+     * \param stream the stream id
+     * \param record the record, of the stream's record size
+     */
+    template <typename T>
+    void Write(uint32_t stream, const T& record);
+
+    /// Write everything pending, stop the writer thread and close the files
+    void Close();
+
+    /// \return the number of records written
+    uint64_t GetRecords() const;
+
+    /// \return how often Write() had to wait for the writer thread
+    uint64_t GetStalls() const;
+
+  private:
+    /// An open trace file
+    struct Stream
+    {
+        std::ofstream file;        //!< the file
+        std::size_t recordSize;    //!< record size [B]
+        Formatter formatter;       //!< text formatter, nullptr for binary
+        std::vector<uint8_t> data; //!< records not yet queued
+    };
+
+    /// A buffer queued for the writer thread
+    struct Chunk
+    {
+        uint32_t stream;           //!< stream id
+        std::vector<uint8_t> data; //!< records
+    };
+
+    /**
+     * Queue a stream's buffer for the writer thread.
+     *
+     * \param stream the stream id
+     */
+    void Flush(uint32_t stream);
+
+    /// Writer thread main loop
+    void Run();
+
+    std::size_t m_bufferSize;                       //!< buffer size per stream [B]
+    std::size_t m_queueLimit;                       //!< pending bytes before blocking
+    std::vector<std::unique_ptr<Stream>> m_streams; //!< streams
+    uint64_t m_records;                             //!< records written
+    uint64_t m_stalls;                              //!< blocked Write() calls
+
+    std::thread m_thread;            //!< writer thread
+    std::mutex m_mutex;              //!< protects the queue and m_stop
+    std::condition_variable m_ready; //!< signals queued chunks or stop
+    std::condition_variable m_done;  //!< signals written chunks
+    std::deque<Chunk> m_queue;       //!< chunks for the writer
+    std::size_t m_queued;            //!< bytes in the queue
+    bool m_stop;                     //!< the writer thread shall exit
+};
+
+template <typename T>
+void
+AsyncTraceWriter::Write(uint32_t stream, const T& record)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Records are copied as bytes");
+    Stream& s = *m_streams[stream];
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+    s.data.insert(s.data.end(), bytes, bytes + sizeof(T));
+    m_records++;
+    if (s.data.size() >= m_bufferSize)
+    {
+        Flush(stream);
+    }
+}
+
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_WRITER_H */
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "cached-propagation-loss-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+namespace
+{
+
+/**
+ * Forward the frequency to a wrapped model. The LteHelper sets it on every
+ * path loss model, also those without a Frequency attribute, and only warns
+ * for those when unwrapped; so do we.
+ *
+ * \param model the wrapped model
+ * \param frequency the frequency [Hz], 0 for none
+ * \return whether the model took it
+ */
+bool
+ApplyFrequency(Ptr<PropagationLossModel> model, double frequency)
+{
+    if (frequency <= 0)
+    {
+        return false;
+    }
+    if (!model->SetAttributeFailSafe("Frequency", DoubleValue(frequency)))
+    {
+        NS_LOG_WARN(model->GetInstanceTypeId().GetName() << " has no Frequency attribute");
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TypeId
+CachedPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CachedPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<CachedPropagationLossModel>()
+            .AddAttribute("Model",
+                          "TypeId name of the propagation loss model whose loss is cached",
+                          StringValue("ns3::FriisPropagationLossModel"),
+                          MakeStringAccessor(&CachedPropagationLossModel::SetModelType,
+                                             &CachedPropagationLossModel::GetModelType),
+                          MakeStringChecker())
+            .AddAttribute("Resolution",
+                          "Size of the grid cells within which the loss is reused [m]",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&CachedPropagationLossModel::m_resolution),
+                          MakeDoubleChecker<double>(1e-3))
+            .AddAttribute("Frequency",
+                          "Carrier frequency forwarded to the wrapped model, 0 for none [Hz]",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&CachedPropagationLossModel::SetFrequency,
+                                             &CachedPropagationLossModel::GetFrequency),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel()
+    : m_resolution(1.0),
+      m_frequency(0),
+      m_hits(0),
+      m_misses(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+CachedPropagationLossModel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO(m_hits << " cached and " << m_misses << " computed losses");
+    m_cache.clear();
+    m_model = nullptr;
+    PropagationLossModel::DoDispose();
+}
+
+void
+CachedPropagationLossModel::SetModel(Ptr<PropagationLossModel> model)
+{
+    m_model = model;
+    m_cache.clear();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel() const
+{
+    if (!m_model)
+    {
+        ObjectFactory factory(m_modelType);
+        m_model = factory.Create<PropagationLossModel>();
+        ApplyFrequency(m_model, m_frequency);
+    }
+    return m_model;
+}
+
+void
+CachedPropagationLossModel::SetModelType(std::string type)
+{
+    NS_ABORT_MSG_IF(type == GetTypeId().GetName(), "A cached model cannot wrap itself");
+    m_modelType = type;
+    m_model = nullptr;
+    m_cache.clear();
+}
+
+std::string
+CachedPropagationLossModel::GetModelType() const
+{
+    return m_modelType;
+}
+
+void
+CachedPropagationLossModel::SetFrequency(double frequency)
+{
+    m_frequency = frequency;
+    if (m_model && ApplyFrequency(m_model, frequency))
+    {
+        m_cache.clear();
+    }
+}
+
+double
+CachedPropagationLossModel::GetFrequency() const
+{
+    return m_frequency;
+}
+
+uint64_t
+CachedPropagationLossModel::GetHits() const
+{
+    return m_hits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetMisses() const
+{
+    return m_misses;
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                          Ptr<MobilityModel> a,
+                                          Ptr<MobilityModel> b) const
+{
+    Vector pa = a->GetPosition();
+    Vector pb = b->GetPosition();
+    Cells cells = {static_cast<int32_t>(std::floor(pa.x / m_resolution)),
+                   static_cast<int32_t>(std::floor(pa.y / m_resolution)),
+                   static_cast<int32_t>(std::floor(pa.z / m_resolution)),
+                   static_cast<int32_t>(std::floor(pb.x / m_resolution)),
+                   static_cast<int32_t>(std::floor(pb.y / m_resolution)),
+                   static_cast<int32_t>(std::floor(pb.z / m_resolution))};
+
+    auto [it, inserted] = m_cache.try_emplace(Pair(PeekPointer(a), PeekPointer(b)));
+    if (!inserted && it->second.cells == cells)
+    {
+        m_hits++;
+        return txPowerDbm - it->second.loss;
+    }
+
+    // The loss of the wrapped model and its chain does not depend on the power
+    m_misses++;
+    it->second.cells = cells;
+    it->second.loss = -GetModel()->CalcRxPower(0, a, b);
+    return txPowerDbm - it->second.loss;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return GetModel()->AssignStreams(stream);
+}
+
+} // namespace ns3
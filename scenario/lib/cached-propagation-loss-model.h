@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * Propagation loss model caching the loss of another model per transmitter
+ * and receiver pair while both stay in the same cell of a position grid.
+ *
+ * The spectrum channels of the LteHelper ask for the loss of every
+ * transmitter/receiver pair on every transmission, i.e. every TTI, although
+ * walking UEs move millimetres between two TTIs. The loss is computed at the
+ * actual positions when a pair is first seen or one of its ends moved into
+ * another grid cell, and reused until then, so the error is bounded by the
+ * change of the loss over one grid cell (Resolution). Static pairs are
+ * computed once.
+ *
+ * The wrapped model is created from the Model attribute. Its Frequency is
+ * forwarded, as the LteHelper sets it per carrier; models without one (e.g.
+ * LogDistance) only get a warning logged. Other attributes of it are
+ * set with Config::SetDefault(). Models drawing random numbers per call
+ * (e.g. fading) draw them once per cell instead.
+ *
+ * \code
+ *   lteHelper->SetPathlossModelType(CachedPropagationLossModel::GetTypeId());
+ *   lteHelper->SetPathlossModelAttribute("Model",
+ *                                        StringValue("ns3::Cost231PropagationLossModel"));
+ *   lteHelper->SetPathlossModelAttribute("Resolution", DoubleValue(1));
+ * \endcode
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    CachedPropagationLossModel();
+    ~CachedPropagationLossModel() override;
+
+    /**
+     * \param model the propagation loss model whose loss is cached
+     */
+    void SetModel(Ptr<PropagationLossModel> model);
+
+    /// \return the propagation loss model whose loss is cached
+    Ptr<PropagationLossModel> GetModel() const;
+
+    /// \return losses served from the cache
+    uint64_t GetHits() const;
+
+    /// \return losses computed by the wrapped model
+    uint64_t GetMisses() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /**
+     * \param type TypeId name of the wrapped model
+     */
+    void SetModelType(std::string type);
+
+    /// \return TypeId name of the wrapped model
+    std::string GetModelType() const;
+
+    /**
+     * \param frequency carrier frequency forwarded to the wrapped model [Hz]
+     */
+    void SetFrequency(double frequency);
+
+    /// \return carrier frequency forwarded to the wrapped model [Hz]
+    double GetFrequency() const;
+
+    /// Grid cells of both ends of a pair
+    typedef std::array<int32_t, 6> Cells;
+
+    /// Cached loss of a pair
+    struct Entry
+    {
+        Cells cells; //!< grid cells the loss was computed in
+        double loss; //!< loss [dB]
+    };
+
+    /// Transmitter and receiver mobility
+    typedef std::pair<const MobilityModel*, const MobilityModel*> Pair;
+
+    /// Hash of a pair
+    struct PairHash
+    {
+        /**
+         * \param p a pair
+         * \return its hash
+         */
+        std::size_t operator()(const Pair& p) const
+        {
+            return std::hash<const void*>()(p.first) * 31 + std::hash<const void*>()(p.second);
+        }
+    };
+
+    std::string m_modelType;                                   //!< wrapped model type
+    double m_resolution;                                       //!< grid cell size [m]
+    double m_frequency;                                        //!< forwarded frequency, 0 for none
+    mutable Ptr<PropagationLossModel> m_model;                 //!< wrapped model
+    mutable std::unordered_map<Pair, Entry, PairHash> m_cache; //!< loss per pair
+    mutable uint64_t m_hits;                                   //!< losses from the cache
+    mutable uint64_t m_misses;                                 //!< losses computed
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
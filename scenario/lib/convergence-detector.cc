@@ -0,0 +1,162 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "convergence-detector.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ConvergenceDetector");
+
+ConvergenceDetector::ConvergenceDetector()
+    : m_warmUp(Seconds(5)),
+      m_precision(0.05),
+      m_minBatches(10),
+      m_batches(0),
+      m_collecting(false),
+      m_converged(false)
+{
+    m_sampler.SetSampleCallback(MakeCallback(&ConvergenceDetector::AddBatch, this));
+}
+
+void
+ConvergenceDetector::SetWarmUp(Time warmUp)
+{
+    m_warmUp = warmUp;
+}
+
+void
+ConvergenceDetector::SetBatch(Time batch)
+{
+    m_sampler.SetInterval(batch);
+}
+
+void
+ConvergenceDetector::SetPrecision(double precision)
+{
+    NS_ABORT_MSG_IF(precision <= 0, "The relative precision must be positive");
+    m_precision = precision;
+}
+
+void
+ConvergenceDetector::SetMinBatches(uint32_t batches)
+{
+    NS_ABORT_MSG_IF(batches < 2, "A confidence interval needs at least 2 batches");
+    m_minBatches = batches;
+}
+
+void
+ConvergenceDetector::Start(Ptr<FlowMonitor> monitor)
+{
+    NS_LOG_FUNCTION(this);
+    m_monitor = monitor;
+    m_batches = 0;
+    m_collecting = false;
+    m_converged = false;
+    m_flows.clear();
+    m_startEvent = Simulator::Schedule(m_warmUp, &ConvergenceDetector::StartBatches, this);
+}
+
+void
+ConvergenceDetector::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_startEvent.Cancel();
+    // The final partial batch is not counted
+    m_collecting = false;
+    m_sampler.Stop();
+    m_monitor = nullptr;
+}
+
+bool
+ConvergenceDetector::HasConverged() const
+{
+    return m_converged;
+}
+
+Time
+ConvergenceDetector::GetConvergenceTime() const
+{
+    return m_convergenceTime;
+}
+
+uint32_t
+ConvergenceDetector::GetBatches() const
+{
+    return m_batches;
+}
+
+void
+ConvergenceDetector::StartBatches()
+{
+    NS_LOG_FUNCTION(this);
+    m_collecting = true;
+    m_sampler.Start(m_monitor, nullptr);
+}
+
+void
+ConvergenceDetector::AddBatch(const std::vector<FlowIntervalRecord>& records)
+{
+    if (!m_collecting || m_converged)
+    {
+        return;
+    }
+    m_batches++;
+
+    uint32_t checked = 0;
+    bool converged = true;
+    double worst = 0;
+    for (const auto& r : records)
+    {
+        FlowState& flow = m_flows[r.flowId];
+        flow.throughput.Add(r.throughputKbps);
+        if (r.rxPackets > 0)
+        {
+            flow.delay.Add(r.meanDelayMs);
+        }
+
+        // Flows without received packets in this batch are not checked
+        if (r.rxPackets == 0)
+        {
+            continue;
+        }
+        checked++;
+        double precision = std::max(flow.throughput.GetRelativePrecision(),
+                                    flow.delay.GetRelativePrecision());
+        worst = std::max(worst, precision);
+        if (flow.throughput.GetCount() < m_minBatches || flow.delay.GetCount() < m_minBatches ||
+            precision > m_precision)
+        {
+            converged = false;
+        }
+    }
+    NS_LOG_INFO("Batch " << m_batches << " at " << Simulator::Now().As(Time::S)
+                         << ", worst relative precision " << worst);
+
+    if (checked > 0 && converged)
+    {
+        m_converged = true;
+        m_convergenceTime = Simulator::Now();
+        Simulator::Stop();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CONVERGENCE_DETECTOR_H
+#define CONVERGENCE_DETECTOR_H
+
+#include "flow-stats-sampler.h"
+#include "running-stats.h"
+
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Stops the simulation once the per-flow throughput and delay have converged.
+ *
+ * After a warm-up period the flow monitor is sampled every batch interval;
+ * each interval gives one batch mean of the throughput and of the delay of
+ * every flow. The simulation is stopped as soon as, for every flow with
+ * traffic in the last batch, at least the minimum number of batches has been
+ * collected and the 95% confidence interval of both means is within the
+ * relative precision (half-width over mean). Flows without traffic in the
+ * last batch are considered finished and ignored.
+ *
+ * \code
+ *   ConvergenceDetector convergence;
+ *   convergence.SetPrecision(0.05);
+ *   convergence.Start(monitor);
+ *   Simulator::Stop(Seconds(simTime)); // upper bound
+ *   Simulator::Run();
+ *   convergence.Stop();
+ * \endcode
+ */
+class ConvergenceDetector
+{
+  public:
+    ConvergenceDetector();
+
+    /**
+     * \param warmUp time after Start() before batches are collected
+     */
+    void SetWarmUp(Time warmUp);
+
+    /**
+     * \param batch length of a batch
+     */
+    void SetBatch(Time batch);
+
+    /**
+     * \param precision target CI half-width relative to the mean, e.g. 0.05
+     */
+    void SetPrecision(double precision);
+
+    /**
+     * \param batches minimum number of batches per flow
+     */
+    void SetMinBatches(uint32_t batches);
+
+    /**
+     * Schedule the end of the warm-up; call before Simulator::Run().
+     *
+     * \param monitor the flow monitor of the scenario
+     */
+    void Start(Ptr<FlowMonitor> monitor);
+
+    /// Stop sampling; call after Simulator::Run()
+    void Stop();
+
+    /// \return true if the simulation was stopped on convergence
+    bool HasConverged() const;
+    /// \return the time the metrics converged
+    Time GetConvergenceTime() const;
+    /// \return the number of batches collected
+    uint32_t GetBatches() const;
+
+  private:
+    /// Batch means of a flow
+    struct FlowState
+    {
+        RunningStats throughput; //!< throughput batch means [kb/s]
+        RunningStats delay;      //!< delay batch means [ms]
+    };
+
+    /// End of the warm-up, start sampling
+    void StartBatches();
+
+    /**
+     * Add a batch and stop the simulation if every active flow converged.
+     *
+     * \param records the flows with traffic in the batch
+     */
+    void AddBatch(const std::vector<FlowIntervalRecord>& records);
+
+    Time m_warmUp;                       //!< warm-up period
+    double m_precision;                  //!< target relative precision
+    uint32_t m_minBatches;               //!< minimum batches per flow
+    Ptr<FlowMonitor> m_monitor;          //!< sampled monitor
+    FlowStatsSampler m_sampler;          //!< batch source
+    EventId m_startEvent;                //!< end of the warm-up
+    uint32_t m_batches;                  //!< batches so far
+    bool m_collecting;                   //!< between warm-up and Stop()
+    bool m_converged;                    //!< stopped on convergence
+    Time m_convergenceTime;              //!< time of convergence
+    std::map<FlowId, FlowState> m_flows; //!< batch means per flow
+};
+
+} // namespace ns3
+
+#endif /* CONVERGENCE_DETECTOR_H */
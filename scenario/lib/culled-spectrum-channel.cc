@@ -0,0 +1,453 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "culled-spectrum-channel.h"
+
+#include "ns3/angles.h"
+#include "ns3/antenna-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-propagation-loss-model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CulledSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(CulledSpectrumChannel);
+
+namespace
+{
+
+/// Thermal noise density kT at 290 K [W/Hz]
+constexpr double THERMAL_NOISE_DENSITY = 1.380649e-23 * 290;
+
+} // namespace
+
+TypeId
+CulledSpectrumChannel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CulledSpectrumChannel")
+            .SetParent<SpectrumChannel>()
+            .SetGroupName("Spectrum")
+            .AddConstructor<CulledSpectrumChannel>()
+            .AddAttribute("CullThreshold",
+                          "Receivers whose strongest RB would arrive more than this below the "
+                          "thermal noise are skipped [dB]",
+                          DoubleValue(10),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_cullThreshold),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("NoiseFigure",
+                          "Noise figure of the receivers the threshold refers to [dB]",
+                          DoubleValue(5),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_noiseFigure),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("CullDistance",
+                          "Fixed distance beyond which receivers are skipped, 0 to derive it "
+                          "from the threshold and the propagation loss model [m]",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_cullDistance),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("MaxCullDistance",
+                          "Largest derived cull distance; beyond it no receiver is skipped "
+                          "by distance [m]",
+                          DoubleValue(100e3),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_maxCullDistance),
+                          MakeDoubleChecker<double>(1))
+            .AddAttribute("IndexCellSize",
+                          "Size of the grid cells of the receiver index [m]",
+                          DoubleValue(250),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_cellSize),
+                          MakeDoubleChecker<double>(1))
+            .AddAttribute("IndexRefresh",
+                          "Interval at which the receiver index is rebuilt",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&CulledSpectrumChannel::m_refresh),
+                          MakeTimeChecker())
+            .AddAttribute("IndexMargin",
+                          "Distance added to the cull distance for receivers that moved "
+                          "since the index was built [m]",
+                          DoubleValue(10),
+                          MakeDoubleAccessor(&CulledSpectrumChannel::m_margin),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+CulledSpectrumChannel::CulledSpectrumChannel()
+    : m_cullThreshold(10),
+      m_noiseFigure(5),
+      m_cullDistance(0),
+      m_maxCullDistance(100e3),
+      m_cellSize(250),
+      m_margin(10),
+      m_refresh(MilliSeconds(100)),
+      m_indexValid(false),
+      m_delivered(0),
+      m_culled(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+CulledSpectrumChannel::~CulledSpectrumChannel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+CulledSpectrumChannel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO(m_delivered << " receivers reached and " << m_culled << " culled");
+    m_phys.clear();
+    m_cells.clear();
+    m_unplaced.clear();
+    m_candidates.clear();
+    m_distances.clear();
+    m_conversions.clear();
+    m_probeTx = nullptr;
+    m_probeRx = nullptr;
+    SpectrumChannel::DoDispose();
+}
+
+void
+CulledSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy)
+{
+    NS_LOG_FUNCTION(this << phy);
+    if (std::find(m_phys.begin(), m_phys.end(), phy) == m_phys.end())
+    {
+        m_phys.push_back(phy);
+        m_indexValid = false;
+    }
+}
+
+void
+CulledSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
+{
+    NS_LOG_FUNCTION(this << phy);
+    auto it = std::find(m_phys.begin(), m_phys.end(), phy);
+    if (it != m_phys.end())
+    {
+        m_phys.erase(it);
+        m_indexValid = false;
+    }
+}
+
+std::size_t
+CulledSpectrumChannel::GetNDevices() const
+{
+    return m_phys.size();
+}
+
+Ptr<NetDevice>
+CulledSpectrumChannel::GetDevice(std::size_t i) const
+{
+    NS_ASSERT(i < m_phys.size());
+    return m_phys[i]->GetDevice();
+}
+
+uint64_t
+CulledSpectrumChannel::GetDelivered() const
+{
+    return m_delivered;
+}
+
+uint64_t
+CulledSpectrumChannel::GetCulled() const
+{
+    return m_culled;
+}
+
+uint64_t
+CulledSpectrumChannel::GetCellKey(int32_t x, int32_t y)
+{
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+}
+
+void
+CulledSpectrumChannel::BuildIndex()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& cell : m_cells)
+    {
+        cell.second.clear();
+    }
+    m_unplaced.clear();
+    for (uint32_t i = 0; i < m_phys.size(); i++)
+    {
+        Ptr<MobilityModel> mobility = m_phys[i]->GetMobility();
+        if (!mobility)
+        {
+            m_unplaced.push_back(i);
+            continue;
+        }
+        Vector position = mobility->GetPosition();
+        auto x = int32_t(std::floor(position.x / m_cellSize));
+        auto y = int32_t(std::floor(position.y / m_cellSize));
+        m_cells[GetCellKey(x, y)].push_back(i);
+    }
+    m_indexTime = Simulator::Now();
+    m_indexValid = true;
+}
+
+void
+CulledSpectrumChannel::FindCandidates(const Vector& position, double distance)
+{
+    auto x0 = int32_t(std::floor((position.x - distance) / m_cellSize));
+    auto x1 = int32_t(std::floor((position.x + distance) / m_cellSize));
+    auto y0 = int32_t(std::floor((position.y - distance) / m_cellSize));
+    auto y1 = int32_t(std::floor((position.y + distance) / m_cellSize));
+
+    // Walk the window, or the occupied cells if there are fewer of them
+    double window = (double(x1) - x0 + 1) * (double(y1) - y0 + 1);
+    if (window <= m_cells.size())
+    {
+        for (int32_t x = x0; x <= x1; x++)
+        {
+            for (int32_t y = y0; y <= y1; y++)
+            {
+                auto it = m_cells.find(GetCellKey(x, y));
+                if (it != m_cells.end())
+                {
+                    m_candidates.insert(m_candidates.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+    else
+    {
+        for (const auto& cell : m_cells)
+        {
+            auto x = int32_t(uint32_t(cell.first >> 32));
+            auto y = int32_t(uint32_t(cell.first));
+            if (x >= x0 && x <= x1 && y >= y0 && y <= y1)
+            {
+                m_candidates.insert(m_candidates.end(), cell.second.begin(), cell.second.end());
+            }
+        }
+    }
+}
+
+double
+CulledSpectrumChannel::GetCullDistance(double maxLossDb)
+{
+    auto key = int32_t(std::floor(maxLossDb * 2));
+    auto it = m_distances.find(key);
+    if (it != m_distances.end())
+    {
+        return it->second;
+    }
+
+    // Bisect along the x axis for the loss of the cached step, rounded up so
+    // that the distance is never too short
+    double lossDb = (key + 1) / 2.0;
+    if (!m_probeTx)
+    {
+        m_probeTx = CreateObject<ConstantPositionMobilityModel>();
+        m_probeRx = CreateObject<ConstantPositionMobilityModel>();
+    }
+    auto lossAt = [this](double d) {
+        m_probeRx->SetPosition(Vector(d, 0, 0));
+        return -m_propagationLoss->CalcRxPower(0, m_probeTx, m_probeRx);
+    };
+    double distance = std::numeric_limits<double>::infinity();
+    if (lossAt(m_maxCullDistance) >= lossDb)
+    {
+        double near = 0;
+        double far = m_maxCullDistance;
+        while (far - near > 1)
+        {
+            double middle = (near + far) / 2;
+            (lossAt(middle) >= lossDb ? far : near) = middle;
+        }
+        distance = far;
+    }
+    NS_LOG_INFO("Cull distance " << distance << " m for a loss of " << lossDb << " dB");
+    m_distances[key] = distance;
+    return distance;
+}
+
+void
+CulledSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
+{
+    NS_LOG_FUNCTION(this << txParams->psd << txParams->duration << txParams->txPhy);
+    NS_ASSERT_MSG(txParams->psd, "NULL txPsd");
+    NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+
+    if (!m_indexValid || Simulator::Now() - m_indexTime >= m_refresh)
+    {
+        BuildIndex();
+    }
+
+    // Largest loss a receiver may see, from the strongest RB and the noise
+    double maxPsd =
+        *std::max_element(txParams->psd->ConstValuesBegin(), txParams->psd->ConstValuesEnd());
+    if (maxPsd <= 0)
+    {
+        return;
+    }
+    double noisePsd = THERMAL_NOISE_DENSITY * std::pow(10.0, m_noiseFigure / 10);
+    double maxLossDb =
+        std::min(10 * std::log10(maxPsd / noisePsd) + m_cullThreshold, m_maxLossDb);
+
+    Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
+    double distance = std::numeric_limits<double>::infinity();
+    if (senderMobility && m_cullDistance > 0)
+    {
+        distance = m_cullDistance;
+    }
+    else if (senderMobility && m_propagationLoss)
+    {
+        distance = GetCullDistance(maxLossDb);
+    }
+    m_candidates.clear();
+    if (!std::isinf(distance))
+    {
+        FindCandidates(senderMobility->GetPosition(), distance + m_margin);
+        m_candidates.insert(m_candidates.end(), m_unplaced.begin(), m_unplaced.end());
+    }
+    else
+    {
+        m_candidates.resize(m_phys.size());
+        for (uint32_t i = 0; i < m_phys.size(); i++)
+        {
+            m_candidates[i] = i;
+        }
+    }
+    m_culled += m_phys.size() - m_candidates.size();
+
+    Ptr<const SpectrumModel> txModel = txParams->psd->GetSpectrumModel();
+    Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+    for (uint32_t i : m_candidates)
+    {
+        Ptr<SpectrumPhy> rxPhy = m_phys[i];
+        if (rxPhy == txParams->txPhy)
+        {
+            continue;
+        }
+        Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
+        if (rxNetDevice && txNetDevice &&
+            rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+        {
+            // No propagation loss model supports antennas of the same node
+            continue;
+        }
+
+        Ptr<const SpectrumModel> rxModel = rxPhy->GetRxSpectrumModel();
+        if (!rxModel)
+        {
+            continue;
+        }
+        Conversion* conversion = nullptr;
+        if (rxModel->GetUid() != txModel->GetUid())
+        {
+            auto key = std::make_pair(txModel->GetUid(), rxModel->GetUid());
+            auto it = m_conversions.find(key);
+            if (it == m_conversions.end())
+            {
+                Conversion created{txModel->IsOrthogonal(*rxModel), SpectrumConverter()};
+                if (!created.orthogonal)
+                {
+                    created.convert = SpectrumConverter(txModel, rxModel);
+                }
+                it = m_conversions.emplace(key, created).first;
+            }
+            if (it->second.orthogonal)
+            {
+                continue;
+            }
+            conversion = &it->second;
+        }
+
+        Time delay = MicroSeconds(0);
+        double pathLossDb = 0;
+        Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
+        if (senderMobility && receiverMobility)
+        {
+            if (txParams->txAntenna)
+            {
+                Angles txAngles(receiverMobility->GetPosition(), senderMobility->GetPosition());
+                pathLossDb -= txParams->txAntenna->GetGainDb(txAngles);
+            }
+            Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
+            if (rxAntenna)
+            {
+                Angles rxAngles(senderMobility->GetPosition(), receiverMobility->GetPosition());
+                pathLossDb -= rxAntenna->GetGainDb(rxAngles);
+            }
+            if (m_propagationLoss)
+            {
+                pathLossDb -= m_propagationLoss->CalcRxPower(0, senderMobility, receiverMobility);
+            }
+            if (pathLossDb > maxLossDb)
+            {
+                m_culled++;
+                continue;
+            }
+            if (m_propagationDelay)
+            {
+                delay = m_propagationDelay->GetDelay(senderMobility, receiverMobility);
+            }
+        }
+
+        Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+        if (conversion)
+        {
+            rxParams->psd = conversion->convert.Convert(txParams->psd);
+        }
+        *(rxParams->psd) *= std::pow(10.0, -pathLossDb / 10);
+        m_delivered++;
+        if (rxNetDevice)
+        {
+            Simulator::ScheduleWithContext(rxNetDevice->GetNode()->GetId(),
+                                           delay,
+                                           &CulledSpectrumChannel::StartRx,
+                                           this,
+                                           rxParams,
+                                           rxPhy);
+        }
+        else
+        {
+            Simulator::Schedule(delay, &CulledSpectrumChannel::StartRx, this, rxParams, rxPhy);
+        }
+    }
+}
+
+void
+CulledSpectrumChannel::StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+    NS_LOG_FUNCTION(this << params);
+    if (m_spectrumPropagationLoss)
+    {
+        params->psd =
+            m_spectrumPropagationLoss->CalcRxPowerSpectralDensity(params,
+                                                                  params->txPhy->GetMobility(),
+                                                                  receiver->GetMobility());
+    }
+    receiver->StartRx(params);
+}
+
+} // namespace ns3
@@ -0,0 +1,159 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CULLED_SPECTRUM_CHANNEL_H
+#define CULLED_SPECTRUM_CHANNEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/spectrum-converter.h"
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Spectrum channel delivering a transmission only to the receivers close
+ * enough for it to matter, found through a grid index of the receivers.
+ *
+ * A MultiModelSpectrumChannel hands every transmission to every receiver on
+ * the channel: a path loss computation, a PSD copy and a StartRx event per
+ * receiver, O(eNBs x UEs) per TTI. This channel keeps the receivers in a
+ * uniform grid (IndexCellSize), rebuilt when older than IndexRefresh, and for
+ * a transmission only looks at the grid cells within the cull distance of the
+ * transmitter, widened by IndexMargin for receivers that moved since the
+ * rebuild. Those get the usual path loss; a receiver is still skipped if its
+ * strongest RB would arrive more than CullThreshold dB below the thermal
+ * noise of a receiver with NoiseFigure.
+ *
+ * The cull distance is where the channel's propagation loss model reaches
+ * that loss for the transmission's strongest RB, found by bisection along a
+ * line and cached per 0.5 dB; this assumes a loss model growing with distance
+ * and no antenna gains beyond the threshold. CullDistance sets a fixed one
+ * instead.
+ *
+ * As in the MultiModelSpectrumChannel, a signal is converted to the
+ * receiver's spectrum model and not delivered if the two do not overlap, so
+ * the LTE carriers may share the channel. The traces and the phased array
+ * models of the base class are not supported.
+ *
+ * \code
+ *   lteHelper->SetSpectrumChannelType("ns3::CulledSpectrumChannel");
+ *   lteHelper->SetSpectrumChannelAttribute("CullThreshold", DoubleValue(10));
+ * \endcode
+ */
+class CulledSpectrumChannel : public SpectrumChannel
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    CulledSpectrumChannel();
+    ~CulledSpectrumChannel() override;
+
+    // Inherited
+    void AddRx(Ptr<SpectrumPhy> phy) override;
+    void RemoveRx(Ptr<SpectrumPhy> phy) override;
+    void StartTx(Ptr<SpectrumSignalParameters> params) override;
+    std::size_t GetNDevices() const override;
+    Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+    /// \return receivers handed a transmission so far
+    uint64_t GetDelivered() const;
+
+    /// \return receivers skipped so far, by the index or the threshold
+    uint64_t GetCulled() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Conversion between a transmitter's and a receiver's spectrum model
+    struct Conversion
+    {
+        bool orthogonal;           //!< the models do not overlap
+        SpectrumConverter convert; //!< the conversion if they do
+    };
+
+    /**
+     * \param x grid column
+     * \param y grid row
+     * \return the key of the cell
+     */
+    static uint64_t GetCellKey(int32_t x, int32_t y);
+
+    /// Rebuild the grid of the receivers
+    void BuildIndex();
+
+    /**
+     * Collect the receivers in the grid cells within a distance.
+     *
+     * \param position the centre
+     * \param distance the distance [m]
+     */
+    void FindCandidates(const Vector& position, double distance);
+
+    /**
+     * \param maxLossDb loss below which a receiver is kept [dB]
+     * \return distance at which the propagation loss reaches it [m]
+     */
+    double GetCullDistance(double maxLossDb);
+
+    /**
+     * \param params the signal, attenuated by the path loss
+     * \param receiver the receiver
+     */
+    void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+    /// Receivers per grid cell
+    using CellMap = std::unordered_map<uint64_t, std::vector<uint32_t>>;
+    /// Conversion per transmitter and receiver spectrum model UIDs
+    using ConversionMap = std::map<std::pair<uint32_t, uint32_t>, Conversion>;
+
+    double m_cullThreshold;   //!< dB below the noise that are culled
+    double m_noiseFigure;     //!< receiver noise figure [dB]
+    double m_cullDistance;    //!< fixed cull distance [m], 0 for derived
+    double m_maxCullDistance; //!< largest derived cull distance [m]
+    double m_cellSize;        //!< grid cell size [m]
+    double m_margin;          //!< movement allowance [m]
+    Time m_refresh;           //!< index rebuild interval
+
+    std::vector<Ptr<SpectrumPhy>> m_phys; //!< all receivers
+    CellMap m_cells;                      //!< receivers per grid cell
+    std::vector<uint32_t> m_unplaced;     //!< receivers without mobility
+    std::vector<uint32_t> m_candidates;   //!< receivers of the current transmission
+    Time m_indexTime;                     //!< time of the last rebuild
+    bool m_indexValid;                    //!< the grid holds every receiver
+
+    std::map<int32_t, double> m_distances; //!< cull distance per 0.5 dB of loss
+    ConversionMap m_conversions;           //!< conversions between spectrum models
+    Ptr<MobilityModel> m_probeTx;          //!< transmitter of the distance search
+    Ptr<MobilityModel> m_probeRx;          //!< receiver of the distance search
+    uint64_t m_delivered;                  //!< receivers reached
+    uint64_t m_culled;                     //!< receivers skipped
+};
+
+} // namespace ns3
+
+#endif /* CULLED_SPECTRUM_CHANNEL_H */
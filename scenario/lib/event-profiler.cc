@@ -0,0 +1,404 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "memory-accounting.h"
+
+#include "ns3/abort.h"
+#include "ns3/event-impl.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/type-id.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <iomanip>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingScheduler);
+
+namespace
+{
+
+/// Time and count of one event type
+struct ProfileEntry
+{
+    int64_t nanoseconds{0}; //!< summed wall time
+    uint64_t events{0};     //!< executed events
+};
+
+/// A line of the printed profile
+struct ProfileLine
+{
+    std::string object; //!< object type
+    std::string event;  //!< event type
+    ProfileEntry entry; //!< time and count
+};
+
+/// \return the profile, by dynamic type of the event implementation
+std::unordered_map<std::type_index, ProfileEntry>&
+GetProfile()
+{
+    static std::unordered_map<std::type_index, ProfileEntry> profile;
+    return profile;
+}
+
+/// Enable() was called
+bool g_enabled = false;
+
+/**
+ * Split the demangled type of an event implementation into object and event
+ * type. Events made by MakeEvent() are local classes of the MakeEvent template,
+ * whose first template argument is the called (member) function type.
+ *
+ * \param type the event implementation type
+ * \return object type and event type
+ */
+std::pair<std::string, std::string>
+Describe(const std::type_index& type)
+{
+    int status;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+
+    std::size_t start = name.find("MakeEvent<");
+    if (start == std::string::npos)
+    {
+        if (name.find("MakeEvent(std::function") != std::string::npos)
+        {
+            return {"std::function", "std::function<void ()>"};
+        }
+        return {"other", name};
+    }
+
+    // First template argument of MakeEvent
+    start += std::string("MakeEvent<").size();
+    std::size_t end = start;
+    int depth = 0;
+    for (; end < name.size(); end++)
+    {
+        char c = name[end];
+        if (c == '<' || c == '(')
+        {
+            depth++;
+        }
+        else if ((c == '>' || c == ')') && depth > 0)
+        {
+            depth--;
+        }
+        else if ((c == '>' || c == ',') && depth == 0)
+        {
+            break;
+        }
+    }
+    std::string event = name.substr(start, end - start);
+
+    // "void (ns3::Class::*)(args)" belongs to ns3::Class
+    std::size_t member = event.find("::*)");
+    if (member == std::string::npos)
+    {
+        return {"function", event};
+    }
+    std::size_t open = event.rfind('(', member);
+    return {event.substr(open + 1, member - open - 1), event};
+}
+
+/**
+ * \param type an event implementation type
+ * \return the memory accounting label of its object type
+ */
+uint32_t
+GetMemoryLabel(const std::type_info& type)
+{
+    static std::unordered_map<std::type_index, uint32_t> labels;
+    auto i = labels.find(type);
+    if (i != labels.end())
+    {
+        return i->second;
+    }
+    uint32_t label = MemoryAccounting::GetLabel(Describe(type).first);
+    labels.emplace(type, label);
+    return label;
+}
+
+/// \return the profile lines, most expensive first
+std::vector<ProfileLine>
+GetLines()
+{
+    std::vector<ProfileLine> lines;
+    for (const auto& [type, entry] : GetProfile())
+    {
+        auto [object, event] = Describe(type);
+        lines.push_back({object, event, entry});
+    }
+    std::sort(lines.begin(), lines.end(), [](const ProfileLine& a, const ProfileLine& b) {
+        return a.entry.nanoseconds > b.entry.nanoseconds;
+    });
+    return lines;
+}
+
+/**
+ * Print one row of a profile table.
+ *
+ * \param os the output stream
+ * \param entry time and count
+ * \param total total wall time [ns]
+ * \param label the row label
+ */
+void
+PrintRow(std::ostream& os, const ProfileEntry& entry, int64_t total, const std::string& label)
+{
+    os << std::setw(10) << entry.nanoseconds / 1e9 << std::setw(8)
+       << (total > 0 ? entry.nanoseconds * 100.0 / total : 0) << "%" << std::setw(12)
+       << entry.events << std::setw(11) << entry.nanoseconds / 1e3 / entry.events << "  "
+       << label << "\n";
+}
+
+} // namespace
+
+/**
+ * Event wrapping a scheduled event to time its execution. It takes over the
+ * scheduler's reference to the wrapped event.
+ */
+class ProfiledEvent : public EventImpl
+{
+  public:
+    /**
+     * \param event the wrapped event
+     */
+    explicit ProfiledEvent(EventImpl* event)
+        : m_event(event)
+    {
+    }
+
+    ~ProfiledEvent() override
+    {
+        if (m_event != nullptr)
+        {
+            m_event->Unref();
+        }
+    }
+
+    /**
+     * Give the reference to the wrapped event back, for Simulator::Remove().
+     *
+     * \return the wrapped event
+     */
+    EventImpl* Release()
+    {
+        EventImpl* event = m_event;
+        m_event = nullptr;
+        return event;
+    }
+
+  protected:
+    void Notify() override
+    {
+        // Simulator::Cancel() marks the wrapped event
+        if (m_event->IsCancelled())
+        {
+            return;
+        }
+        // Heap allocated by the event is charged to its object type
+        bool accounting = MemoryAccounting::IsEnabled();
+        uint32_t previous = 0;
+        if (accounting)
+        {
+            previous = MemoryAccounting::SetCurrentLabel(GetMemoryLabel(typeid(*m_event)));
+        }
+        auto start = std::chrono::steady_clock::now();
+        m_event->Invoke();
+        auto end = std::chrono::steady_clock::now();
+        if (accounting)
+        {
+            MemoryAccounting::SetCurrentLabel(previous);
+        }
+        EventProfiler::Record(typeid(*m_event),
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                                  .count());
+    }
+
+  private:
+    EventImpl* m_event; //!< wrapped event
+};
+
+void
+EventProfiler::Enable()
+{
+    if (g_enabled)
+    {
+        return;
+    }
+    g_enabled = true;
+    // The global value covers the simulators created after a
+    // Simulator::Destroy(), e.g. of later replications; SetScheduler() the
+    // current one
+    GlobalValue::Bind("SchedulerType", TypeIdValue(ProfilingScheduler::GetTypeId()));
+    ObjectFactory factory;
+    factory.SetTypeId(ProfilingScheduler::GetTypeId());
+    Simulator::SetScheduler(factory);
+}
+
+bool
+EventProfiler::IsEnabled()
+{
+    return g_enabled;
+}
+
+void
+EventProfiler::Record(const std::type_info& type, int64_t nanoseconds)
+{
+    ProfileEntry& entry = GetProfile()[std::type_index(type)];
+    entry.nanoseconds += nanoseconds;
+    entry.events++;
+}
+
+void
+EventProfiler::Reset()
+{
+    GetProfile().clear();
+}
+
+void
+EventProfiler::Print(std::ostream& os, uint32_t top)
+{
+    std::vector<ProfileLine> lines = GetLines();
+
+    ProfileEntry total;
+    std::map<std::string, ProfileEntry> objects;
+    for (const auto& line : lines)
+    {
+        total.nanoseconds += line.entry.nanoseconds;
+        total.events += line.entry.events;
+        objects[line.object].nanoseconds += line.entry.nanoseconds;
+        objects[line.object].events += line.entry.events;
+    }
+    std::vector<std::pair<std::string, ProfileEntry>> byObject(objects.begin(), objects.end());
+    std::sort(byObject.begin(), byObject.end(), [](const auto& a, const auto& b) {
+        return a.second.nanoseconds > b.second.nanoseconds;
+    });
+
+    os << "\n*** Event profile ***\n";
+    os << "Events: " << total.events << ", wall time in events: " << total.nanoseconds / 1e9
+       << " s\n";
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+
+    os << "\n  time [s]   share      events  mean [us]  object type\n";
+    for (const auto& [object, entry] : byObject)
+    {
+        PrintRow(os, entry, total.nanoseconds, object);
+    }
+
+    os << "\n  time [s]   share      events  mean [us]  event type\n";
+    for (std::size_t i = 0; i < lines.size() && i < top; i++)
+    {
+        PrintRow(os, lines[i].entry, total.nanoseconds, lines[i].event);
+    }
+    os.flags(flags);
+}
+
+void
+EventProfiler::WriteFolded(const std::string& filename)
+{
+    std::ofstream out(filename);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << filename);
+    for (const auto& line : GetLines())
+    {
+        // Frames are separated by ';', the sample value follows the last space
+        out << line.object << ";" << line.event << " " << line.entry.nanoseconds / 1000 << "\n";
+    }
+}
+
+TypeId
+ProfilingScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ProfilingScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<ProfilingScheduler>();
+    return tid;
+}
+
+ProfilingScheduler::ProfilingScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ProfilingScheduler::~ProfilingScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ProfilingScheduler::Insert(const Event& ev)
+{
+    bool inserted = m_list.emplace(ev.key, new ProfiledEvent(ev.impl)).second;
+    NS_ASSERT_MSG(inserted, "Duplicate event key");
+}
+
+bool
+ProfilingScheduler::IsEmpty() const
+{
+    return m_list.empty();
+}
+
+Scheduler::Event
+ProfilingScheduler::PeekNext() const
+{
+    NS_ASSERT(!m_list.empty());
+    auto i = m_list.begin();
+    return {i->second, i->first};
+}
+
+Scheduler::Event
+ProfilingScheduler::RemoveNext()
+{
+    NS_ASSERT(!m_list.empty());
+    auto i = m_list.begin();
+    Event ev{i->second, i->first};
+    m_list.erase(i);
+    return ev;
+}
+
+void
+ProfilingScheduler::Remove(const Event& ev)
+{
+    auto i = m_list.find(ev.key);
+    NS_ASSERT(i != m_list.end());
+    // The simulator releases its reference to the original event, hand it back
+    // and drop the wrapper
+    auto wrapper = static_cast<ProfiledEvent*>(i->second);
+    EventImpl* event = wrapper->Release();
+    NS_ASSERT(event == ev.impl);
+    wrapper->Unref();
+    m_list.erase(i);
+}
+
+} // namespace ns3
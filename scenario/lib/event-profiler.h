@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "ns3/scheduler.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+namespace ns3
+{
+
+/**
+ * Opt-in profile of the simulator run loop.
+ *
+ * Every executed event is timed with a steady clock; its wall time and count
+ * are attributed to the event type, i.e. the signature of the (member) function
+ * the event calls, and to the object type that member function belongs to,
+ * e.g. ns3::LteSpectrumPhy, ns3::RandomWalk2dMobilityModel, ns3::TcpSocketBase
+ * or ns3::AnimationInterface. Trace sinks (NetAnim, FlowMonitor, ...) run inside
+ * the event that fires the trace and are charged to it.
+ *
+ * Enable() swaps the simulator's scheduler for a ProfilingScheduler, which keeps
+ * the event order of the default map scheduler; the cost is two clock reads and
+ * a hash lookup per event.
+ *
+ * \code
+ *   EventProfiler::Enable();
+ *   // build the scenario
+ *   Simulator::Run();
+ *   EventProfiler::Print(std::cout);
+ *   EventProfiler::WriteFolded("profile.folded"); // flamegraph.pl profile.folded
+ * \endcode
+ */
+class EventProfiler
+{
+  public:
+    /**
+     * Install the ProfilingScheduler, in the current simulator and through the
+     * SchedulerType global value in every simulator created after a
+     * Simulator::Destroy(); events already scheduled are moved to it and
+     * profiled too.
+     */
+    static void Enable();
+
+    /// \return true once Enable() was called
+    static bool IsEnabled();
+
+    /**
+     * Print the profile ranked by wall time, per object type and per event type.
+     *
+     * \param os the output stream
+     * \param top number of event types listed
+     */
+    static void Print(std::ostream& os, uint32_t top = 20);
+
+    /**
+     * Write the profile in the folded stack format of flamegraph.pl and
+     * speedscope: one "object type;event type <microseconds>" line per event
+     * type.
+     *
+     * \param filename the output file
+     */
+    static void WriteFolded(const std::string& filename);
+
+    /// Drop the collected profile, e.g. between replications
+    static void Reset();
+
+    /**
+     * Account an executed event; called by the ProfilingScheduler.
+     *
+     * \param type dynamic type of the event implementation
+     * \param nanoseconds wall time of the event
+     */
+    static void Record(const std::type_info& type, int64_t nanoseconds);
+};
+
+/**
+ * Scheduler wrapping every inserted event so that the EventProfiler can time
+ * it; events are kept in a map ordered by key, like ns3::MapScheduler.
+ */
+class ProfilingScheduler : public Scheduler
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ProfilingScheduler();
+    ~ProfilingScheduler() override;
+
+    // Inherited
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+  private:
+    std::map<EventKey, EventImpl*> m_list; //!< wrapped events by key
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
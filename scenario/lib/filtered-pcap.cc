@@ -0,0 +1,257 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "filtered-pcap.h"
+
+#include "ns3/abort.h"
+#include "ns3/internet-module.h"
+#include "ns3/log.h"
+#include "ns3/ppp-header.h"
+#include "ns3/simulator.h"
+
+#include <limits>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FilteredPcap");
+
+namespace
+{
+
+/// PPP protocol number of IPv4
+const uint16_t PPP_IPV4 = 0x0021;
+
+/**
+ * \param text an address or "*"
+ * \return the address, Ipv4Address::GetAny() for "*"
+ */
+Ipv4Address
+ParseAddress(const std::string& text)
+{
+    return text == "*" ? Ipv4Address::GetAny() : Ipv4Address(text.c_str());
+}
+
+/**
+ * \param text a port or "*"
+ * \return the port, 0 for "*"
+ */
+uint16_t
+ParsePort(const std::string& text)
+{
+    return text == "*" ? 0 : std::stoul(text);
+}
+
+/**
+ * Split "address:port".
+ *
+ * \param text the endpoint
+ * \param address the address
+ * \param port the port
+ */
+void
+ParseEndpoint(const std::string& text, Ipv4Address& address, uint16_t& port)
+{
+    std::size_t colon = text.find(':');
+    NS_ABORT_MSG_IF(colon == std::string::npos, "Expected address:port, got " << text);
+    address = ParseAddress(text.substr(0, colon));
+    port = ParsePort(text.substr(colon + 1));
+}
+
+} // namespace
+
+FilteredPcap::FilteredPcap()
+    : m_headersOnly(false),
+      m_start(Seconds(0)),
+      m_stop(Time::Max()),
+      m_captured(0)
+{
+}
+
+void
+FilteredPcap::AddPort(uint16_t port)
+{
+    Filter f;
+    f.port = port;
+    m_filters.push_back(f);
+}
+
+void
+FilteredPcap::AddFlow(Ipv4Address src,
+                      uint16_t srcPort,
+                      Ipv4Address dst,
+                      uint16_t dstPort,
+                      uint8_t protocol)
+{
+    m_filters.push_back({src, srcPort, dst, dstPort, protocol, 0});
+}
+
+void
+FilteredPcap::AddFilters(const std::string& filters)
+{
+    std::stringstream ss(filters);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (token.empty())
+        {
+            continue;
+        }
+        std::size_t arrow = token.find('>');
+        if (arrow == std::string::npos)
+        {
+            AddPort(ParsePort(token));
+            continue;
+        }
+
+        // src:port>dst:port[/protocol]
+        Filter f;
+        std::size_t slash = token.find('/', arrow);
+        ParseEndpoint(token.substr(0, arrow), f.src, f.srcPort);
+        ParseEndpoint(token.substr(arrow + 1, slash - arrow - 1), f.dst, f.dstPort);
+        if (slash != std::string::npos)
+        {
+            std::string protocol = token.substr(slash + 1);
+            if (protocol == "tcp")
+            {
+                f.protocol = TcpL4Protocol::PROT_NUMBER;
+            }
+            else if (protocol == "udp")
+            {
+                f.protocol = UdpL4Protocol::PROT_NUMBER;
+            }
+            else if (protocol != "*")
+            {
+                f.protocol = std::stoul(protocol);
+            }
+        }
+        m_filters.push_back(f);
+    }
+}
+
+void
+FilteredPcap::SetHeadersOnly(bool headersOnly)
+{
+    m_headersOnly = headersOnly;
+}
+
+void
+FilteredPcap::SetWindow(Time start, Time stop)
+{
+    NS_ABORT_MSG_IF(stop <= start, "Empty capture window");
+    m_start = start;
+    m_stop = stop;
+}
+
+void
+FilteredPcap::Install(NetDeviceContainer devices, const std::string& prefix)
+{
+    PcapHelper pcapHelper;
+    uint32_t snapLength =
+        m_headersOnly ? HEADERS_SNAP_LENGTH : std::numeric_limits<uint32_t>::max();
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+    {
+        Ptr<NetDevice> device = devices.Get(i);
+        std::string filename = pcapHelper.GetFilenameFromDevice(prefix, device);
+        Ptr<PcapFileWrapper> file =
+            pcapHelper.CreateFile(filename, std::ios::out, PcapHelper::DLT_PPP, snapLength);
+        bool connected = device->TraceConnectWithoutContext(
+            "PromiscSniffer",
+            MakeBoundCallback(&FilteredPcap::Sniff, this, file));
+        NS_ABORT_MSG_IF(!connected, "No PromiscSniffer on " << filename << ", not a p2p device?");
+    }
+}
+
+uint64_t
+FilteredPcap::GetCapturedPackets() const
+{
+    return m_captured;
+}
+
+bool
+FilteredPcap::Matches(Ptr<const Packet> packet) const
+{
+    if (m_filters.empty())
+    {
+        return true;
+    }
+
+    Ptr<Packet> copy = packet->Copy();
+    PppHeader ppp;
+    copy->RemoveHeader(ppp);
+    if (ppp.GetProtocol() != PPP_IPV4)
+    {
+        return false;
+    }
+    Ipv4Header ip;
+    copy->RemoveHeader(ip);
+
+    // Later fragments carry no ports and only match address filters
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    if (ip.GetFragmentOffset() == 0)
+    {
+        if (ip.GetProtocol() == TcpL4Protocol::PROT_NUMBER)
+        {
+            TcpHeader tcp;
+            copy->PeekHeader(tcp);
+            srcPort = tcp.GetSourcePort();
+            dstPort = tcp.GetDestinationPort();
+        }
+        else if (ip.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
+        {
+            UdpHeader udp;
+            copy->PeekHeader(udp);
+            srcPort = udp.GetSourcePort();
+            dstPort = udp.GetDestinationPort();
+        }
+    }
+
+    Ipv4Address any = Ipv4Address::GetAny();
+    for (const auto& f : m_filters)
+    {
+        if (f.port != 0)
+        {
+            if (srcPort == f.port || dstPort == f.port)
+            {
+                return true;
+            }
+            continue;
+        }
+        if ((f.src == any || f.src == ip.GetSource()) &&
+            (f.dst == any || f.dst == ip.GetDestination()) &&
+            (f.srcPort == 0 || f.srcPort == srcPort) && (f.dstPort == 0 || f.dstPort == dstPort) &&
+            (f.protocol == 0 || f.protocol == ip.GetProtocol()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+FilteredPcap::Sniff(FilteredPcap* pcap, Ptr<PcapFileWrapper> file, Ptr<const Packet> packet)
+{
+    Time now = Simulator::Now();
+    if (now < pcap->m_start || now > pcap->m_stop || !pcap->Matches(packet))
+    {
+        return;
+    }
+    file->Write(now, packet);
+    pcap->m_captured++;
+}
+
+} // namespace ns3
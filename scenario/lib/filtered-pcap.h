@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FILTERED_PCAP_H
+#define FILTERED_PCAP_H
+
+#include "ns3/network-module.h"
+#include "ns3/nstime.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * PCAP capture of selected flows on point-to-point devices, as a replacement
+ * for PointToPointHelper::EnablePcapAll() on busy links.
+ *
+ * A packet is written if it matches any filter. A filter is either a port,
+ * matching either the source or the destination port ("100"), or a five-tuple
+ * "src:port>dst:port/protocol" where any field can be "*", e.g.
+ * "*:*>7.0.0.2:100/udp" or "7.0.0.6:*>*:21/tcp". Without filters every packet
+ * matches. Capture can be restricted to a time window and packets can be
+ * snapped to their PPP, IPv4 and TCP/UDP headers.
+ *
+ * The devices must carry plain IPv4 over PPP, like the backhaul link of
+ * LteEpcTopology; on S1-U the flows are hidden inside GTP tunnels.
+ *
+ * \code
+ *   FilteredPcap pcap;
+ *   pcap.AddFilters("100,21");
+ *   pcap.SetHeadersOnly(true);
+ *   pcap.Install(topology.GetBackhaulDevices(), "project-pcap");
+ * \endcode
+ */
+class FilteredPcap
+{
+  public:
+    /// Snap length covering PPP, the largest IPv4 and the largest TCP header
+    static const uint32_t HEADERS_SNAP_LENGTH = 2 + 60 + 60;
+
+    FilteredPcap();
+
+    /**
+     * \param port a port matching the source or the destination port
+     */
+    void AddPort(uint16_t port);
+
+    /**
+     * Add a five-tuple filter; Ipv4Address::GetAny(), port 0 and protocol 0 are
+     * wildcards.
+     *
+     * \param src the source address
+     * \param srcPort the source port
+     * \param dst the destination address
+     * \param dstPort the destination port
+     * \param protocol the IP protocol number
+     */
+    void AddFlow(Ipv4Address src,
+                 uint16_t srcPort,
+                 Ipv4Address dst,
+                 uint16_t dstPort,
+                 uint8_t protocol);
+
+    /**
+     * \param filters comma separated list of ports and five-tuples
+     */
+    void AddFilters(const std::string& filters);
+
+    /**
+     * \param headersOnly whether to snap packets to their headers
+     */
+    void SetHeadersOnly(bool headersOnly);
+
+    /**
+     * Capture only between start and stop.
+     *
+     * \param start start of the window
+     * \param stop end of the window, Time::Max() to capture to the end
+     */
+    void SetWindow(Time start, Time stop);
+
+    /**
+     * Open one <prefix>-<node>-<device>.pcap file per device and start
+     * capturing.
+     *
+     * \param devices point-to-point devices
+     * \param prefix the file name prefix
+     */
+    void Install(NetDeviceContainer devices, const std::string& prefix);
+
+    /// \return the number of packets written
+    uint64_t GetCapturedPackets() const;
+
+  private:
+    /// A five-tuple filter, zero fields are wildcards
+    struct Filter
+    {
+        Ipv4Address src;     //!< source address
+        uint16_t srcPort{0}; //!< source port
+        Ipv4Address dst;     //!< destination address
+        uint16_t dstPort{0}; //!< destination port
+        uint8_t protocol{0}; //!< IP protocol
+        uint16_t port{0};    //!< source or destination port
+    };
+
+    /**
+     * \param packet a packet starting with its PPP header
+     * \return whether the packet matches a filter
+     */
+    bool Matches(Ptr<const Packet> packet) const;
+
+    /**
+     * PromiscSniffer sink.
+     *
+     * \param pcap the capture
+     * \param file the device's file
+     * \param packet the packet
+     */
+    static void Sniff(FilteredPcap* pcap, Ptr<PcapFileWrapper> file, Ptr<const Packet> packet);
+
+    std::vector<Filter> m_filters; //!< filters
+    bool m_headersOnly;            //!< snap to headers
+    Time m_start;                  //!< window start
+    Time m_stop;                   //!< window end
+    uint64_t m_captured;           //!< packets written
+};
+
+} // namespace ns3
+
+#endif /* FILTERED_PCAP_H */
@@ -0,0 +1,514 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-post-processor.h"
+
+#include "ns3/abort.h"
+#include "ns3/gnuplot.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowPostProcessor");
+
+namespace
+{
+
+/// Fewer flows per thread are not worth starting a thread for
+const std::size_t MIN_FLOWS_PER_THREAD = 256;
+
+/// Class of the flows matching no port range
+const char* const BACKGROUND = "background";
+
+/**
+ * \param line a line of XML
+ * \param name an attribute name
+ * \return the attribute's value, empty if the line has none
+ */
+std::string
+GetXmlAttribute(const std::string& line, const std::string& name)
+{
+    std::string key = " " + name + "=\"";
+    std::size_t begin = line.find(key);
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    begin += key.size();
+    return line.substr(begin, line.find('"', begin) - begin);
+}
+
+/**
+ * Index the five-tuples of all flows of a classifier. Its flow map is private,
+ * so they are read back from its <Flow flowId=... sourceAddress=...> XML
+ * elements, which list every flow once.
+ *
+ * \param classifier the classifier
+ * \return the five-tuple of every flow id
+ */
+std::unordered_map<FlowId, Ipv4FlowClassifier::FiveTuple>
+IndexFlows(const Ipv4FlowClassifier& classifier)
+{
+    std::ostringstream xml;
+    classifier.SerializeToXmlStream(xml, 0);
+    std::istringstream lines(xml.str());
+    std::unordered_map<FlowId, Ipv4FlowClassifier::FiveTuple> index;
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        if (line.find("<Flow ") == std::string::npos)
+        {
+            continue;
+        }
+        Ipv4FlowClassifier::FiveTuple t;
+        t.sourceAddress = Ipv4Address(GetXmlAttribute(line, "sourceAddress").c_str());
+        t.destinationAddress = Ipv4Address(GetXmlAttribute(line, "destinationAddress").c_str());
+        t.protocol = std::stoul(GetXmlAttribute(line, "protocol"));
+        t.sourcePort = std::stoul(GetXmlAttribute(line, "sourcePort"));
+        t.destinationPort = std::stoul(GetXmlAttribute(line, "destinationPort"));
+        index[std::stoul(GetXmlAttribute(line, "flowId"))] = t;
+    }
+    return index;
+}
+
+/**
+ * \param c class aggregates
+ * \param r record of a flow of the class
+ * \param s FlowMonitor statistics of the flow
+ */
+void
+AddFlow(FlowPostProcessor::ClassStats& c, const FlowRecord& r, const FlowMonitor::FlowStats& s)
+{
+    if (c.flows == 0)
+    {
+        c.throughputMin = r.throughputKbps;
+        c.throughputMax = r.throughputKbps;
+    }
+    c.flows++;
+    c.txPackets += r.txPackets;
+    c.rxPackets += r.rxPackets;
+    c.txBytes += r.txBytes;
+    c.rxBytes += r.rxBytes;
+    c.delaySum += s.delaySum.GetSeconds();
+    c.jitterSum += s.jitterSum.GetSeconds();
+    c.jitterSamples += r.rxPackets > 1 ? r.rxPackets - 1 : 0;
+    c.throughputSum += r.throughputKbps;
+    c.throughputMin = std::min(c.throughputMin, r.throughputKbps);
+    c.throughputMax = std::max(c.throughputMax, r.throughputKbps);
+}
+
+/**
+ * \param into class aggregates
+ * \param from partial aggregates of the same class
+ */
+void
+Merge(FlowPostProcessor::ClassStats& into, const FlowPostProcessor::ClassStats& from)
+{
+    if (from.flows == 0)
+    {
+        return;
+    }
+    if (into.flows == 0)
+    {
+        into.throughputMin = from.throughputMin;
+        into.throughputMax = from.throughputMax;
+    }
+    into.flows += from.flows;
+    into.txPackets += from.txPackets;
+    into.rxPackets += from.rxPackets;
+    into.txBytes += from.txBytes;
+    into.rxBytes += from.rxBytes;
+    into.delaySum += from.delaySum;
+    into.jitterSum += from.jitterSum;
+    into.jitterSamples += from.jitterSamples;
+    into.throughputSum += from.throughputSum;
+    into.throughputMin = std::min(into.throughputMin, from.throughputMin);
+    into.throughputMax = std::max(into.throughputMax, from.throughputMax);
+}
+
+/**
+ * \param c class aggregates
+ * \return loss [%], mean delay [ms] and mean jitter [ms] of the class
+ */
+std::vector<double>
+GetMeans(const FlowPostProcessor::ClassStats& c)
+{
+    double loss = c.txPackets > 0 ? (c.txPackets - std::min(c.rxPackets, c.txPackets)) * 100.0 /
+                                        c.txPackets
+                                  : 0;
+    double delay = c.rxPackets > 0 ? c.delaySum / c.rxPackets * 1000 : 0;
+    double jitter = c.jitterSamples > 0 ? c.jitterSum / c.jitterSamples * 1000 : 0;
+    return {loss, delay, jitter};
+}
+
+} // namespace
+
+FlowPostProcessor::FlowPostProcessor()
+    : m_threads(0),
+      m_printFlows(true),
+      m_plots(false)
+{
+}
+
+void
+FlowPostProcessor::AddCommandLineValues(CommandLine& cmd)
+{
+    cmd.AddValue("flowClasses",
+                 "Traffic classes of the flow summary as name:port or name:first-last, "
+                 "comma separated; other flows are background",
+                 m_classes);
+    cmd.AddValue("postThreads",
+                 "Threads of the FlowMonitor post-processing, 0 for one per core",
+                 m_threads);
+    cmd.AddValue("flowPlots", "Whether to write the delay and datarate Gnuplot files", m_plots);
+    cmd.AddValue("flowSummary",
+                 "If set, also write the per-class summary as CSV here",
+                 m_summaryFile);
+}
+
+void
+FlowPostProcessor::SetClasses(const std::string& classes)
+{
+    m_classes = classes;
+}
+
+void
+FlowPostProcessor::SetThreads(uint32_t threads)
+{
+    m_threads = threads;
+}
+
+void
+FlowPostProcessor::SetPrintFlows(bool print)
+{
+    m_printFlows = print;
+}
+
+void
+FlowPostProcessor::SetPlots(bool enable, const std::string& prefix)
+{
+    m_plots = enable;
+    m_plotPrefix = prefix;
+}
+
+void
+FlowPostProcessor::AppendPlotExtra(const std::string& delayExtra, const std::string& rateExtra)
+{
+    if (!delayExtra.empty())
+    {
+        m_delayExtra.push_back(delayExtra);
+    }
+    if (!rateExtra.empty())
+    {
+        m_rateExtra.push_back(rateExtra);
+    }
+}
+
+void
+FlowPostProcessor::ParseClasses()
+{
+    m_ports.clear();
+    m_classStats.clear();
+    std::stringstream ss(m_classes);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (token.empty())
+        {
+            continue;
+        }
+        std::size_t colon = token.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos || colon == 0,
+                        "Expected class:port or class:first-last, got " << token);
+        std::string name = token.substr(0, colon);
+        NS_ABORT_MSG_IF(name == BACKGROUND, "The class " << BACKGROUND << " is reserved");
+        std::string ports = token.substr(colon + 1);
+        std::size_t dash = ports.find('-');
+        unsigned long first = std::stoul(ports.substr(0, dash));
+        unsigned long last = dash == std::string::npos ? first : std::stoul(ports.substr(dash + 1));
+        NS_ABORT_MSG_IF(first > last || last > 65535, "Bad port range " << ports << " of " << name);
+
+        uint32_t index = 0;
+        while (index < m_classStats.size() && m_classStats[index].name != name)
+        {
+            index++;
+        }
+        if (index == m_classStats.size())
+        {
+            m_classStats.emplace_back();
+            m_classStats.back().name = name;
+        }
+        m_ports.push_back({static_cast<uint16_t>(first), static_cast<uint16_t>(last), index});
+    }
+    m_classStats.emplace_back();
+    m_classStats.back().name = BACKGROUND;
+}
+
+uint32_t
+FlowPostProcessor::GetClass(uint16_t srcPort, uint16_t dstPort) const
+{
+    for (const auto& range : m_ports)
+    {
+        if ((dstPort >= range.first && dstPort <= range.last) ||
+            (srcPort >= range.first && srcPort <= range.last))
+        {
+            return range.index;
+        }
+    }
+    return m_classStats.size() - 1;
+}
+
+void
+FlowPostProcessor::ProcessChunk(Chunk& chunk,
+                                const std::vector<const FlowMonitor::FlowStats*>& stats,
+                                const std::vector<Ipv4FlowClassifier::FiveTuple>& tuples)
+{
+    std::ostringstream text;
+    for (std::size_t i = chunk.begin; i < chunk.end; i++)
+    {
+        const FlowMonitor::FlowStats& s = *stats[i];
+        const Ipv4FlowClassifier::FiveTuple& t = tuples[i];
+        FlowRecord& flow = m_flows[i];
+        flow = MakeFlowRecord(flow.flowId, t, s);
+        m_flowClass[i] = GetClass(t.sourcePort, t.destinationPort);
+        AddFlow(chunk.classes[m_flowClass[i]], flow, s);
+        if (!m_printFlows)
+        {
+            continue;
+        }
+        text << "Flow ID: " << flow.flowId << "\n";
+        text << "Src add: " << t.sourceAddress << "-> Dst add: " << t.destinationAddress << "\n";
+        text << "Src port: " << t.sourcePort << "-> Dst port: " << t.destinationPort << "\n";
+        text << "Tx Packets/Bytes: " << flow.txPackets << "/" << flow.txBytes << "\n";
+        text << "Rx Packets/Bytes: " << flow.rxPackets << "/" << flow.rxBytes << "\n";
+        text << "Throughput: " << flow.throughputKbps << "kb/s\n";
+        text << "Delay sum: " << s.delaySum.GetMilliSeconds() << "ms\n";
+        text << "Mean delay: " << flow.meanDelayMs << "ms\n";
+        text << "Jitter sum: " << s.jitterSum.GetMilliSeconds() << "ms\n";
+        text << "Mean jitter: " << flow.meanJitterMs << "ms\n";
+        text << "Lost Packets: " << flow.lostPackets << "\n";
+        text << "Packet loss: " << flow.lossPercent << "%\n";
+        text << "------------------------------------------------\n";
+    }
+    chunk.text = text.str();
+}
+
+void
+FlowPostProcessor::Process(Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier)
+{
+    NS_LOG_FUNCTION(this);
+    ParseClasses();
+
+    const FlowMonitor::FlowStatsContainer& container = monitor->GetFlowStats();
+    std::unordered_map<FlowId, Ipv4FlowClassifier::FiveTuple> index = IndexFlows(*classifier);
+    std::vector<const FlowMonitor::FlowStats*> stats;
+    std::vector<Ipv4FlowClassifier::FiveTuple> tuples;
+    stats.reserve(container.size());
+    tuples.reserve(container.size());
+    m_flows.assign(container.size(), FlowRecord());
+    m_flowClass.assign(container.size(), 0);
+    for (const auto& [flowId, flowStats] : container)
+    {
+        m_flows[stats.size()].flowId = flowId;
+        stats.push_back(&flowStats);
+        auto t = index.find(flowId);
+        tuples.push_back(t != index.end() ? t->second : classifier->FindFlow(flowId));
+    }
+
+    std::size_t n = stats.size();
+    std::size_t threads = m_threads > 0 ? m_threads : std::thread::hardware_concurrency();
+    threads = std::max<std::size_t>(1, std::min(threads, n / MIN_FLOWS_PER_THREAD));
+
+    std::vector<ClassStats> empty(m_classStats.size());
+    std::vector<Chunk> chunks(threads);
+    for (std::size_t c = 0; c < threads; c++)
+    {
+        chunks[c].begin = n * c / threads;
+        chunks[c].end = n * (c + 1) / threads;
+        chunks[c].classes = empty;
+    }
+
+    // The calling thread takes the last chunk itself
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t c = 0; c + 1 < threads; c++)
+    {
+        workers.emplace_back(&FlowPostProcessor::ProcessChunk,
+                             this,
+                             std::ref(chunks[c]),
+                             std::cref(stats),
+                             std::cref(tuples));
+    }
+    ProcessChunk(chunks.back(), stats, tuples);
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    m_flowText.clear();
+    for (auto& chunk : chunks)
+    {
+        for (std::size_t i = 0; i < m_classStats.size(); i++)
+        {
+            Merge(m_classStats[i], chunk.classes[i]);
+        }
+        m_flowText.push_back(std::move(chunk.text));
+    }
+    NS_LOG_INFO(n << " flows post-processed by " << threads << " threads");
+}
+
+const std::vector<FlowRecord>&
+FlowPostProcessor::GetFlows() const
+{
+    return m_flows;
+}
+
+const std::vector<FlowPostProcessor::ClassStats>&
+FlowPostProcessor::GetClasses() const
+{
+    return m_classStats;
+}
+
+void
+FlowPostProcessor::Print(std::ostream& os) const
+{
+    if (m_printFlows)
+    {
+        os << "\n*** Flow monitor statistic ***\n";
+        for (const auto& text : m_flowText)
+        {
+            os << text;
+        }
+    }
+
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "\n*** Flow classes ***\n";
+    os << std::left << std::setw(12) << "class" << std::right << std::setw(8) << "flows"
+       << std::setw(12) << "tx packets" << std::setw(12) << "rx packets" << std::setw(10)
+       << "loss [%]" << std::setw(12) << "delay [ms]" << std::setw(13) << "jitter [ms]"
+       << std::setw(12) << "sum [kb/s]" << std::setw(12) << "mean [kb/s]" << std::setw(12)
+       << "min [kb/s]" << std::setw(12) << "max [kb/s]"
+       << "\n";
+    for (const auto& c : m_classStats)
+    {
+        if (c.flows == 0)
+        {
+            continue;
+        }
+        std::vector<double> means = GetMeans(c);
+        os << std::left << std::setw(12) << c.name << std::right << std::setw(8) << c.flows
+           << std::setw(12) << c.txPackets << std::setw(12) << c.rxPackets << std::fixed
+           << std::setprecision(2) << std::setw(10) << means[0] << std::setw(12) << means[1]
+           << std::setw(13) << means[2] << std::setw(12) << c.throughputSum << std::setw(12)
+           << c.throughputSum / c.flows << std::setw(12) << c.throughputMin << std::setw(12)
+           << c.throughputMax << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    os.flush();
+
+    if (!m_summaryFile.empty())
+    {
+        WriteSummary(m_summaryFile);
+    }
+}
+
+void
+FlowPostProcessor::WriteSummary(const std::string& filename) const
+{
+    std::ofstream out(filename);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << filename);
+    out << "class,flows,txPackets,rxPackets,txBytes,rxBytes,lossPercent,meanDelayMs,"
+           "meanJitterMs,sumThroughputKbps,meanThroughputKbps,minThroughputKbps,"
+           "maxThroughputKbps\n";
+    for (const auto& c : m_classStats)
+    {
+        std::vector<double> means = GetMeans(c);
+        double mean = c.flows > 0 ? c.throughputSum / c.flows : 0;
+        out << c.name << "," << c.flows << "," << c.txPackets << "," << c.rxPackets << ","
+            << c.txBytes << "," << c.rxBytes << "," << means[0] << "," << means[1] << ","
+            << means[2] << "," << c.throughputSum << "," << mean << "," << c.throughputMin
+            << "," << c.throughputMax << "\n";
+    }
+}
+
+void
+FlowPostProcessor::WritePlots() const
+{
+    if (!m_plots)
+    {
+        return;
+    }
+
+    Gnuplot delay(m_plotPrefix + "delay.png");
+    delay.SetTitle("Average delay");
+    delay.SetTerminal("png");
+    delay.SetLegend("Flow ID", "Delay [ms]");
+    delay.AppendExtra("set grid");
+    for (const auto& extra : m_delayExtra)
+    {
+        delay.AppendExtra(extra);
+    }
+    Gnuplot rate(m_plotPrefix + "datarate.png");
+    rate.SetTitle("Data rate per flow");
+    rate.SetTerminal("png");
+    rate.SetLegend("Flow ID", "Data rate [kb/s]");
+    rate.AppendExtra("set grid");
+    for (const auto& extra : m_rateExtra)
+    {
+        rate.AppendExtra(extra);
+    }
+
+    // One dataset per class, so every class gets its own colour
+    std::vector<Gnuplot2dDataset> delays(m_classStats.size());
+    std::vector<Gnuplot2dDataset> rates(m_classStats.size());
+    for (std::size_t c = 0; c < m_classStats.size(); c++)
+    {
+        delays[c].SetTitle(m_classStats[c].name);
+        delays[c].SetStyle(Gnuplot2dDataset::POINTS);
+        rates[c].SetTitle(m_classStats[c].name);
+        rates[c].SetStyle(Gnuplot2dDataset::POINTS);
+    }
+    for (std::size_t i = 0; i < m_flows.size(); i++)
+    {
+        delays[m_flowClass[i]].Add(m_flows[i].flowId, m_flows[i].meanDelayMs);
+        rates[m_flowClass[i]].Add(m_flows[i].flowId, m_flows[i].throughputKbps);
+    }
+    for (std::size_t c = 0; c < m_classStats.size(); c++)
+    {
+        if (m_classStats[c].flows > 0)
+        {
+            delay.AddDataset(delays[c]);
+            rate.AddDataset(rates[c]);
+        }
+    }
+
+    std::ofstream delayFile(m_plotPrefix + "delay.plt");
+    delay.GenerateOutput(delayFile);
+    std::ofstream rateFile(m_plotPrefix + "datarate.plt");
+    rate.GenerateOutput(rateFile);
+}
+
+} // namespace ns3
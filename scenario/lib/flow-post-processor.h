@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_POST_PROCESSOR_H
+#define FLOW_POST_PROCESSOR_H
+
+#include "results-writer.h"
+
+#include "ns3/command-line.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Post-run statistics of a FlowMonitor: per-flow records, per-class
+ * aggregates, the summary table and the delay and data rate Gnuplot files.
+ *
+ * Ipv4FlowClassifier::FindFlow() searches the whole flow map, so looking up
+ * every flow with it costs O(flows^2). The five-tuples of all flows are
+ * instead indexed once, in O(flows), from the classifier's XML serialization,
+ * the only complete view of the map it offers. The flows are then split into
+ * contiguous chunks processed by worker threads, each doing the FlowRecord
+ * math, the class aggregates and (if printed) the per-flow text of its chunk.
+ * The partial aggregates and texts are merged in flow id order afterwards, so
+ * the output does not depend on the number of threads.
+ *
+ * Classes are written "video:100,ftp:21,web:8000-8080": a flow belongs to the
+ * first class whose port range holds its source or destination port (so TCP
+ * acknowledgements count with their data), all others to "background".
+ *
+ * \code
+ *   FlowPostProcessor post;
+ *   post.SetClasses("video:100,ftp:21");
+ *   post.AddCommandLineValues(cmd);
+ *   ...
+ *   post.Process(monitor, classifier);
+ *   post.Print(std::cout);
+ *   post.WritePlots();
+ * \endcode
+ */
+class FlowPostProcessor
+{
+  public:
+    /// Aggregates of a traffic class
+    struct ClassStats
+    {
+        std::string name;          //!< class name
+        uint32_t flows{0};         //!< flows
+        uint64_t txPackets{0};     //!< transmitted packets
+        uint64_t rxPackets{0};     //!< received packets
+        uint64_t txBytes{0};       //!< transmitted bytes
+        uint64_t rxBytes{0};       //!< received bytes
+        double delaySum{0};        //!< delay of the received packets [s]
+        double jitterSum{0};       //!< jitter of the received packets [s]
+        uint64_t jitterSamples{0}; //!< received packets with a jitter sample
+        double throughputSum{0};   //!< sum of the flow throughputs [kb/s]
+        double throughputMin{0};   //!< lowest flow throughput [kb/s]
+        double throughputMax{0};   //!< highest flow throughput [kb/s]
+    };
+
+    FlowPostProcessor();
+
+    /**
+     * Register --flowClasses, --postThreads, --flowPlots and --flowSummary
+     * with the command line.
+     *
+     * \param cmd the command line
+     */
+    void AddCommandLineValues(CommandLine& cmd);
+
+    /**
+     * \param classes comma separated list of name:port or name:first-last
+     */
+    void SetClasses(const std::string& classes);
+
+    /**
+     * \param threads worker threads, 0 for one per core
+     */
+    void SetThreads(uint32_t threads);
+
+    /**
+     * \param print whether Print() writes every flow before the class table
+     */
+    void SetPrintFlows(bool print);
+
+    /**
+     * \param enable whether WritePlots() writes the Gnuplot files
+     * \param prefix prefix of the delay and datarate .plt and .png files
+     */
+    void SetPlots(bool enable, const std::string& prefix = "");
+
+    /**
+     * Add a Gnuplot command, such as "set yrange [0:100]", to the plots; an
+     * empty command leaves that plot alone.
+     *
+     * \param delayExtra command for the delay plot
+     * \param rateExtra command for the datarate plot
+     */
+    void AppendPlotExtra(const std::string& delayExtra, const std::string& rateExtra);
+
+    /**
+     * Compute the records and aggregates of every flow of the monitor. Call
+     * FlowMonitor::CheckForLostPackets() first.
+     *
+     * \param monitor the flow monitor
+     * \param classifier its classifier
+     */
+    void Process(Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier);
+
+    /// \return the records of all flows, in flow id order
+    const std::vector<FlowRecord>& GetFlows() const;
+
+    /// \return the aggregates per class, "background" last
+    const std::vector<ClassStats>& GetClasses() const;
+
+    /**
+     * Print the flows (if enabled) and the class table, and write the
+     * --flowSummary CSV if set.
+     *
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+    /// Write <prefix>delay.plt and <prefix>datarate.plt if plots are enabled
+    void WritePlots() const;
+
+  private:
+    /// Port range of a class
+    struct PortRange
+    {
+        uint16_t first; //!< first port
+        uint16_t last;  //!< last port
+        uint32_t index; //!< class index
+    };
+
+    /// Flows handed to one worker
+    struct Chunk
+    {
+        std::size_t begin;               //!< first flow
+        std::size_t end;                 //!< past the last flow
+        std::vector<ClassStats> classes; //!< partial aggregates
+        std::string text;                //!< per-flow text
+    };
+
+    /// Parse m_classes into m_ports and the class names
+    void ParseClasses();
+
+    /**
+     * \param srcPort source port of a flow
+     * \param dstPort destination port of a flow
+     * \return the index of its class
+     */
+    uint32_t GetClass(uint16_t srcPort, uint16_t dstPort) const;
+
+    /**
+     * Process the flows of a chunk; runs on a worker thread.
+     *
+     * \param chunk the chunk
+     * \param stats FlowMonitor statistics of every flow
+     * \param tuples five-tuple of every flow
+     */
+    void ProcessChunk(Chunk& chunk,
+                      const std::vector<const FlowMonitor::FlowStats*>& stats,
+                      const std::vector<Ipv4FlowClassifier::FiveTuple>& tuples);
+
+    /**
+     * \param filename the CSV file of the class table
+     */
+    void WriteSummary(const std::string& filename) const;
+
+    std::string m_classes;                 //!< class specification
+    uint32_t m_threads;                    //!< worker threads, 0 for one per core
+    bool m_printFlows;                     //!< print every flow
+    bool m_plots;                          //!< write the Gnuplot files
+    std::string m_plotPrefix;              //!< Gnuplot file prefix
+    std::vector<std::string> m_delayExtra; //!< extra commands of the delay plot
+    std::vector<std::string> m_rateExtra;  //!< extra commands of the datarate plot
+    std::string m_summaryFile;             //!< CSV of the class table, if set
+    std::vector<PortRange> m_ports;        //!< port ranges of the classes
+    std::vector<FlowRecord> m_flows;       //!< records, in flow id order
+    std::vector<uint32_t> m_flowClass;     //!< class index per record
+    std::vector<ClassStats> m_classStats;  //!< aggregates per class
+    std::vector<std::string> m_flowText;   //!< per-flow text per chunk
+};
+
+} // namespace ns3
+
+#endif /* FLOW_POST_PROCESSOR_H */
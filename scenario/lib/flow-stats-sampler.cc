@@ -0,0 +1,154 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-stats-sampler.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsSampler");
+
+FlowStatsSampler::FlowStatsSampler()
+    : m_interval(Seconds(1)),
+      m_writer(nullptr),
+      m_started(false)
+{
+}
+
+FlowStatsSampler::~FlowStatsSampler()
+{
+    m_event.Cancel();
+}
+
+void
+FlowStatsSampler::SetInterval(Time interval)
+{
+    NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "The sampling interval must be positive");
+    m_interval = interval;
+}
+
+void
+FlowStatsSampler::SetSampleCallback(SampleCallback callback)
+{
+    m_callback = callback;
+}
+
+void
+FlowStatsSampler::Start(Ptr<FlowMonitor> monitor, ResultsWriter* writer)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(writer == nullptr && m_callback.IsNull(),
+                    "Flow sampling needs results or a sample callback");
+    NS_ABORT_MSG_IF(writer != nullptr && !writer->IsOpen(), "Flow sampling needs open results");
+
+    m_monitor = monitor;
+    m_writer = writer;
+    m_started = true;
+    m_last.clear();
+    for (const auto& [flowId, stats] : m_monitor->GetFlowStats())
+    {
+        m_last[flowId] = GetCounters(stats);
+    }
+    m_lastSample = Simulator::Now();
+    m_event = Simulator::Schedule(m_interval, &FlowStatsSampler::Sample, this);
+}
+
+void
+FlowStatsSampler::Stop()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_started)
+    {
+        return;
+    }
+    m_event.Cancel();
+    if (Simulator::Now() > m_lastSample)
+    {
+        Sample();
+        m_event.Cancel();
+    }
+    m_monitor = nullptr;
+    m_writer = nullptr;
+    m_started = false;
+}
+
+FlowStatsSampler::Counters
+FlowStatsSampler::GetCounters(const FlowMonitor::FlowStats& stats)
+{
+    Counters c;
+    c.txPackets = stats.txPackets;
+    c.rxPackets = stats.rxPackets;
+    c.rxBytes = stats.rxBytes;
+    c.lostPackets = stats.lostPackets;
+    c.delaySum = stats.delaySum;
+    c.jitterSum = stats.jitterSum;
+    return c;
+}
+
+void
+FlowStatsSampler::Sample()
+{
+    Time now = Simulator::Now();
+    double seconds = (now - m_lastSample).GetSeconds();
+    m_lastSample = now;
+
+    // Also drops the packets that will never arrive from the monitor's tracking
+    m_monitor->CheckForLostPackets();
+
+    std::vector<FlowIntervalRecord> records;
+    for (const auto& [flowId, stats] : m_monitor->GetFlowStats())
+    {
+        Counters& last = m_last[flowId];
+        if (stats.txPackets == last.txPackets && stats.rxPackets == last.rxPackets &&
+            stats.lostPackets == last.lostPackets)
+        {
+            continue;
+        }
+
+        FlowIntervalRecord r;
+        r.time = now.GetSeconds();
+        r.flowId = flowId;
+        r.txPackets = stats.txPackets - last.txPackets;
+        r.rxPackets = stats.rxPackets - last.rxPackets;
+        r.rxBytes = stats.rxBytes - last.rxBytes;
+        r.throughputKbps = r.rxBytes * 8.0 / seconds / 1024;
+        if (r.rxPackets > 0)
+        {
+            r.meanDelayMs = (stats.delaySum - last.delaySum).GetSeconds() / r.rxPackets * 1000;
+            r.meanJitterMs = (stats.jitterSum - last.jitterSum).GetSeconds() / r.rxPackets * 1000;
+        }
+        r.lostPackets = stats.lostPackets - last.lostPackets;
+        if (m_writer != nullptr)
+        {
+            m_writer->Write(r);
+        }
+        records.push_back(r);
+        last = GetCounters(stats);
+    }
+
+    if (!m_callback.IsNull())
+    {
+        m_callback(records);
+    }
+
+    m_event = Simulator::Schedule(m_interval, &FlowStatsSampler::Sample, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_STATS_SAMPLER_H
+#define FLOW_STATS_SAMPLER_H
+
+#include "results-writer.h"
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Periodically samples a FlowMonitor while the simulation runs and streams the
+ * per-flow change since the previous sample (packets, bytes, throughput, mean
+ * delay and jitter, lost packets) as FlowIntervalRecord rows to the
+ * "intervals" table of a ResultsWriter.
+ *
+ * Only flows with traffic in an interval get a row. Lost packet detection is
+ * run on every sample, which keeps the set of packets the monitor tracks
+ * bounded on long runs.
+ *
+ * Instead of, or in addition to, the writer a callback can receive the rows of
+ * every sample, e.g. to compute statistics while the simulation runs.
+ */
+class FlowStatsSampler
+{
+  public:
+    /// Receives the rows of one sample
+    typedef Callback<void, const std::vector<FlowIntervalRecord>&> SampleCallback;
+
+    FlowStatsSampler();
+    ~FlowStatsSampler();
+
+    /**
+     * \param interval time between two samples
+     */
+    void SetInterval(Time interval);
+
+    /**
+     * \param callback called after every sample with its rows
+     */
+    void SetSampleCallback(SampleCallback callback);
+
+    /**
+     * Schedule the first sample one interval from now. The first sample only
+     * covers what happens from now on.
+     *
+     * \param monitor the flow monitor to sample
+     * \param writer the open results writer receiving the samples, or nullptr
+     *        if only the sample callback is used
+     */
+    void Start(Ptr<FlowMonitor> monitor, ResultsWriter* writer);
+
+    /**
+     * Take a last sample of the time since the previous one and stop sampling.
+     * Call after Simulator::Run().
+     */
+    void Stop();
+
+  private:
+    /// Counters of a flow at the previous sample
+    struct Counters
+    {
+        uint32_t txPackets{0};   //!< transmitted packets
+        uint32_t rxPackets{0};   //!< received packets
+        uint64_t rxBytes{0};     //!< received bytes
+        uint32_t lostPackets{0}; //!< lost packets
+        Time delaySum;           //!< sum of the delays
+        Time jitterSum;          //!< sum of the jitters
+    };
+
+    /**
+     * \param stats the current statistics of a flow
+     * \return the counters of the statistics
+     */
+    static Counters GetCounters(const FlowMonitor::FlowStats& stats);
+
+    /// Write the changes since the previous sample and schedule the next one
+    void Sample();
+
+    Time m_interval;                   //!< time between samples
+    Time m_lastSample;                 //!< time of the previous sample
+    Ptr<FlowMonitor> m_monitor;        //!< sampled monitor
+    ResultsWriter* m_writer;           //!< output
+    SampleCallback m_callback;         //!< sample callback
+    bool m_started;                    //!< between Start() and Stop()
+    std::map<FlowId, Counters> m_last; //!< counters at the previous sample
+    EventId m_event;                   //!< next sample
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_SAMPLER_H */
@@ -0,0 +1,316 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lte-epc-topology.h"
+
+#include "phase-timer.h"
+
+#include "ns3/config.h"
+#include "ns3/epc-mme-application.h"
+#include "ns3/ipv4-address-generator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LteEpcTopology");
+
+LteEpcTopology::LteEpcTopology()
+    : m_useEpc(true),
+      m_dlBandwidth(25),
+      m_ulBandwidth(25),
+      m_bandwidthSet(false),
+      m_remoteHostSystemId(0),
+      m_replications(0)
+{
+    SetBackhaul(DataRate("100Gb/s"), 1500, MilliSeconds(10));
+}
+
+void
+LteEpcTopology::SetUseEpc(bool useEpc)
+{
+    m_useEpc = useEpc;
+}
+
+void
+LteEpcTopology::SetCarrierAggregation(bool useCa, uint8_t numberOfCarriers)
+{
+    Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(useCa));
+    if (useCa)
+    {
+        Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers",
+                           UintegerValue(numberOfCarriers));
+        Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager",
+                           StringValue("ns3::RrComponentCarrierManager"));
+    }
+}
+
+void
+LteEpcTopology::SetBandwidth(uint16_t dlBandwidth, uint16_t ulBandwidth)
+{
+    m_dlBandwidth = dlBandwidth;
+    m_ulBandwidth = ulBandwidth;
+    m_bandwidthSet = true;
+}
+
+void
+LteEpcTopology::SetRemoteHostSystemId(uint32_t systemId)
+{
+    m_remoteHostSystemId = systemId;
+}
+
+void
+LteEpcTopology::SetBackhaul(DataRate dataRate, uint16_t mtu, Time delay)
+{
+    m_backhaul.SetDeviceAttribute("DataRate", DataRateValue(dataRate));
+    m_backhaul.SetDeviceAttribute("Mtu", UintegerValue(mtu));
+    m_backhaul.SetChannelAttribute("Delay", TimeValue(delay));
+}
+
+void
+LteEpcTopology::Create(uint16_t numberOfEnbs, uint16_t numberOfUes)
+{
+    NS_LOG_FUNCTION(this << numberOfEnbs << numberOfUes);
+
+    if (m_replications > 0)
+    {
+        Clear();
+    }
+    m_replications++;
+
+    m_lteHelper = CreateObject<LteHelper>();
+    if (m_bandwidthSet)
+    {
+        m_lteHelper->SetEnbDeviceAttribute("DlBandwidth", UintegerValue(m_dlBandwidth));
+        m_lteHelper->SetEnbDeviceAttribute("UlBandwidth", UintegerValue(m_ulBandwidth));
+    }
+
+    if (m_useEpc)
+    {
+        m_epcHelper = CreateObject<PointToPointEpcHelper>();
+        m_lteHelper->SetEpcHelper(m_epcHelper);
+
+        // The MME is the node running the MME application
+        for (auto it = NodeList::Begin(); it != NodeList::End() && !m_mme; ++it)
+        {
+            for (uint32_t i = 0; i < (*it)->GetNApplications(); i++)
+            {
+                if (DynamicCast<EpcMmeApplication>((*it)->GetApplication(i)))
+                {
+                    m_mme = *it;
+                    break;
+                }
+            }
+        }
+
+        // Remote host behind the PGW
+        NodeContainer remoteHostContainer;
+        remoteHostContainer.Create(1, m_remoteHostSystemId);
+        m_remoteHost = remoteHostContainer.Get(0);
+        InternetStackHelper internet;
+        internet.Install(remoteHostContainer);
+
+        m_backhaulDevices = m_backhaul.Install(m_epcHelper->GetPgwNode(), m_remoteHost);
+        Ipv4AddressHelper ipv4h;
+        ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+        Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(m_backhaulDevices);
+        // interface 0 is localhost, 1 is the p2p device
+        m_remoteHostAddress = internetIpIfaces.GetAddress(1);
+
+        Ipv4StaticRoutingHelper ipv4RoutingHelper;
+        Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(m_remoteHost->GetObject<Ipv4>());
+        remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"),
+                                                   Ipv4Mask("255.0.0.0"),
+                                                   1);
+    }
+
+    m_enbNodes.Create(numberOfEnbs);
+    m_ueNodes.Create(numberOfUes);
+}
+
+void
+LteEpcTopology::InstallLteDevices()
+{
+    NS_LOG_FUNCTION(this);
+
+    {
+        PhaseTimer::Scope phase("InstallEnbDevice");
+        m_enbDevices = m_lteHelper->InstallEnbDevice(m_enbNodes);
+    }
+    {
+        PhaseTimer::Scope phase("InstallUeDevice");
+        m_ueDevices = m_lteHelper->InstallUeDevice(m_ueNodes);
+    }
+
+    if (!m_useEpc)
+    {
+        return;
+    }
+
+    PhaseTimer::Scope phase("AssignUeIpv4Address");
+    InternetStackHelper internet;
+    internet.Install(m_ueNodes);
+    m_ueInterfaces = m_epcHelper->AssignUeIpv4Address(m_ueDevices);
+
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    for (uint32_t u = 0; u < m_ueNodes.GetN(); ++u)
+    {
+        // Set the default gateway for the UE
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(m_ueNodes.Get(u)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(m_epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+}
+
+void
+LteEpcTopology::Attach()
+{
+    PhaseTimer::Scope phase("Attach");
+    m_lteHelper->Attach(m_ueDevices);
+}
+
+void
+LteEpcTopology::Attach(uint32_t ue, uint32_t enb)
+{
+    // side effect: the default EPS bearer will be activated
+    m_lteHelper->Attach(m_ueDevices.Get(ue), m_enbDevices.Get(enb));
+}
+
+void
+LteEpcTopology::Clear()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_lteHelper = nullptr;
+    m_epcHelper = nullptr;
+    m_mme = nullptr;
+    m_remoteHost = nullptr;
+    m_remoteHostAddress = Ipv4Address();
+    m_backhaulDevices = NetDeviceContainer();
+    m_enbNodes = NodeContainer();
+    m_ueNodes = NodeContainer();
+    m_enbDevices = NetDeviceContainer();
+    m_ueDevices = NetDeviceContainer();
+    m_ueInterfaces = Ipv4InterfaceContainer();
+
+    // The address generator outlives Simulator::Destroy() and would otherwise
+    // report the 1.0.0.0 and 7.0.0.0 addresses of the next replication as
+    // duplicates
+    Ipv4AddressGenerator::Reset();
+}
+
+Ptr<LteHelper>
+LteEpcTopology::GetLteHelper() const
+{
+    return m_lteHelper;
+}
+
+Ptr<PointToPointEpcHelper>
+LteEpcTopology::GetEpcHelper() const
+{
+    return m_epcHelper;
+}
+
+PointToPointHelper&
+LteEpcTopology::GetBackhaulHelper()
+{
+    return m_backhaul;
+}
+
+NetDeviceContainer
+LteEpcTopology::GetBackhaulDevices() const
+{
+    return m_backhaulDevices;
+}
+
+Ptr<Node>
+LteEpcTopology::GetPgw() const
+{
+    return m_epcHelper ? m_epcHelper->GetPgwNode() : nullptr;
+}
+
+Ptr<Node>
+LteEpcTopology::GetSgw() const
+{
+    return m_epcHelper ? m_epcHelper->GetSgwNode() : nullptr;
+}
+
+Ptr<Node>
+LteEpcTopology::GetMme() const
+{
+    return m_mme;
+}
+
+Ptr<Node>
+LteEpcTopology::GetRemoteHost() const
+{
+    return m_remoteHost;
+}
+
+Ipv4Address
+LteEpcTopology::GetRemoteHostAddress() const
+{
+    return m_remoteHostAddress;
+}
+
+NodeContainer
+LteEpcTopology::GetEnbNodes() const
+{
+    return m_enbNodes;
+}
+
+NodeContainer
+LteEpcTopology::GetUeNodes() const
+{
+    return m_ueNodes;
+}
+
+NetDeviceContainer
+LteEpcTopology::GetEnbDevices() const
+{
+    return m_enbDevices;
+}
+
+NetDeviceContainer
+LteEpcTopology::GetUeDevices() const
+{
+    return m_ueDevices;
+}
+
+Ipv4Address
+LteEpcTopology::GetUeAddress(uint32_t ue) const
+{
+    if (ue < m_ueInterfaces.GetN())
+    {
+        return m_ueInterfaces.GetAddress(ue);
+    }
+    // UEs are numbered from the PGW's address in the UE network on
+    NS_ABORT_MSG_IF(!m_epcHelper, "UE addresses need the EPC");
+    return Ipv4Address(m_epcHelper->GetUeDefaultGatewayAddress().Get() + 1 + ue);
+}
+
+Ipv4InterfaceContainer
+LteEpcTopology::GetUeInterfaces() const
+{
+    return m_ueInterfaces;
+}
+
+uint32_t
+LteEpcTopology::GetReplications() const
+{
+    return m_replications;
+}
+
+} // namespace ns3
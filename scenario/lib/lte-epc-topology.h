@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_EPC_TOPOLOGY_H
+#define LTE_EPC_TOPOLOGY_H
+
+#include "ns3/data-rate.h"
+#include "ns3/internet-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nstime.h"
+#include "ns3/point-to-point-helper.h"
+
+namespace ns3
+{
+
+/**
+ * Builds the LTE/EPC topology shared by the project scenarios: the EPC core
+ * (PGW, SGW, MME), a remote host behind a point-to-point backhaul link with a
+ * static route towards the UE network, and the eNB and UE nodes with their
+ * LTE devices, IP stack and default routes.
+ *
+ * The configuration set through the Set* methods is kept, so one topology
+ * object can build many independent replications in the same process:
+ *
+ * \code
+ *   LteEpcTopology topology;
+ *   topology.SetBandwidth(75, 75);
+ *   for (run = 1; run <= runs; run++)
+ *   {
+ *       RngSeedManager::SetRun(run);
+ *       topology.Create(3, 15);
+ *       // install mobility on GetEnbNodes() and GetUeNodes()
+ *       topology.InstallLteDevices();
+ *       topology.Attach();
+ *       // install applications, Simulator::Run()
+ *       Simulator::Destroy();
+ *   }
+ * \endcode
+ */
+class LteEpcTopology
+{
+  public:
+    LteEpcTopology();
+
+    /**
+     * \param useEpc whether to create the EPC core and the remote host; without
+     *        it only eNBs and UEs with LTE devices are created
+     */
+    void SetUseEpc(bool useEpc);
+
+    /**
+     * Enable carrier aggregation with round robin component carrier management.
+     *
+     * The attribute defaults are set immediately, so call this before
+     * ConfigStore::ConfigureDefaults() to let an input file override them.
+     *
+     * \param useCa whether to use carrier aggregation
+     * \param numberOfCarriers number of component carriers
+     */
+    void SetCarrierAggregation(bool useCa, uint8_t numberOfCarriers = 2);
+
+    /**
+     * Set the eNB bandwidths of the devices installed from now on. Without
+     * this call the LteEnbNetDevice attribute defaults apply, as set by
+     * ConfigStore or on the command line.
+     *
+     * \param dlBandwidth eNB downlink bandwidth [RBs]
+     * \param ulBandwidth eNB uplink bandwidth [RBs]
+     */
+    void SetBandwidth(uint16_t dlBandwidth, uint16_t ulBandwidth);
+
+    /**
+     * Configure the PGW - remote host link.
+     *
+     * \param dataRate link data rate
+     * \param mtu link MTU
+     * \param delay link delay
+     */
+    void SetBackhaul(DataRate dataRate, uint16_t mtu, Time delay);
+
+    /**
+     * Put the remote host into another partition of a distributed (MPI)
+     * simulation. The backhaul link then becomes a remote channel and its delay
+     * the lookahead; everything else stays in partition 0.
+     *
+     * \param systemId the MPI rank owning the remote host
+     */
+    void SetRemoteHostSystemId(uint32_t systemId);
+
+    /**
+     * Start a new replication: create the LTE and EPC helpers, the core network
+     * with the remote host and the (still empty) eNB and UE nodes.
+     *
+     * Mobility models must be installed on GetEnbNodes() and GetUeNodes()
+     * before calling InstallLteDevices(). When called again after
+     * Simulator::Destroy(), the state of the previous replication is released
+     * first.
+     *
+     * \param numberOfEnbs number of eNB nodes
+     * \param numberOfUes number of UE nodes
+     */
+    void Create(uint16_t numberOfEnbs, uint16_t numberOfUes);
+
+    /**
+     * Install the LTE devices on the eNBs and UEs and, with EPC, the IP stack,
+     * addresses and default routes on the UEs.
+     */
+    void InstallLteDevices();
+
+    /**
+     * Attach every UE to an eNB by initial cell selection.
+     */
+    void Attach();
+
+    /**
+     * Attach one UE to a given eNB.
+     *
+     * \param ue index of the UE
+     * \param enb index of the eNB
+     */
+    void Attach(uint32_t ue, uint32_t enb);
+
+    /**
+     * Drop every reference held on the current replication and reset the
+     * global IPv4 address allocation, so the next Create() can reuse the same
+     * address ranges.
+     */
+    void Clear();
+
+    /// \return the LTE helper of the current replication
+    Ptr<LteHelper> GetLteHelper() const;
+    /// \return the EPC helper of the current replication
+    Ptr<PointToPointEpcHelper> GetEpcHelper() const;
+    /// \return the helper of the backhaul link, e.g. to enable PCAP on it
+    PointToPointHelper& GetBackhaulHelper();
+    /// \return the PGW and remote host devices of the backhaul link
+    NetDeviceContainer GetBackhaulDevices() const;
+    /// \return the PGW node
+    Ptr<Node> GetPgw() const;
+    /// \return the SGW node
+    Ptr<Node> GetSgw() const;
+    /// \return the MME node
+    Ptr<Node> GetMme() const;
+    /// \return the remote host
+    Ptr<Node> GetRemoteHost() const;
+    /// \return the address of the remote host on the backhaul link
+    Ipv4Address GetRemoteHostAddress() const;
+    /// \return the eNB nodes
+    NodeContainer GetEnbNodes() const;
+    /// \return the UE nodes
+    NodeContainer GetUeNodes() const;
+    /// \return the eNB LTE devices
+    NetDeviceContainer GetEnbDevices() const;
+    /// \return the UE LTE devices
+    NetDeviceContainer GetUeDevices() const;
+    /// \return the UE IP interfaces
+    Ipv4InterfaceContainer GetUeInterfaces() const;
+
+    /**
+     * The address of a UE, also known without LTE devices installed (in the
+     * partition of the remote host) as addresses are handed out in UE order.
+     *
+     * \param ue the UE index
+     * \return the UE's address
+     */
+    Ipv4Address GetUeAddress(uint32_t ue) const;
+
+    /// \return the number of replications created so far
+    uint32_t GetReplications() const;
+
+  private:
+    bool m_useEpc;                          //!< create the EPC core and remote host
+    uint16_t m_dlBandwidth;                 //!< eNB downlink bandwidth [RBs]
+    uint16_t m_ulBandwidth;                 //!< eNB uplink bandwidth [RBs]
+    bool m_bandwidthSet;                    //!< SetBandwidth() was called
+    PointToPointHelper m_backhaul;          //!< PGW - remote host link
+    uint32_t m_remoteHostSystemId;          //!< MPI rank of the remote host
+    uint32_t m_replications;                //!< number of Create() calls
+
+    Ptr<LteHelper> m_lteHelper;             //!< LTE helper
+    Ptr<PointToPointEpcHelper> m_epcHelper; //!< EPC helper
+    Ptr<Node> m_mme;                        //!< MME node
+    Ptr<Node> m_remoteHost;                 //!< remote host
+    Ipv4Address m_remoteHostAddress;        //!< remote host address
+    NetDeviceContainer m_backhaulDevices;   //!< PGW and remote host p2p devices
+    NodeContainer m_enbNodes;               //!< eNB nodes
+    NodeContainer m_ueNodes;                //!< UE nodes
+    NetDeviceContainer m_enbDevices;        //!< eNB LTE devices
+    NetDeviceContainer m_ueDevices;         //!< UE LTE devices
+    Ipv4InterfaceContainer m_ueInterfaces;  //!< UE IP interfaces
+};
+
+} // namespace ns3
+
+#endif /* LTE_EPC_TOPOLOGY_H */
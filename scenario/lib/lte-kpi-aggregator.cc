@@ -0,0 +1,451 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lte-kpi-aggregator.h"
+
+#include "ns3/log.h"
+#include "ns3/lte-amc.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LteKpiAggregator");
+
+namespace
+{
+
+/// Largest PRB count of the TBS tables
+const uint32_t MAX_PRBS = 110;
+
+/// Largest MCS index of the TBS tables
+const uint32_t MAX_MCS = 28;
+
+#pragma pack(push, 1)
+
+/// A row of LteUeKpis or LteCellKpis
+struct KpiRecord
+{
+    double start;     //!< window start [s]
+    double end;       //!< window end [s]
+    uint64_t imsi;    //!< IMSI, UE rows
+    double dlMcs[4];  //!< DL MCS mean, 10th, 50th and 90th percentile
+    double ulMcs[4];  //!< UL MCS mean, 10th, 50th and 90th percentile
+    double dlPrbUtil; //!< DL PRB utilisation
+    double ulPrbUtil; //!< UL PRB utilisation
+    double dlSinr[3]; //!< DL SINR 10th, 50th and 90th percentile [dB]
+    double ulSinr[3]; //!< UL SINR 10th, 50th and 90th percentile [dB]
+    double dlRlcKbps; //!< DL RLC throughput [kb/s]
+    double ulRlcKbps; //!< UL RLC throughput [kb/s]
+    uint32_t dlTbs;   //!< DL transport blocks
+    uint32_t ulTbs;   //!< UL transport blocks
+    uint32_t ues;     //!< active UEs, cell rows
+    uint16_t cellId;  //!< cell
+    uint16_t rnti;    //!< RNTI, UE rows
+};
+
+#pragma pack(pop)
+
+/**
+ * Append the KPI columns shared by UE and cell rows.
+ *
+ * \param r the row
+ * \param line the output
+ */
+void
+AppendKpis(const KpiRecord& r, std::string& line)
+{
+    char buffer[512];
+    int n = std::snprintf(buffer,
+                          sizeof(buffer),
+                          "\t%u\t%.2f\t%g\t%g\t%g\t%.4f\t%u\t%.2f\t%g\t%g\t%g\t%.4f"
+                          "\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.3f\t%.3f\n",
+                          r.dlTbs,
+                          r.dlMcs[0],
+                          r.dlMcs[1],
+                          r.dlMcs[2],
+                          r.dlMcs[3],
+                          r.dlPrbUtil,
+                          r.ulTbs,
+                          r.ulMcs[0],
+                          r.ulMcs[1],
+                          r.ulMcs[2],
+                          r.ulMcs[3],
+                          r.ulPrbUtil,
+                          r.dlSinr[0],
+                          r.dlSinr[1],
+                          r.dlSinr[2],
+                          r.ulSinr[0],
+                          r.ulSinr[1],
+                          r.ulSinr[2],
+                          r.dlRlcKbps,
+                          r.ulRlcKbps);
+    line.append(buffer, std::min<std::size_t>(n, sizeof(buffer) - 1));
+}
+
+/// LteUeKpis line formatter
+void
+FormatUe(const uint8_t* data, std::string& line)
+{
+    KpiRecord r;
+    std::memcpy(&r, data, sizeof(r));
+    char buffer[128];
+    int n = std::snprintf(buffer,
+                          sizeof(buffer),
+                          "%g\t%g\t%" PRIu64 "\t%u\t%u",
+                          r.start,
+                          r.end,
+                          r.imsi,
+                          r.cellId,
+                          r.rnti);
+    line.append(buffer, std::min<std::size_t>(n, sizeof(buffer) - 1));
+    AppendKpis(r, line);
+}
+
+/// LteCellKpis line formatter
+void
+FormatCell(const uint8_t* data, std::string& line)
+{
+    KpiRecord r;
+    std::memcpy(&r, data, sizeof(r));
+    char buffer[128];
+    int n = std::snprintf(buffer,
+                          sizeof(buffer),
+                          "%g\t%g\t%u\t%u",
+                          r.start,
+                          r.end,
+                          r.cellId,
+                          r.ues);
+    line.append(buffer, std::min<std::size_t>(n, sizeof(buffer) - 1));
+    AppendKpis(r, line);
+}
+
+const char* KPI_HEADER = "\tdlTbs\tdlMcs\tdlMcsP10\tdlMcsP50\tdlMcsP90\tdlPrbUtil"
+                         "\tulTbs\tulMcs\tulMcsP10\tulMcsP50\tulMcsP90\tulPrbUtil"
+                         "\tdlSinrP10\tdlSinrP50\tdlSinrP90\tulSinrP10\tulSinrP50\tulSinrP90"
+                         "\tdlRlcKbps\tulRlcKbps\n";
+
+/**
+ * \param histogram a histogram
+ * \param p the percentile, in (0, 1)
+ * \return the index of the bin holding the percentile, -1 if empty
+ */
+template <typename H>
+int
+Percentile(const H& histogram, double p)
+{
+    uint64_t total = 0;
+    for (uint32_t count : histogram)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return -1;
+    }
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(p * total));
+    uint64_t seen = 0;
+    for (uint32_t bin = 0; bin < histogram.size(); bin++)
+    {
+        seen += histogram[bin];
+        if (seen >= rank)
+        {
+            return bin;
+        }
+    }
+    return histogram.size() - 1;
+}
+
+/**
+ * \param histogram an MCS histogram
+ * \param out mean, 10th, 50th and 90th percentile, nan if empty
+ */
+template <typename H>
+void
+McsSummary(const H& histogram, double out[4])
+{
+    uint64_t total = 0;
+    double sum = 0;
+    for (uint32_t mcs = 0; mcs < histogram.size(); mcs++)
+    {
+        total += histogram[mcs];
+        sum += double(mcs) * histogram[mcs];
+    }
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    out[0] = total > 0 ? sum / total : nan;
+    const double ps[] = {0.1, 0.5, 0.9};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        int bin = Percentile(histogram, ps[i]);
+        out[i + 1] = bin < 0 ? nan : bin;
+    }
+}
+
+/**
+ * \param histogram a SINR histogram
+ * \param out 10th, 50th and 90th percentile [dB], bin centres, nan if empty
+ */
+template <typename H>
+void
+SinrSummary(const H& histogram, double out[3])
+{
+    const double ps[] = {0.1, 0.5, 0.9};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        int bin = Percentile(histogram, ps[i]);
+        out[i] = bin < 0 ? std::numeric_limits<double>::quiet_NaN() : -20.0 + 0.5 * bin + 0.25;
+    }
+}
+
+} // namespace
+
+LteKpiAggregator::LteKpiAggregator()
+    : m_writer(nullptr),
+      m_ueStream(0),
+      m_cellStream(0)
+{
+    // TB size for every MCS and PRB count, to recover the PRBs of a TB
+    Ptr<LteAmc> amc = CreateObject<LteAmc>();
+    m_dlTbs.resize(MAX_MCS + 1);
+    m_ulTbs.resize(MAX_MCS + 1);
+    for (uint32_t mcs = 0; mcs <= MAX_MCS; mcs++)
+    {
+        for (uint32_t prbs = 1; prbs <= MAX_PRBS; prbs++)
+        {
+            m_dlTbs[mcs].push_back(amc->GetDlTbSizeFromMcs(mcs, prbs) / 8);
+            m_ulTbs[mcs].push_back(amc->GetUlTbSizeFromMcs(mcs, prbs) / 8);
+        }
+    }
+}
+
+void
+LteKpiAggregator::Open(AsyncTraceWriter& writer, const std::string& prefix)
+{
+    m_writer = &writer;
+    m_ueStream = writer.Open(prefix + "LteUeKpis.txt",
+                             sizeof(KpiRecord),
+                             std::string("% start\tend\tIMSI\tcellId\tRNTI") + KPI_HEADER,
+                             &FormatUe);
+    m_cellStream = writer.Open(prefix + "LteCellKpis.txt",
+                               sizeof(KpiRecord),
+                               std::string("% start\tend\tcellId\tues") + KPI_HEADER,
+                               &FormatCell);
+}
+
+void
+LteKpiAggregator::AddCell(uint16_t cellId, uint16_t dlBandwidth, uint16_t ulBandwidth)
+{
+    m_cellInfo[cellId] = {dlBandwidth, ulBandwidth};
+}
+
+uint32_t
+LteKpiAggregator::GetPrbs(const std::vector<uint32_t>& sizes, uint16_t bytes)
+{
+    auto it = std::lower_bound(sizes.begin(), sizes.end(), bytes);
+    return it == sizes.end() ? sizes.size() : it - sizes.begin() + 1;
+}
+
+uint32_t
+LteKpiAggregator::GetSinrBin(double sinr)
+{
+    double db = 10 * std::log10(std::max(sinr, 1e-30));
+    int bin = std::floor((db + 20.0) * 2);
+    return std::clamp(bin, 0, int(std::tuple_size<SinrHistogram>::value) - 1);
+}
+
+void
+LteKpiAggregator::AddDlScheduling(uint16_t cellId,
+                                  uint64_t imsi,
+                                  uint16_t rnti,
+                                  uint8_t mcs1,
+                                  uint16_t size1,
+                                  uint8_t mcs2,
+                                  uint16_t size2)
+{
+    // Both transport blocks of a MIMO allocation use the same PRBs
+    uint32_t prbs = GetPrbs(m_dlTbs[std::min<uint32_t>(mcs1, MAX_MCS)], size1);
+    Kpis& cell = m_cells[cellId];
+    cell.active = true;
+    cell.dlTbs++;
+    cell.dlMcs[mcs1 & 31]++;
+    cell.dlPrbs += prbs;
+    if (size2 > 0)
+    {
+        cell.dlTbs++;
+        cell.dlMcs[mcs2 & 31]++;
+    }
+    if (imsi == 0)
+    {
+        return;
+    }
+    Kpis& ue = m_ues[imsi];
+    ue.active = true;
+    ue.cellId = cellId;
+    ue.rnti = rnti;
+    ue.dlTbs++;
+    ue.dlMcs[mcs1 & 31]++;
+    ue.dlPrbs += prbs;
+    if (size2 > 0)
+    {
+        ue.dlTbs++;
+        ue.dlMcs[mcs2 & 31]++;
+    }
+}
+
+void
+LteKpiAggregator::AddUlScheduling(uint16_t cellId,
+                                  uint64_t imsi,
+                                  uint16_t rnti,
+                                  uint8_t mcs,
+                                  uint16_t size)
+{
+    uint32_t prbs = GetPrbs(m_ulTbs[std::min<uint32_t>(mcs, MAX_MCS)], size);
+    Kpis& cell = m_cells[cellId];
+    cell.active = true;
+    cell.ulTbs++;
+    cell.ulMcs[mcs & 31]++;
+    cell.ulPrbs += prbs;
+    if (imsi == 0)
+    {
+        return;
+    }
+    Kpis& ue = m_ues[imsi];
+    ue.active = true;
+    ue.cellId = cellId;
+    ue.rnti = rnti;
+    ue.ulTbs++;
+    ue.ulMcs[mcs & 31]++;
+    ue.ulPrbs += prbs;
+}
+
+void
+LteKpiAggregator::AddDlSinr(uint16_t cellId, uint64_t imsi, uint16_t rnti, double sinr)
+{
+    uint32_t bin = GetSinrBin(sinr);
+    Kpis& cell = m_cells[cellId];
+    cell.active = true;
+    cell.dlSinr[bin]++;
+    Kpis& ue = m_ues[imsi];
+    ue.active = true;
+    ue.cellId = cellId;
+    ue.rnti = rnti;
+    ue.dlSinr[bin]++;
+}
+
+void
+LteKpiAggregator::AddUlSinr(uint16_t cellId, uint64_t imsi, uint16_t rnti, double sinr)
+{
+    uint32_t bin = GetSinrBin(sinr);
+    Kpis& cell = m_cells[cellId];
+    cell.active = true;
+    cell.ulSinr[bin]++;
+    if (imsi == 0)
+    {
+        return;
+    }
+    Kpis& ue = m_ues[imsi];
+    ue.active = true;
+    ue.cellId = cellId;
+    ue.rnti = rnti;
+    ue.ulSinr[bin]++;
+}
+
+void
+LteKpiAggregator::AddRlcRx(bool downlink, uint64_t imsi, uint32_t size)
+{
+    Kpis& ue = m_ues[imsi];
+    ue.active = true;
+    (downlink ? ue.dlRlcBytes : ue.ulRlcBytes) += size;
+    // Charged to the cell the UE was last seen in
+    if (ue.cellId != 0)
+    {
+        Kpis& cell = m_cells[ue.cellId];
+        cell.active = true;
+        (downlink ? cell.dlRlcBytes : cell.ulRlcBytes) += size;
+    }
+}
+
+void
+LteKpiAggregator::WriteRow(const Kpis& kpis,
+                           const Cell& cell,
+                           Time start,
+                           Time end,
+                           uint32_t ues,
+                           uint32_t stream,
+                           uint64_t imsi)
+{
+    double seconds = (end - start).GetSeconds();
+    double subframes = (end - start).GetMilliSeconds();
+    KpiRecord r{};
+    r.start = start.GetSeconds();
+    r.end = end.GetSeconds();
+    r.imsi = imsi;
+    r.cellId = kpis.cellId;
+    r.rnti = kpis.rnti;
+    r.ues = ues;
+    r.dlTbs = kpis.dlTbs;
+    r.ulTbs = kpis.ulTbs;
+    McsSummary(kpis.dlMcs, r.dlMcs);
+    McsSummary(kpis.ulMcs, r.ulMcs);
+    r.dlPrbUtil = cell.dlBandwidth > 0 && subframes > 0
+                      ? kpis.dlPrbs / (subframes * cell.dlBandwidth)
+                      : std::numeric_limits<double>::quiet_NaN();
+    r.ulPrbUtil = cell.ulBandwidth > 0 && subframes > 0
+                      ? kpis.ulPrbs / (subframes * cell.ulBandwidth)
+                      : std::numeric_limits<double>::quiet_NaN();
+    SinrSummary(kpis.dlSinr, r.dlSinr);
+    SinrSummary(kpis.ulSinr, r.ulSinr);
+    r.dlRlcKbps = seconds > 0 ? kpis.dlRlcBytes * 8 / seconds / 1000 : 0;
+    r.ulRlcKbps = seconds > 0 ? kpis.ulRlcBytes * 8 / seconds / 1000 : 0;
+    m_writer->Write(stream, r);
+}
+
+void
+LteKpiAggregator::Write(Time start, Time end)
+{
+    NS_LOG_FUNCTION(this << start << end);
+    std::map<uint16_t, uint32_t> ues;
+    for (auto& [imsi, ue] : m_ues)
+    {
+        if (!ue.active)
+        {
+            continue;
+        }
+        ues[ue.cellId]++;
+        WriteRow(ue, m_cellInfo[ue.cellId], start, end, 0, m_ueStream, imsi);
+        // Keep the entry, the UE is likely active in the next window too
+        uint16_t cellId = ue.cellId;
+        ue = Kpis();
+        ue.cellId = cellId;
+    }
+    for (auto& [cellId, cell] : m_cells)
+    {
+        if (!cell.active)
+        {
+            continue;
+        }
+        cell.cellId = cellId;
+        WriteRow(cell, m_cellInfo[cellId], start, end, ues[cellId], m_cellStream, 0);
+        cell = Kpis();
+    }
+}
+
+} // namespace ns3
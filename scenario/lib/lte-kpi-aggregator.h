@@ -0,0 +1,203 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_KPI_AGGREGATOR_H
+#define LTE_KPI_AGGREGATOR_H
+
+#include "async-trace-writer.h"
+
+#include "ns3/nstime.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Per-UE and per-cell LTE KPIs over fixed windows, fed from the MAC, PHY and
+ * RLC trace sinks of LteTraceOutput.
+ *
+ * Every window writes one row per active UE to LteUeKpis.txt and one per
+ * active cell to LteCellKpis.txt:
+ * - DL and UL transport blocks with mean, 10th, 50th and 90th percentile MCS
+ * - DL and UL PRB utilisation; the traces carry no PRB count, so it is looked
+ *   up from MCS and TB size in the TBS tables of LteAmc
+ * - DL (UE PHY) and UL (eNB PHY) SINR percentiles in dB, 0.5 dB resolution
+ * - DL and UL RLC throughput of the data radio bearers
+ *
+ * Samples only go into fixed-size histograms, so memory does not grow with
+ * the window length. Percentiles of empty distributions are written as nan.
+ */
+class LteKpiAggregator
+{
+  public:
+    LteKpiAggregator();
+
+    /**
+     * Open LteUeKpis.txt and LteCellKpis.txt.
+     *
+     * \param writer the writer of the files
+     * \param prefix the file name prefix
+     */
+    void Open(AsyncTraceWriter& writer, const std::string& prefix);
+
+    /**
+     * \param cellId a cell
+     * \param dlBandwidth its downlink bandwidth [PRB]
+     * \param ulBandwidth its uplink bandwidth [PRB]
+     */
+    void AddCell(uint16_t cellId, uint16_t dlBandwidth, uint16_t ulBandwidth);
+
+    /**
+     * Account a downlink scheduling decision.
+     *
+     * \param cellId the cell
+     * \param imsi the UE's IMSI
+     * \param rnti the UE's RNTI
+     * \param mcs1 MCS of the first transport block
+     * \param size1 size of the first transport block [B]
+     * \param mcs2 MCS of the second transport block
+     * \param size2 size of the second transport block [B], 0 for none
+     */
+    void AddDlScheduling(uint16_t cellId,
+                         uint64_t imsi,
+                         uint16_t rnti,
+                         uint8_t mcs1,
+                         uint16_t size1,
+                         uint8_t mcs2,
+                         uint16_t size2);
+
+    /**
+     * Account an uplink scheduling decision.
+     *
+     * \param cellId the cell
+     * \param imsi the UE's IMSI
+     * \param rnti the UE's RNTI
+     * \param mcs the MCS
+     * \param size the transport block size [B]
+     */
+    void AddUlScheduling(uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t mcs, uint16_t size);
+
+    /**
+     * \param cellId the serving cell
+     * \param imsi the UE's IMSI
+     * \param rnti the UE's RNTI
+     * \param sinr downlink SINR measured by the UE, linear
+     */
+    void AddDlSinr(uint16_t cellId, uint64_t imsi, uint16_t rnti, double sinr);
+
+    /**
+     * \param cellId the cell
+     * \param imsi the UE's IMSI
+     * \param rnti the UE's RNTI
+     * \param sinr uplink SINR measured by the eNB, linear
+     */
+    void AddUlSinr(uint16_t cellId, uint64_t imsi, uint16_t rnti, double sinr);
+
+    /**
+     * \param downlink whether the PDU was received by the UE
+     * \param imsi the UE's IMSI
+     * \param size the PDU size [B]
+     */
+    void AddRlcRx(bool downlink, uint64_t imsi, uint32_t size);
+
+    /**
+     * Write the rows of the window and reset the counters.
+     *
+     * \param start start of the window
+     * \param end end of the window
+     */
+    void Write(Time start, Time end);
+
+  private:
+    /// MCS histogram, one bin per MCS index
+    typedef std::array<uint32_t, 32> McsHistogram;
+
+    /// SINR histogram, 0.5 dB bins from -20 dB to 60 dB
+    typedef std::array<uint32_t, 160> SinrHistogram;
+
+    /// KPI counters of a UE or a cell in the current window
+    struct Kpis
+    {
+        uint16_t cellId{0};     //!< (serving) cell
+        uint16_t rnti{0};       //!< last RNTI, UEs only
+        uint32_t dlTbs{0};      //!< downlink transport blocks
+        uint32_t ulTbs{0};      //!< uplink transport blocks
+        uint64_t dlPrbs{0};     //!< downlink PRBs allocated
+        uint64_t ulPrbs{0};     //!< uplink PRBs allocated
+        uint64_t dlRlcBytes{0}; //!< downlink RLC bytes received
+        uint64_t ulRlcBytes{0}; //!< uplink RLC bytes received
+        McsHistogram dlMcs{};   //!< downlink MCS
+        McsHistogram ulMcs{};   //!< uplink MCS
+        SinrHistogram dlSinr{}; //!< downlink SINR
+        SinrHistogram ulSinr{}; //!< uplink SINR
+        bool active{false};     //!< anything accounted in the window
+    };
+
+    /// Bandwidth of a cell
+    struct Cell
+    {
+        uint16_t dlBandwidth; //!< downlink bandwidth [PRB]
+        uint16_t ulBandwidth; //!< uplink bandwidth [PRB]
+    };
+
+    /**
+     * \param sizes TB sizes of an MCS per PRB count [B]
+     * \param bytes a TB size [B]
+     * \return the fewest PRBs carrying a TB of that size at that MCS
+     */
+    static uint32_t GetPrbs(const std::vector<uint32_t>& sizes, uint16_t bytes);
+
+    /**
+     * \param sinr a linear SINR
+     * \return its histogram bin
+     */
+    static uint32_t GetSinrBin(double sinr);
+
+    /**
+     * \param kpis the counters of a UE or a cell
+     * \param cell its cell
+     * \param start start of the window
+     * \param end end of the window
+     * \param ues active UEs of a cell, 0 for a UE row
+     * \param stream the output stream
+     * \param imsi the UE's IMSI, 0 for a cell row
+     */
+    void WriteRow(const Kpis& kpis,
+                  const Cell& cell,
+                  Time start,
+                  Time end,
+                  uint32_t ues,
+                  uint32_t stream,
+                  uint64_t imsi);
+
+    AsyncTraceWriter* m_writer;                 //!< the writer
+    uint32_t m_ueStream;                        //!< LteUeKpis stream
+    uint32_t m_cellStream;                      //!< LteCellKpis stream
+    std::vector<std::vector<uint32_t>> m_dlTbs; //!< DL TB size per MCS and PRBs [B]
+    std::vector<std::vector<uint32_t>> m_ulTbs; //!< UL TB size per MCS and PRBs [B]
+    std::map<uint16_t, Cell> m_cellInfo;        //!< bandwidth per cell
+    std::unordered_map<uint64_t, Kpis> m_ues;   //!< counters per IMSI
+    std::map<uint16_t, Kpis> m_cells;           //!< counters per cell
+};
+
+} // namespace ns3
+
+#endif /* LTE_KPI_AGGREGATOR_H */
@@ -0,0 +1,795 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lte-trace-output.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/component-carrier-enb.h"
+#include "ns3/component-carrier-ue.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-enb-phy.h"
+#include "ns3/lte-enb-rrc.h"
+#include "ns3/lte-pdcp.h"
+#include "ns3/lte-radio-bearer-info.h"
+#include "ns3/lte-rlc.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-phy.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/node-list.h"
+#include "ns3/object-map.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LteTraceOutput");
+
+namespace
+{
+
+// Records as copied by the trace sinks and written by the "binary" mode:
+// packed, native byte order, fields in the order of the text columns where
+// the alignment allows
+
+#pragma pack(push, 1)
+
+/// DlMacStats record
+struct DlMacRecord
+{
+    double time;      //!< simulation time [s]
+    uint64_t imsi;    //!< IMSI
+    uint32_t frame;   //!< frame number
+    uint32_t sframe;  //!< subframe number
+    uint16_t cellId;  //!< cell
+    uint16_t rnti;    //!< RNTI
+    uint16_t sizeTb1; //!< size of the first transport block [B]
+    uint16_t sizeTb2; //!< size of the second transport block [B]
+    uint8_t mcsTb1;   //!< MCS of the first transport block
+    uint8_t mcsTb2;   //!< MCS of the second transport block
+    uint8_t ccId;     //!< component carrier
+};
+
+/// UlMacStats record
+struct UlMacRecord
+{
+    double time;     //!< simulation time [s]
+    uint64_t imsi;   //!< IMSI
+    uint32_t frame;  //!< frame number
+    uint32_t sframe; //!< subframe number
+    uint16_t cellId; //!< cell
+    uint16_t rnti;   //!< RNTI
+    uint16_t size;   //!< transport block size [B]
+    uint8_t mcs;     //!< MCS
+    uint8_t ccId;    //!< component carrier
+};
+
+/// DlRsrpSinrStats record
+struct DlSinrRecord
+{
+    double time;     //!< simulation time [s]
+    uint64_t imsi;   //!< IMSI
+    double rsrp;     //!< RSRP [W]
+    double sinr;     //!< SINR, linear
+    uint16_t cellId; //!< cell
+    uint16_t rnti;   //!< RNTI
+    uint8_t ccId;    //!< component carrier
+};
+
+/// UlSinrStats record
+struct UlSinrRecord
+{
+    double time;     //!< simulation time [s]
+    uint64_t imsi;   //!< IMSI
+    double sinr;     //!< SINR, linear
+    uint16_t cellId; //!< cell
+    uint16_t rnti;   //!< RNTI
+    uint8_t ccId;    //!< component carrier
+};
+
+/// RLC/PDCP record of one bearer direction and epoch
+struct BearerRecord
+{
+    double start;     //!< epoch start [s]
+    double end;       //!< epoch end [s]
+    uint64_t imsi;    //!< IMSI
+    uint64_t txBytes; //!< transmitted bytes
+    uint64_t rxBytes; //!< received bytes
+    double delay;     //!< mean delay [s]
+    double delayStd;  //!< delay standard deviation [s]
+    double delayMin;  //!< minimum delay [s]
+    double delayMax;  //!< maximum delay [s]
+    double size;      //!< mean received PDU size [B]
+    double sizeStd;   //!< received PDU size standard deviation [B]
+    uint32_t txPdus;  //!< transmitted PDUs
+    uint32_t rxPdus;  //!< received PDUs
+    uint32_t sizeMin; //!< minimum received PDU size [B]
+    uint32_t sizeMax; //!< maximum received PDU size [B]
+    uint16_t cellId;  //!< cell
+    uint16_t rnti;    //!< RNTI
+    uint8_t lcid;     //!< logical channel
+};
+
+#pragma pack(pop)
+
+/**
+ * Append a formatted line.
+ *
+ * \param line the output
+ * \param format printf format
+ */
+void
+AppendLine(std::string& line, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void
+AppendLine(std::string& line, const char* format, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int n = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    line.append(buffer, std::min<std::size_t>(n, sizeof(buffer) - 1));
+}
+
+/**
+ * \param data a record
+ * \return the record, copied out of the unaligned buffer
+ */
+template <typename T>
+T
+Read(const uint8_t* data)
+{
+    T record;
+    std::memcpy(&record, data, sizeof(T));
+    return record;
+}
+
+/// DlMacStats line formatter
+void
+FormatDlMac(const uint8_t* data, std::string& line)
+{
+    auto r = Read<DlMacRecord>(data);
+    AppendLine(line,
+               "%.6f\t%u\t%" PRIu64 "\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t%u\n",
+               r.time,
+               r.cellId,
+               r.imsi,
+               r.frame,
+               r.sframe,
+               r.rnti,
+               r.mcsTb1,
+               r.sizeTb1,
+               r.mcsTb2,
+               r.sizeTb2,
+               r.ccId);
+}
+
+/// UlMacStats line formatter
+void
+FormatUlMac(const uint8_t* data, std::string& line)
+{
+    auto r = Read<UlMacRecord>(data);
+    AppendLine(line,
+               "%.6f\t%u\t%" PRIu64 "\t%u\t%u\t%u\t%u\t%u\t%u\n",
+               r.time,
+               r.cellId,
+               r.imsi,
+               r.frame,
+               r.sframe,
+               r.rnti,
+               r.mcs,
+               r.size,
+               r.ccId);
+}
+
+/// DlRsrpSinrStats line formatter
+void
+FormatDlSinr(const uint8_t* data, std::string& line)
+{
+    auto r = Read<DlSinrRecord>(data);
+    AppendLine(line,
+               "%.6f\t%u\t%" PRIu64 "\t%u\t%g\t%g\t%u\n",
+               r.time,
+               r.cellId,
+               r.imsi,
+               r.rnti,
+               r.rsrp,
+               r.sinr,
+               r.ccId);
+}
+
+/// UlSinrStats line formatter
+void
+FormatUlSinr(const uint8_t* data, std::string& line)
+{
+    auto r = Read<UlSinrRecord>(data);
+    AppendLine(line,
+               "%.6f\t%u\t%" PRIu64 "\t%u\t%g\t%u\n",
+               r.time,
+               r.cellId,
+               r.imsi,
+               r.rnti,
+               r.sinr,
+               r.ccId);
+}
+
+/// RLC/PDCP statistics line formatter
+void
+FormatBearer(const uint8_t* data, std::string& line)
+{
+    auto r = Read<BearerRecord>(data);
+    AppendLine(line,
+               "%g\t%g\t%u\t%" PRIu64 "\t%u\t%u\t%u\t%" PRIu64 "\t%u\t%" PRIu64
+               "\t%g\t%g\t%g\t%g\t%g\t%g\t%u\t%u\n",
+               r.start,
+               r.end,
+               r.cellId,
+               r.imsi,
+               r.rnti,
+               r.lcid,
+               r.txPdus,
+               r.txBytes,
+               r.rxPdus,
+               r.rxBytes,
+               r.delay,
+               r.delayStd,
+               r.delayMin,
+               r.delayMax,
+               r.size,
+               r.sizeStd,
+               r.sizeMin,
+               r.sizeMax);
+}
+
+/**
+ * \param sum sum of the samples
+ * \param sq sum of the squared samples
+ * \param n number of samples
+ * \return the population standard deviation, 0 below two samples
+ */
+double
+Stddev(double sum, double sq, uint32_t n)
+{
+    if (n < 2)
+    {
+        return 0;
+    }
+    double mean = sum / n;
+    return std::sqrt(std::max(0.0, sq / n - mean * mean));
+}
+
+const char* BEARER_HEADER = "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\t"
+                            "RxBytes\tdelay\tstdDev\tmin\tmax\tPduSize\tstdDev\tmin\tmax\n";
+const char* BEARER_LAYOUT = "start:f64 end:f64 imsi:u64 txBytes:u64 rxBytes:u64 delay:f64 "
+                            "delayStd:f64 delayMin:f64 delayMax:f64 size:f64 sizeStd:f64 "
+                            "txPdus:u32 rxPdus:u32 sizeMin:u32 sizeMax:u32 cellId:u16 rnti:u16 "
+                            "lcid:u8";
+
+} // namespace
+
+LteTraceOutput::Mode
+LteTraceOutput::ParseMode(const std::string& name)
+{
+    if (name == "off")
+    {
+        return OFF;
+    }
+    if (name == "ns3")
+    {
+        return NS3;
+    }
+    if (name == "async")
+    {
+        return ASYNC;
+    }
+    if (name == "binary")
+    {
+        return BINARY;
+    }
+    if (name == "kpi")
+    {
+        return KPI;
+    }
+    NS_FATAL_ERROR("Unknown LTE trace mode " << name << ", use off, ns3, async, binary or kpi");
+}
+
+LteTraceOutput::LteTraceOutput()
+    : m_mode("ns3"),
+      m_prefix(""),
+      m_bufferKb(1024),
+      m_kpiWindow(1.0),
+      m_epoch(0.25),
+      m_dlMac(0),
+      m_ulMac(0),
+      m_dlSinr(0),
+      m_ulSinr(0)
+{
+}
+
+LteTraceOutput::~LteTraceOutput()
+{
+    Close();
+}
+
+void
+LteTraceOutput::AddCommandLineValues(CommandLine& cmd)
+{
+    cmd.AddValue("lteTraces", "LTE statistics traces: off, ns3, async, binary or kpi", m_mode);
+    cmd.AddValue("lteTraceBuffer",
+                 "Records buffered per LTE trace file before the writer gets them [KiB]",
+                 m_bufferKb);
+    cmd.AddValue("lteTraceEpoch", "RLC/PDCP statistics period of the async modes [s]", m_epoch);
+    cmd.AddValue("lteKpiWindow", "Aggregation window of the kpi mode [s]", m_kpiWindow);
+}
+
+void
+LteTraceOutput::SetMode(Mode mode)
+{
+    static const char* names[] = {"off", "ns3", "async", "binary", "kpi"};
+    m_mode = names[mode];
+}
+
+void
+LteTraceOutput::SetPrefix(const std::string& prefix)
+{
+    m_prefix = prefix;
+}
+
+void
+LteTraceOutput::SetEpoch(Time epoch)
+{
+    m_epoch = epoch.GetSeconds();
+}
+
+void
+LteTraceOutput::SetKpiWindow(Time window)
+{
+    m_kpiWindow = window.GetSeconds();
+}
+
+LteTraceOutput::Mode
+LteTraceOutput::GetMode() const
+{
+    return ParseMode(m_mode);
+}
+
+uint32_t
+LteTraceOutput::Open(const std::string& name,
+                     std::size_t recordSize,
+                     const std::string& header,
+                     const std::string& layout,
+                     AsyncTraceWriter::Formatter formatter)
+{
+    if (GetMode() == BINARY)
+    {
+        return m_writer->Open(m_prefix + name + ".bin",
+                              recordSize,
+                              "# " + name + ": " + std::to_string(recordSize) +
+                                  "-byte packed records, native byte order: " + layout + "\n",
+                              nullptr);
+    }
+    return m_writer->Open(m_prefix + name + ".txt", recordSize, header, formatter);
+}
+
+void
+LteTraceOutput::Start(Ptr<LteHelper> lteHelper)
+{
+    NS_LOG_FUNCTION(this << m_mode);
+    Mode mode = GetMode();
+    if (mode == OFF)
+    {
+        return;
+    }
+    if (mode == NS3)
+    {
+        lteHelper->EnableTraces();
+        return;
+    }
+    NS_ABORT_MSG_IF(m_writer, "LTE traces started twice");
+    NS_ABORT_MSG_IF(m_epoch <= 0, "The RLC/PDCP epoch must be positive");
+    NS_ABORT_MSG_IF(m_kpiWindow <= 0, "The KPI window must be positive");
+
+    m_writer = std::make_unique<AsyncTraceWriter>();
+    m_writer->SetBufferSize(std::size_t(m_bufferKb) * 1024);
+    if (mode == KPI)
+    {
+        m_kpis = std::make_unique<LteKpiAggregator>();
+        m_kpis->Open(*m_writer, m_prefix);
+        ConnectDevices();
+        m_epochStart = Simulator::Now();
+        m_epochEvent = Simulator::Schedule(GetPeriod(), &LteTraceOutput::EndEpoch, this);
+        return;
+    }
+    m_dlMac = Open("DlMacStats",
+                   sizeof(DlMacRecord),
+                   "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcsTb1\tsizeTb1\tmcsTb2\tsizeTb2\t"
+                   "ccId\n",
+                   "time:f64 imsi:u64 frame:u32 sframe:u32 cellId:u16 rnti:u16 sizeTb1:u16 "
+                   "sizeTb2:u16 mcsTb1:u8 mcsTb2:u8 ccId:u8",
+                   &FormatDlMac);
+    m_ulMac = Open("UlMacStats",
+                   sizeof(UlMacRecord),
+                   "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcs\tsize\tccId\n",
+                   "time:f64 imsi:u64 frame:u32 sframe:u32 cellId:u16 rnti:u16 size:u16 "
+                   "mcs:u8 ccId:u8",
+                   &FormatUlMac);
+    m_dlSinr = Open("DlRsrpSinrStats",
+                    sizeof(DlSinrRecord),
+                    "% time\tcellId\tIMSI\tRNTI\trsrp\tsinr\tComponentCarrierId\n",
+                    "time:f64 imsi:u64 rsrp:f64 sinr:f64 cellId:u16 rnti:u16 ccId:u8",
+                    &FormatDlSinr);
+    m_ulSinr = Open("UlSinrStats",
+                    sizeof(UlSinrRecord),
+                    "% time\tcellId\tIMSI\tRNTI\tsinrLinear\tcomponentCarrierId\n",
+                    "time:f64 imsi:u64 sinr:f64 cellId:u16 rnti:u16 ccId:u8",
+                    &FormatUlSinr);
+    const char* tables[TABLES] = {"DlRlcStats", "UlRlcStats", "DlPdcpStats", "UlPdcpStats"};
+    for (uint32_t t = 0; t < TABLES; t++)
+    {
+        m_tables[t].stream =
+            Open(tables[t], sizeof(BearerRecord), BEARER_HEADER, BEARER_LAYOUT, &FormatBearer);
+    }
+
+    ConnectDevices();
+    m_epochStart = Simulator::Now();
+    m_epochEvent = Simulator::Schedule(GetPeriod(), &LteTraceOutput::EndEpoch, this);
+}
+
+void
+LteTraceOutput::ConnectDevices()
+{
+    for (auto node = NodeList::Begin(); node != NodeList::End(); node++)
+    {
+        for (uint32_t d = 0; d < (*node)->GetNDevices(); d++)
+        {
+            Ptr<NetDevice> netDevice = (*node)->GetDevice(d);
+            if (Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(netDevice))
+            {
+                for (const auto& [ccId, carrier] : enb->GetCcMap())
+                {
+                    Ptr<ComponentCarrierEnb> cc = DynamicCast<ComponentCarrierEnb>(carrier);
+                    if (m_kpis)
+                    {
+                        m_kpis->AddCell(cc->GetCellId(),
+                                        cc->GetDlBandwidth(),
+                                        cc->GetUlBandwidth());
+                    }
+                    auto device = std::make_unique<Device>(
+                        Device{this, enb->GetRrc(), nullptr, 0, cc->GetCellId()});
+                    cc->GetMac()->TraceConnectWithoutContext(
+                        "DlScheduling",
+                        MakeBoundCallback(&LteTraceOutput::DlScheduling, device.get()));
+                    cc->GetMac()->TraceConnectWithoutContext(
+                        "UlScheduling",
+                        MakeBoundCallback(&LteTraceOutput::UlScheduling, device.get()));
+                    cc->GetPhy()->TraceConnectWithoutContext(
+                        "ReportUeSinr",
+                        MakeBoundCallback(&LteTraceOutput::UeSinr, device.get()));
+                    m_devices.push_back(std::move(device));
+                }
+                // Bearers are set up per UE, connect them once they exist
+                auto device = std::make_unique<Device>(
+                    Device{this, enb->GetRrc(), nullptr, 0, enb->GetCellId()});
+                enb->GetRrc()->TraceConnectWithoutContext(
+                    "ConnectionReconfiguration",
+                    MakeBoundCallback(&LteTraceOutput::EnbReconfiguration, device.get()));
+                m_devices.push_back(std::move(device));
+            }
+            else if (Ptr<LteUeNetDevice> ue = DynamicCast<LteUeNetDevice>(netDevice))
+            {
+                auto device = std::make_unique<Device>(
+                    Device{this, nullptr, ue->GetRrc(), ue->GetImsi(), 0});
+                for (const auto& [ccId, cc] : ue->GetCcMap())
+                {
+                    cc->GetPhy()->TraceConnectWithoutContext(
+                        "ReportCurrentCellRsrpSinr",
+                        MakeBoundCallback(&LteTraceOutput::RsrpSinr, device.get()));
+                }
+                ue->GetRrc()->TraceConnectWithoutContext(
+                    "ConnectionReconfiguration",
+                    MakeBoundCallback(&LteTraceOutput::UeReconfiguration, device.get()));
+                m_devices.push_back(std::move(device));
+            }
+        }
+    }
+}
+
+void
+LteTraceOutput::ConnectBearers(Ptr<Object> rrc, bool downlink, uint64_t imsi, uint16_t cellId)
+{
+    ObjectMapValue drbs;
+    rrc->GetAttribute("DataRadioBearerMap", drbs);
+    for (auto it = drbs.Begin(); it != drbs.End(); it++)
+    {
+        Ptr<LteRadioBearerInfo> drb = DynamicCast<LteRadioBearerInfo>(it->second);
+        Ptr<Object> entities[] = {drb->m_rlc, drb->m_pdcp};
+        for (uint32_t e = 0; e < 2; e++)
+        {
+            // Reconfigurations repeat for every new bearer and after handovers
+            bool isPdcp = entities[e] == drb->m_pdcp;
+            // The KPIs only need the RLC throughput
+            if (!entities[e] || (isPdcp && m_kpis) || !m_connected.insert(entities[e]).second)
+            {
+                continue;
+            }
+            BearerTable* dl = &m_tables[isPdcp ? DL_PDCP : DL_RLC];
+            BearerTable* ul = &m_tables[isPdcp ? UL_PDCP : UL_RLC];
+            auto bearer = std::make_unique<Bearer>(
+                Bearer{this, downlink ? dl : ul, downlink ? ul : dl, imsi, cellId});
+            entities[e]->TraceConnectWithoutContext(
+                "TxPDU",
+                MakeBoundCallback(&LteTraceOutput::PduTx, bearer.get()));
+            entities[e]->TraceConnectWithoutContext(
+                "RxPDU",
+                MakeBoundCallback(&LteTraceOutput::PduRx, bearer.get()));
+            m_bearers.push_back(std::move(bearer));
+        }
+    }
+}
+
+void
+LteTraceOutput::WriteEpoch()
+{
+    if (m_kpis)
+    {
+        m_kpis->Write(m_epochStart, Simulator::Now());
+        m_epochStart = Simulator::Now();
+        return;
+    }
+    double start = m_epochStart.GetSeconds();
+    double end = Simulator::Now().GetSeconds();
+    for (auto& table : m_tables)
+    {
+        for (const auto& [key, c] : table.bearers)
+        {
+            BearerRecord r{};
+            r.start = start;
+            r.end = end;
+            r.imsi = key.first;
+            r.lcid = key.second;
+            r.cellId = c.cellId;
+            r.rnti = c.rnti;
+            r.txPdus = c.txPdus;
+            r.txBytes = c.txBytes;
+            r.rxPdus = c.rxPdus;
+            r.rxBytes = c.rxBytes;
+            if (c.rxPdus > 0)
+            {
+                r.delay = c.delaySum / c.rxPdus;
+                r.delayStd = Stddev(c.delaySum, c.delaySq, c.rxPdus);
+                r.delayMin = c.delayMin;
+                r.delayMax = c.delayMax;
+                r.size = double(c.rxBytes) / c.rxPdus;
+                r.sizeStd = Stddev(c.rxBytes, c.sizeSq, c.rxPdus);
+                r.sizeMin = c.sizeMin;
+                r.sizeMax = c.sizeMax;
+            }
+            m_writer->Write(table.stream, r);
+        }
+        table.bearers.clear();
+    }
+    m_epochStart = Simulator::Now();
+}
+
+Time
+LteTraceOutput::GetPeriod() const
+{
+    return Seconds(m_kpis ? m_kpiWindow : m_epoch);
+}
+
+void
+LteTraceOutput::EndEpoch()
+{
+    WriteEpoch();
+    m_epochEvent = Simulator::Schedule(GetPeriod(), &LteTraceOutput::EndEpoch, this);
+}
+
+void
+LteTraceOutput::Close()
+{
+    if (!m_writer)
+    {
+        return;
+    }
+    m_epochEvent.Cancel();
+    if (Simulator::Now() > m_epochStart)
+    {
+        WriteEpoch();
+    }
+    m_writer->Close();
+    NS_LOG_INFO("LTE traces: " << m_writer->GetRecords() << " records, " << m_writer->GetStalls()
+                               << " stalls");
+    m_writer.reset();
+    m_kpis.reset();
+}
+
+uint64_t
+LteTraceOutput::GetImsi(const Device* device, uint16_t rnti)
+{
+    if (!device->enbRrc->HasUeManager(rnti))
+    {
+        return 0;
+    }
+    return device->enbRrc->GetUeManager(rnti)->GetImsi();
+}
+
+void
+LteTraceOutput::DlScheduling(Device* device, DlSchedulingCallbackInfo info)
+{
+    if (LteKpiAggregator* kpis = device->output->m_kpis.get())
+    {
+        kpis->AddDlScheduling(device->cellId,
+                              GetImsi(device, info.rnti),
+                              info.rnti,
+                              info.mcsTb1,
+                              info.sizeTb1,
+                              info.mcsTb2,
+                              info.sizeTb2);
+        return;
+    }
+    DlMacRecord r;
+    r.time = Simulator::Now().GetSeconds();
+    r.imsi = GetImsi(device, info.rnti);
+    r.frame = info.frameNo;
+    r.sframe = info.subframeNo;
+    r.cellId = device->cellId;
+    r.rnti = info.rnti;
+    r.sizeTb1 = info.sizeTb1;
+    r.sizeTb2 = info.sizeTb2;
+    r.mcsTb1 = info.mcsTb1;
+    r.mcsTb2 = info.mcsTb2;
+    r.ccId = info.componentCarrierId;
+    device->output->m_writer->Write(device->output->m_dlMac, r);
+}
+
+void
+LteTraceOutput::UlScheduling(Device* device,
+                             uint32_t frameNo,
+                             uint32_t subframeNo,
+                             uint16_t rnti,
+                             uint8_t mcs,
+                             uint16_t size,
+                             uint8_t ccId)
+{
+    if (LteKpiAggregator* kpis = device->output->m_kpis.get())
+    {
+        kpis->AddUlScheduling(device->cellId, GetImsi(device, rnti), rnti, mcs, size);
+        return;
+    }
+    UlMacRecord r;
+    r.time = Simulator::Now().GetSeconds();
+    r.imsi = GetImsi(device, rnti);
+    r.frame = frameNo;
+    r.sframe = subframeNo;
+    r.cellId = device->cellId;
+    r.rnti = rnti;
+    r.size = size;
+    r.mcs = mcs;
+    r.ccId = ccId;
+    device->output->m_writer->Write(device->output->m_ulMac, r);
+}
+
+void
+LteTraceOutput::RsrpSinr(Device* device,
+                         uint16_t cellId,
+                         uint16_t rnti,
+                         double rsrp,
+                         double sinr,
+                         uint8_t ccId)
+{
+    if (LteKpiAggregator* kpis = device->output->m_kpis.get())
+    {
+        kpis->AddDlSinr(cellId, device->imsi, rnti, sinr);
+        return;
+    }
+    DlSinrRecord r;
+    r.time = Simulator::Now().GetSeconds();
+    r.imsi = device->imsi;
+    r.rsrp = rsrp;
+    r.sinr = sinr;
+    r.cellId = cellId;
+    r.rnti = rnti;
+    r.ccId = ccId;
+    device->output->m_writer->Write(device->output->m_dlSinr, r);
+}
+
+void
+LteTraceOutput::UeSinr(Device* device, uint16_t cellId, uint16_t rnti, double sinr, uint8_t ccId)
+{
+    if (LteKpiAggregator* kpis = device->output->m_kpis.get())
+    {
+        kpis->AddUlSinr(cellId, GetImsi(device, rnti), rnti, sinr);
+        return;
+    }
+    UlSinrRecord r;
+    r.time = Simulator::Now().GetSeconds();
+    r.imsi = GetImsi(device, rnti);
+    r.sinr = sinr;
+    r.cellId = cellId;
+    r.rnti = rnti;
+    r.ccId = ccId;
+    device->output->m_writer->Write(device->output->m_ulSinr, r);
+}
+
+void
+LteTraceOutput::EnbReconfiguration(Device* device, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    device->output->ConnectBearers(device->enbRrc->GetUeManager(rnti), true, imsi, cellId);
+}
+
+void
+LteTraceOutput::UeReconfiguration(Device* device, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    device->output->ConnectBearers(device->ueRrc, false, imsi, 0);
+}
+
+void
+LteTraceOutput::PduTx(Bearer* bearer, uint16_t rnti, uint8_t lcid, uint32_t size)
+{
+    if (bearer->output->m_kpis)
+    {
+        return;
+    }
+    BearerCounters& c = bearer->tx->bearers[{bearer->imsi, lcid}];
+    if (bearer->cellId != 0)
+    {
+        c.cellId = bearer->cellId;
+    }
+    c.rnti = rnti;
+    c.txPdus++;
+    c.txBytes += size;
+}
+
+void
+LteTraceOutput::PduRx(Bearer* bearer, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delay)
+{
+    if (LteKpiAggregator* kpis = bearer->output->m_kpis.get())
+    {
+        kpis->AddRlcRx(bearer->rx == &bearer->output->m_tables[DL_RLC], bearer->imsi, size);
+        return;
+    }
+    BearerCounters& c = bearer->rx->bearers[{bearer->imsi, lcid}];
+    if (bearer->cellId != 0)
+    {
+        c.cellId = bearer->cellId;
+    }
+    double seconds = delay * 1e-9;
+    if (c.rxPdus == 0)
+    {
+        c.delayMin = c.delayMax = seconds;
+        c.sizeMin = c.sizeMax = size;
+    }
+    c.rnti = rnti;
+    c.rxPdus++;
+    c.rxBytes += size;
+    c.delaySum += seconds;
+    c.delaySq += seconds * seconds;
+    c.delayMin = std::min(c.delayMin, seconds);
+    c.delayMax = std::max(c.delayMax, seconds);
+    c.sizeSq += double(size) * size;
+    c.sizeMin = std::min(c.sizeMin, size);
+    c.sizeMax = std::max(c.sizeMax, size);
+}
+
+} // namespace ns3
@@ -0,0 +1,284 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_TRACE_OUTPUT_H
+#define LTE_TRACE_OUTPUT_H
+
+#include "async-trace-writer.h"
+#include "lte-kpi-aggregator.h"
+
+#include "ns3/command-line.h"
+#include "ns3/event-id.h"
+#include "ns3/lte-enb-mac.h"
+#include "ns3/lte-helper.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class LteEnbRrc;
+class LteUeRrc;
+
+/**
+ * LTE statistics traces of a scenario.
+ *
+ * Modes:
+ * - "ns3": LteHelper::EnableTraces(), every line written to its file from
+ *   inside the simulation event that produced it
+ * - "async": the same MAC, PHY SINR, RLC and PDCP files, written by an
+ *   AsyncTraceWriter: the trace sinks only copy a fixed-size record into a
+ *   buffer, a background thread formats the lines and writes them
+ * - "binary": as "async" but the records are written as they are, into
+ *   .bin files starting with one text line that describes the record layout
+ * - "kpi": no per-TTI lines, only per-UE and per-cell KPIs over windows of
+ *   --lteKpiWindow seconds, see LteKpiAggregator
+ * - "off": no LTE traces
+ *
+ * The async modes write DlMacStats, UlMacStats, DlRsrpSinrStats, UlSinrStats,
+ * DlRlcStats, UlRlcStats, DlPdcpStats and UlPdcpStats with the columns of the
+ * ns-3 statistics calculators. RLC and PDCP are accumulated per IMSI and LCID
+ * over epochs of --lteTraceEpoch seconds like RadioBearerStatsCalculator;
+ * data radio bearers only. The PHY transmission, reception and interference
+ * traces of "ns3" are not written.
+ *
+ * \code
+ *   LteTraceOutput traces;
+ *   traces.AddCommandLineValues(cmd);
+ *   ...
+ *   traces.Start(lteHelper); // once the LTE devices are installed
+ *   Simulator::Run();
+ *   traces.Close();
+ * \endcode
+ */
+class LteTraceOutput
+{
+  public:
+    /// Trace modes
+    enum Mode
+    {
+        OFF,
+        NS3,
+        ASYNC,
+        BINARY,
+        KPI
+    };
+
+    /**
+     * \param name "off", "ns3", "async", "binary" or "kpi"
+     * \return the mode
+     */
+    static Mode ParseMode(const std::string& name);
+
+    LteTraceOutput();
+    ~LteTraceOutput();
+
+    LteTraceOutput(const LteTraceOutput&) = delete;
+    LteTraceOutput& operator=(const LteTraceOutput&) = delete;
+
+    /**
+     * Register --lteTraces, --lteTraceBuffer, --lteTraceEpoch and --lteKpiWindow
+     * with the command line.
+     *
+     * \param cmd the command line
+     */
+    void AddCommandLineValues(CommandLine& cmd);
+
+    /**
+     * \param mode the trace mode
+     */
+    void SetMode(Mode mode);
+
+    /**
+     * \param prefix prepended to the file names of the async modes
+     */
+    void SetPrefix(const std::string& prefix);
+
+    /**
+     * \param epoch RLC and PDCP accumulation period
+     */
+    void SetEpoch(Time epoch);
+
+    /**
+     * \param window KPI aggregation window of the "kpi" mode
+     */
+    void SetKpiWindow(Time window);
+
+    /// \return the trace mode
+    Mode GetMode() const;
+
+    /**
+     * Enable the traces of all LTE devices installed so far.
+     *
+     * \param lteHelper the helper that installed them, used in "ns3" mode
+     */
+    void Start(Ptr<LteHelper> lteHelper);
+
+    /// Write the last RLC/PDCP epoch and everything buffered, close the files
+    void Close();
+
+  private:
+    /// A record sink bound to one eNB component carrier or one UE
+    struct Device
+    {
+        LteTraceOutput* output; //!< the output
+        Ptr<LteEnbRrc> enbRrc;  //!< the eNB's RRC, for IMSI lookups
+        Ptr<LteUeRrc> ueRrc;    //!< the UE's RRC
+        uint64_t imsi;          //!< the UE's IMSI, 0 for an eNB
+        uint16_t cellId;        //!< the carrier's cell, 0 for a UE
+    };
+
+    /// PDU counters of one bearer direction in the current epoch
+    struct BearerCounters
+    {
+        uint16_t cellId{0};  //!< last serving cell
+        uint16_t rnti{0};    //!< last RNTI
+        uint32_t txPdus{0};  //!< transmitted PDUs
+        uint64_t txBytes{0}; //!< transmitted bytes
+        uint32_t rxPdus{0};  //!< received PDUs
+        uint64_t rxBytes{0}; //!< received bytes
+        double delaySum{0};  //!< sum of the delays [s]
+        double delaySq{0};   //!< sum of the squared delays [s^2]
+        double delayMin{0};  //!< minimum delay [s]
+        double delayMax{0};  //!< maximum delay [s]
+        double sizeSq{0};    //!< sum of the squared received sizes [B^2]
+        uint32_t sizeMin{0}; //!< minimum received size [B]
+        uint32_t sizeMax{0}; //!< maximum received size [B]
+    };
+
+    /// Counters of one file, per IMSI and LCID
+    struct BearerTable
+    {
+        uint32_t stream;                                                //!< output stream
+        std::map<std::pair<uint64_t, uint8_t>, BearerCounters> bearers; //!< counters
+    };
+
+    /// A bearer's RLC or PDCP entity; transmissions go to tx, receptions to rx
+    struct Bearer
+    {
+        LteTraceOutput* output; //!< the output
+        BearerTable* tx;        //!< table of the transmitting direction
+        BearerTable* rx;        //!< table of the receiving direction
+        uint64_t imsi;          //!< the UE's IMSI
+        uint16_t cellId;        //!< the eNB's cell, 0 on the UE side
+    };
+
+    /// Tables indexes
+    enum Table
+    {
+        DL_RLC,
+        UL_RLC,
+        DL_PDCP,
+        UL_PDCP,
+        TABLES
+    };
+
+    /**
+     * Open a stream of the writer for the mode.
+     *
+     * \param name the file name without prefix and extension
+     * \param recordSize the record size [B]
+     * \param header the column header of text files
+     * \param layout the record layout of binary files
+     * \param formatter the text formatter
+     * \return the stream id
+     */
+    uint32_t Open(const std::string& name,
+                  std::size_t recordSize,
+                  const std::string& header,
+                  const std::string& layout,
+                  AsyncTraceWriter::Formatter formatter);
+
+    /// Connect the MAC and PHY sinks of every LTE device
+    void ConnectDevices();
+
+    /**
+     * Connect the RLC and PDCP sinks of the data radio bearers of an RRC
+     * that are not connected yet.
+     *
+     * \param rrc the eNB's UeManager or the UE's LteUeRrc
+     * \param downlink whether the object transmits downlink (eNB side)
+     * \param imsi the UE's IMSI
+     * \param cellId the eNB's cell, 0 on the UE side
+     */
+    void ConnectBearers(Ptr<Object> rrc, bool downlink, uint64_t imsi, uint16_t cellId);
+
+    /// Write the RLC/PDCP records of the epoch ending now and clear the counters
+    void WriteEpoch();
+
+    /// \return the RLC/PDCP epoch, or the KPI window in "kpi" mode
+    Time GetPeriod() const;
+
+    /// End the current epoch and schedule the end of the next one
+    void EndEpoch();
+
+    /**
+     * \param device the eNB carrier
+     * \param rnti the UE's RNTI
+     * \return the UE's IMSI, 0 if the eNB does not know the RNTI
+     */
+    static uint64_t GetImsi(const Device* device, uint16_t rnti);
+
+    // Trace sinks; the first parameter is bound at connection time
+
+    static void DlScheduling(Device* device, DlSchedulingCallbackInfo info);
+    static void UlScheduling(Device* device,
+                             uint32_t frameNo,
+                             uint32_t subframeNo,
+                             uint16_t rnti,
+                             uint8_t mcs,
+                             uint16_t size,
+                             uint8_t ccId);
+    static void RsrpSinr(Device* device,
+                         uint16_t cellId,
+                         uint16_t rnti,
+                         double rsrp,
+                         double sinr,
+                         uint8_t ccId);
+    static void UeSinr(Device* device, uint16_t cellId, uint16_t rnti, double sinr, uint8_t ccId);
+    static void EnbReconfiguration(Device* device, uint64_t imsi, uint16_t cellId, uint16_t rnti);
+    static void UeReconfiguration(Device* device, uint64_t imsi, uint16_t cellId, uint16_t rnti);
+    static void PduTx(Bearer* bearer, uint16_t rnti, uint8_t lcid, uint32_t size);
+    static void PduRx(Bearer* bearer, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delay);
+
+    std::string m_mode;                             //!< trace mode name
+    std::string m_prefix;                           //!< file name prefix
+    uint32_t m_bufferKb;                            //!< writer buffer per file [KiB]
+    double m_kpiWindow;                             //!< KPI window [s]
+    double m_epoch;                                 //!< RLC/PDCP epoch [s]
+    std::unique_ptr<LteKpiAggregator> m_kpis;       //!< the KPIs, "kpi" mode
+    std::unique_ptr<AsyncTraceWriter> m_writer;     //!< the writer, async modes
+    uint32_t m_dlMac;                               //!< DlMacStats stream
+    uint32_t m_ulMac;                               //!< UlMacStats stream
+    uint32_t m_dlSinr;                              //!< DlRsrpSinrStats stream
+    uint32_t m_ulSinr;                              //!< UlSinrStats stream
+    BearerTable m_tables[TABLES];                   //!< RLC/PDCP counters
+    Time m_epochStart;                              //!< start of the current epoch
+    EventId m_epochEvent;                           //!< end of the current epoch
+    std::vector<std::unique_ptr<Device>> m_devices; //!< bound device sinks
+    std::vector<std::unique_ptr<Bearer>> m_bearers; //!< bound bearer sinks
+    std::set<Ptr<Object>> m_connected;              //!< RLC/PDCP entities connected
+};
+
+} // namespace ns3
+
+#endif /* LTE_TRACE_OUTPUT_H */
@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-accounting.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replacements of the global allocation functions for MemoryAccounting. They
+// are kept out of the scenario library, so only the programs that offer the
+// accounting link them (see scenario/CMakeLists.txt) and all others keep the
+// default operator new and delete.
+
+namespace
+{
+
+/// Tells MemoryAccounting::Enable() that the replacements are linked
+const bool g_linked = (ns3::MemoryAccounting::SetOperatorsLinked(), true);
+
+} // namespace
+
+// The aligned variants keep their default implementation and are not accounted
+
+void*
+operator new(std::size_t size)
+{
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    ns3::MemoryAccounting::RecordNew(p, size);
+    return p;
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return operator new(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    ns3::MemoryAccounting::RecordDelete(p);
+    std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    operator delete(p);
+}
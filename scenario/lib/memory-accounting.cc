@@ -0,0 +1,458 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-accounting.h"
+
+#include "event-profiler.h"
+#include "phase-timer.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MemoryAccounting");
+
+namespace
+{
+
+/// Allocator of the bookkeeping itself, bypassing the accounted operator new
+template <typename T>
+struct MallocAllocator
+{
+    typedef T value_type; //!< allocated type
+
+    MallocAllocator() = default;
+
+    /// Rebinding constructor
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&)
+    {
+    }
+
+    /**
+     * \param n number of objects
+     * \return the memory
+     */
+    T* allocate(std::size_t n)
+    {
+        void* p = std::malloc(n * sizeof(T));
+        if (p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    /**
+     * \param p the memory
+     */
+    void deallocate(T* p, std::size_t)
+    {
+        std::free(p);
+    }
+
+    /// \return true, the allocator is stateless
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const
+    {
+        return true;
+    }
+
+    /// \return false, the allocator is stateless
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const
+    {
+        return false;
+    }
+};
+
+/// A live allocation
+struct Allocation
+{
+    std::size_t bytes; //!< requested size
+    uint32_t label;    //!< label charged
+};
+
+/// Bytes per label
+struct LabelStats
+{
+    uint64_t liveBytes{0};   //!< allocated and not freed
+    uint64_t peakBytes{0};   //!< maximum of liveBytes
+    uint64_t allocations{0}; //!< allocations made
+};
+
+/// Live allocations by address
+typedef std::unordered_map<void*,
+                           Allocation,
+                           std::hash<void*>,
+                           std::equal_to<void*>,
+                           MallocAllocator<std::pair<void* const, Allocation>>>
+    AllocationMap;
+
+/// Accounting state, never destroyed as delete may run after static destructors
+struct Accounting
+{
+    std::mutex mutex;                                           //!< protects the rest
+    AllocationMap live;                                         //!< live allocations
+    std::vector<LabelStats, MallocAllocator<LabelStats>> stats; //!< stats per label
+    std::vector<std::string> names;                             //!< label names
+    std::map<std::string, uint32_t> ids;                        //!< label ids by name
+};
+
+/// Enable() was called
+std::atomic<bool> g_enabled{false};
+
+/// The program links the replaced operator new and delete
+bool g_operatorsLinked = false;
+
+/// Label charged for the allocations of this thread
+thread_local uint32_t t_label = 0;
+
+/// The thread is inside the accounting, whose own allocations are not charged
+thread_local bool t_inside = false;
+
+/// Marks the calling thread as inside the accounting while it lives
+class InsideAccounting
+{
+  public:
+    InsideAccounting()
+        : m_inside(t_inside)
+    {
+        t_inside = true;
+    }
+
+    ~InsideAccounting()
+    {
+        t_inside = m_inside;
+    }
+
+  private:
+    bool m_inside; //!< state to restore
+};
+
+/// \return the accounting state
+Accounting&
+GetAccounting()
+{
+    static Accounting* accounting = new (std::malloc(sizeof(Accounting))) Accounting();
+    return *accounting;
+}
+
+/**
+ * \param p allocated memory
+ * \param bytes its size
+ */
+void
+RecordAllocation(void* p, std::size_t bytes)
+{
+    if (t_inside)
+    {
+        return;
+    }
+    InsideAccounting inside;
+    Accounting& accounting = GetAccounting();
+    std::lock_guard<std::mutex> lock(accounting.mutex);
+    accounting.live[p] = {bytes, t_label};
+    LabelStats& stats = accounting.stats[t_label];
+    stats.liveBytes += bytes;
+    stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+    stats.allocations++;
+}
+
+/**
+ * \param p memory about to be freed
+ */
+void
+RecordFree(void* p)
+{
+    if (t_inside)
+    {
+        return;
+    }
+    InsideAccounting inside;
+    Accounting& accounting = GetAccounting();
+    std::lock_guard<std::mutex> lock(accounting.mutex);
+    auto i = accounting.live.find(p);
+    if (i != accounting.live.end())
+    {
+        accounting.stats[i->second.label].liveBytes -= i->second.bytes;
+        accounting.live.erase(i);
+    }
+}
+
+/// Label substrings and their components, the first match wins
+const std::pair<const char*, const char*> COMPONENTS[] = {
+    {"StatsCalculator", "trace writers"},
+    {"PcapFile", "trace writers"},
+    {"Ascii", "trace writers"},
+    {"TraceOutput", "trace writers"},
+    {"FlowMonitor", "FlowMonitor"},
+    {"FlowProbe", "FlowMonitor"},
+    {"FlowClassifier", "FlowMonitor"},
+    {"Animation", "NetAnim"},
+    {"InstallEnbDevice", "LTE devices (setup)"},
+    {"InstallUeDevice", "LTE devices (setup)"},
+    {"Attach", "LTE devices (setup)"},
+    {"Rlc", "LTE RLC"},
+    {"Pdcp", "LTE PDCP and RRC"},
+    {"Rrc", "LTE PDCP and RRC"},
+    {"Mac", "LTE MAC"},
+    {"Phy", "LTE PHY"},
+    {"Spectrum", "LTE PHY"},
+    {"Interference", "LTE PHY"},
+    {"ChunkProcessor", "LTE PHY"},
+    {"Epc", "nodes and core"},
+    {"InstallApplications", "applications"},
+    {"Application", "applications"},
+    {"PacketSink", "applications"},
+    {"UdpClient", "applications"},
+    {"BulkSend", "applications"},
+    {"AssignUeIpv4Address", "IP stacks"},
+    {"Ipv4", "IP stacks"},
+    {"Tcp", "IP stacks"},
+    {"Udp", "IP stacks"},
+    {"Arp", "IP stacks"},
+    {"Icmp", "IP stacks"},
+    {"TrafficControl", "IP stacks"},
+    {"QueueDisc", "IP stacks"},
+    {"CreateTopology", "nodes and core"},
+    {"InstallMobility", "nodes and core"},
+    {"Mobility", "nodes and core"},
+    {"PointToPoint", "nodes and core"},
+    {"Run", "simulator"},
+    {"Scheduler", "simulator"},
+};
+
+/// Sampling output
+std::ofstream g_samples;
+
+/**
+ * \return live bytes per component
+ */
+std::map<std::string, uint64_t>
+GetComponents()
+{
+    std::vector<std::pair<std::string, uint64_t>> labels;
+    {
+        InsideAccounting inside;
+        Accounting& accounting = GetAccounting();
+        std::lock_guard<std::mutex> lock(accounting.mutex);
+        for (uint32_t id = 0; id < accounting.names.size(); id++)
+        {
+            labels.emplace_back(accounting.names[id], accounting.stats[id].liveBytes);
+        }
+    }
+    std::map<std::string, uint64_t> components;
+    for (const auto& [name, bytes] : labels)
+    {
+        components[MemoryAccounting::GetComponent(name)] += bytes;
+    }
+    return components;
+}
+
+/// Peak live bytes per component over the samples
+std::map<std::string, uint64_t> g_peaks;
+
+/**
+ * Write one sample and schedule the next.
+ *
+ * \param interval time between two samples
+ */
+void
+Sample(Time interval)
+{
+    for (const auto& [component, bytes] : GetComponents())
+    {
+        g_samples << Simulator::Now().GetSeconds() << "," << component << "," << bytes << "\n";
+        g_peaks[component] = std::max(g_peaks[component], bytes);
+    }
+    Simulator::Schedule(interval, &Sample, interval);
+}
+
+} // namespace
+
+MemoryAccounting::Scope::Scope(const std::string& label)
+    : m_previous(-1)
+{
+    if (g_enabled)
+    {
+        m_previous = SetCurrentLabel(GetLabel(label));
+    }
+}
+
+MemoryAccounting::Scope::~Scope()
+{
+    if (m_previous >= 0)
+    {
+        SetCurrentLabel(m_previous);
+    }
+}
+
+void
+MemoryAccounting::Enable()
+{
+    if (g_enabled)
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(!g_operatorsLinked,
+                    "The memory accounting needs lib/memory-accounting-operators.cc linked "
+                    "into the program, see scenario/CMakeLists.txt");
+    // Label 0 takes whatever is allocated outside any scope
+    GetLabel("unlabelled");
+    g_enabled = true;
+    PhaseTimer::Enable();
+    EventProfiler::Enable();
+}
+
+bool
+MemoryAccounting::IsEnabled()
+{
+    return g_enabled;
+}
+
+void
+MemoryAccounting::SetOperatorsLinked()
+{
+    g_operatorsLinked = true;
+}
+
+void
+MemoryAccounting::RecordNew(void* p, std::size_t bytes)
+{
+    if (g_enabled.load(std::memory_order_relaxed))
+    {
+        RecordAllocation(p, bytes);
+    }
+}
+
+void
+MemoryAccounting::RecordDelete(void* p)
+{
+    if (p != nullptr && g_enabled.load(std::memory_order_relaxed))
+    {
+        RecordFree(p);
+    }
+}
+
+uint32_t
+MemoryAccounting::GetLabel(const std::string& name)
+{
+    InsideAccounting inside;
+    Accounting& accounting = GetAccounting();
+    std::lock_guard<std::mutex> lock(accounting.mutex);
+    auto [i, inserted] = accounting.ids.emplace(name, accounting.names.size());
+    if (inserted)
+    {
+        accounting.names.push_back(name);
+        accounting.stats.emplace_back();
+    }
+    return i->second;
+}
+
+uint32_t
+MemoryAccounting::SetCurrentLabel(uint32_t label)
+{
+    uint32_t previous = t_label;
+    t_label = label;
+    return previous;
+}
+
+std::string
+MemoryAccounting::GetComponent(const std::string& label)
+{
+    for (const auto& [pattern, component] : COMPONENTS)
+    {
+        if (label.find(pattern) != std::string::npos)
+        {
+            return component;
+        }
+    }
+    return "other";
+}
+
+void
+MemoryAccounting::StartSampling(Time interval, const std::string& filename)
+{
+    NS_ABORT_MSG_IF(!g_enabled, "Enable the memory accounting before sampling");
+    NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "The sampling interval must be positive");
+    g_samples.open(filename);
+    NS_ABORT_MSG_IF(!g_samples.is_open(), "Cannot open " << filename);
+    g_samples << "time,component,liveBytes\n";
+    Simulator::ScheduleNow(&Sample, interval);
+}
+
+void
+MemoryAccounting::Print(std::ostream& os, uint32_t top)
+{
+    std::vector<std::pair<std::string, LabelStats>> labels;
+    {
+        InsideAccounting inside;
+        Accounting& accounting = GetAccounting();
+        std::lock_guard<std::mutex> lock(accounting.mutex);
+        for (uint32_t id = 0; id < accounting.names.size(); id++)
+        {
+            labels.emplace_back(accounting.names[id], accounting.stats[id]);
+        }
+    }
+    std::map<std::string, uint64_t> components = GetComponents();
+    uint64_t total = 0;
+    for (const auto& [component, bytes] : components)
+    {
+        total += bytes;
+    }
+
+    os << "\n*** Memory accounting ***\n";
+    os << "Live heap bytes charged: " << total << "\n";
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(2);
+    os << "\n  live [MiB]  peak [MiB]  component\n";
+    for (const auto& [component, bytes] : components)
+    {
+        os << std::setw(12) << bytes / 1048576.0 << std::setw(12)
+           << std::max(g_peaks[component], bytes) / 1048576.0 << "  " << component << "\n";
+    }
+
+    std::sort(labels.begin(), labels.end(), [](const auto& a, const auto& b) {
+        return a.second.liveBytes > b.second.liveBytes;
+    });
+    os << "\n  live [MiB]  peak [MiB]  allocations  label\n";
+    for (std::size_t i = 0; i < labels.size() && i < top; i++)
+    {
+        const LabelStats& stats = labels[i].second;
+        os << std::setw(12) << stats.liveBytes / 1048576.0 << std::setw(12)
+           << stats.peakBytes / 1048576.0 << std::setw(13) << stats.allocations << "  "
+           << labels[i].first << "\n";
+    }
+    os.flags(flags);
+}
+
+} // namespace ns3
+
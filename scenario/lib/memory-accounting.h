@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include "ns3/nstime.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Opt-in accounting of live heap bytes per component.
+ *
+ * memory-accounting-operators.cc replaces the global operator new and delete;
+ * it is linked only into the programs offering the accounting, and Enable()
+ * aborts in the others. Once Enable() was called every allocation is charged
+ * to the current label of its thread until it is freed; before, the
+ * replacement costs one flag test per call.
+ * Labels are set by
+ * - PhaseTimer::Scope, with the phase name: "CreateTopology",
+ *   "InstallEnbDevice", "InstallUeDevice", "AssignUeIpv4Address",
+ *   "FlowMonitorHelper::Install", "AnimationInterface", ...
+ * - the EventProfiler while the simulation runs, with the object type of the
+ *   executing event: ns3::LteEnbPhy, ns3::LteRlcUm, ns3::FlowMonitor, ...
+ * - MemoryAccounting::Scope for anything else.
+ *
+ * Labels are grouped into components (nodes and core, LTE PHY/MAC/RLC/PDCP
+ * and RRC, IP stacks, applications, FlowMonitor, NetAnim, trace writers,
+ * simulator) for the report. Memory freed by the C library directly (malloc
+ * and free) and allocations made before Enable() are not seen.
+ *
+ * \code
+ *   MemoryAccounting::Enable(); // also enables PhaseTimer and EventProfiler
+ *   // build the scenario
+ *   MemoryAccounting::StartSampling(Seconds(1), "memory.csv");
+ *   Simulator::Run();
+ *   MemoryAccounting::Print(std::cout);
+ * \endcode
+ */
+class MemoryAccounting
+{
+  public:
+    /// Charges the allocations of its lifetime to a label
+    class Scope
+    {
+      public:
+        /**
+         * \param label the label
+         */
+        explicit Scope(const std::string& label);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        int64_t m_previous; //!< label to restore, -1 if disabled
+    };
+
+    /// Start accounting; enables the PhaseTimer and the EventProfiler for labels
+    static void Enable();
+
+    /// \return true once Enable() was called
+    static bool IsEnabled();
+
+    /// Called by memory-accounting-operators.cc when it is linked
+    static void SetOperatorsLinked();
+
+    /**
+     * Charge an allocation, if enabled; called by the replaced operator new.
+     *
+     * \param p the allocated memory
+     * \param bytes its size
+     */
+    static void RecordNew(void* p, std::size_t bytes);
+
+    /**
+     * Release an allocation, if enabled; called by the replaced operator delete.
+     *
+     * \param p memory about to be freed
+     */
+    static void RecordDelete(void* p);
+
+    /**
+     * \param name a label name
+     * \return the label id, registered on first use
+     */
+    static uint32_t GetLabel(const std::string& name);
+
+    /**
+     * \param label the label of the calling thread's next allocations
+     * \return the previous label
+     */
+    static uint32_t SetCurrentLabel(uint32_t label);
+
+    /**
+     * \param label a label name, a phase name or an object type
+     * \return the component the label belongs to
+     */
+    static std::string GetComponent(const std::string& label);
+
+    /**
+     * Write "time,component,liveBytes" rows every interval while the
+     * simulation runs.
+     *
+     * \param interval time between two samples
+     * \param filename the CSV file
+     */
+    static void StartSampling(Time interval, const std::string& filename);
+
+    /**
+     * Print live and peak bytes per component, and the labels holding the
+     * most live bytes.
+     *
+     * \param os the output stream
+     * \param top number of labels listed
+     */
+    static void Print(std::ostream& os, uint32_t top = 20);
+};
+
+} // namespace ns3
+
+#endif /* MEMORY_ACCOUNTING_H */
@@ -0,0 +1,190 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "phase-timer.h"
+
+#include "memory-accounting.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PhaseTimer");
+
+namespace
+{
+
+/// A recorded phase
+struct Phase
+{
+    std::string name;   //!< phase name
+    uint32_t depth;     //!< nesting depth
+    double seconds;     //!< wall time [s]
+    uint64_t rssKb;     //!< resident set size at the end [KiB]
+    int64_t rssDeltaKb; //!< change of the resident set size [KiB]
+};
+
+/// \return the phases, in start order
+std::vector<Phase>&
+GetPhases()
+{
+    static std::vector<Phase> phases;
+    return phases;
+}
+
+/// Enable() was called
+bool g_enabled = false;
+
+/// Depth of the next phase started
+uint32_t g_depth = 0;
+
+} // namespace
+
+PhaseTimer::Scope::Scope(const char* name)
+    : m_index(-1),
+      m_startRssKb(0),
+      m_previousLabel(-1)
+{
+    if (!g_enabled)
+    {
+        return;
+    }
+    // MemoryAccounting::Enable() also enables the phases
+    if (MemoryAccounting::IsEnabled())
+    {
+        m_previousLabel = MemoryAccounting::SetCurrentLabel(MemoryAccounting::GetLabel(name));
+    }
+    std::vector<Phase>& phases = GetPhases();
+    m_index = phases.size();
+    phases.push_back({name, g_depth++, 0, 0, 0});
+    m_startRssKb = GetRssKb();
+    m_start = std::chrono::steady_clock::now();
+}
+
+PhaseTimer::Scope::~Scope()
+{
+    if (m_index < 0)
+    {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    g_depth--;
+    if (m_previousLabel >= 0)
+    {
+        MemoryAccounting::SetCurrentLabel(m_previousLabel);
+    }
+    // Reset() inside the scope dropped the phase
+    std::vector<Phase>& phases = GetPhases();
+    if (static_cast<std::size_t>(m_index) >= phases.size())
+    {
+        return;
+    }
+    Phase& phase = phases[m_index];
+    phase.seconds = std::chrono::duration<double>(end - m_start).count();
+    phase.rssKb = GetRssKb();
+    phase.rssDeltaKb = static_cast<int64_t>(phase.rssKb) - static_cast<int64_t>(m_startRssKb);
+}
+
+void
+PhaseTimer::Enable()
+{
+    g_enabled = true;
+}
+
+bool
+PhaseTimer::IsEnabled()
+{
+    return g_enabled;
+}
+
+void
+PhaseTimer::Print(std::ostream& os, std::size_t first)
+{
+    os << "\n*** Phase timing ***\n";
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "  time [s]  RSS [MiB]  delta [MiB]  phase\n";
+    const std::vector<Phase>& phases = GetPhases();
+    for (std::size_t i = first; i < phases.size(); i++)
+    {
+        const Phase& phase = phases[i];
+        os << std::setw(10) << phase.seconds << std::setw(11) << phase.rssKb / 1024.0
+           << std::setw(13) << phase.rssDeltaKb / 1024.0 << "  "
+           << std::string(2 * phase.depth, ' ') << phase.name << "\n";
+    }
+    os.flags(flags);
+}
+
+std::size_t
+PhaseTimer::GetPhaseCount()
+{
+    return GetPhases().size();
+}
+
+double
+PhaseTimer::GetSeconds(const std::string& name)
+{
+    double seconds = 0;
+    for (const auto& phase : GetPhases())
+    {
+        if (phase.name == name)
+        {
+            seconds += phase.seconds;
+        }
+    }
+    return seconds;
+}
+
+void
+PhaseTimer::WriteCsv(const std::string& filename)
+{
+    std::ofstream out(filename);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << filename);
+    out << "phase,depth,wallSeconds,rssKb,rssDeltaKb\n";
+    for (const auto& phase : GetPhases())
+    {
+        out << phase.name << "," << phase.depth << "," << phase.seconds << "," << phase.rssKb
+            << "," << phase.rssDeltaKb << "\n";
+    }
+}
+
+void
+PhaseTimer::Reset()
+{
+    GetPhases().clear();
+}
+
+uint64_t
+PhaseTimer::GetRssKb()
+{
+    // Second field of statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Opt-in wall time and memory breakdown of the setup and run phases of a
+ * scenario.
+ *
+ * A phase is timed by a Scope object living for its duration; scopes nest, so
+ * "Build" can contain "InstallEnbDevice", "InstallUeDevice", ... Every phase
+ * records its wall time, the resident set size at its end and the change of
+ * the resident set size over the phase. Until Enable() is called a Scope
+ * costs a single flag test; phase names are string literals, so nothing is
+ * copied or allocated then. With the MemoryAccounting enabled, the heap
+ * allocated within a phase is charged to a label of the phase's name.
+ *
+ * \code
+ *   PhaseTimer::Enable();
+ *   {
+ *       PhaseTimer::Scope phase("Build");
+ *       scenario.Build();
+ *   }
+ *   PhaseTimer::Print(std::cout);
+ *   PhaseTimer::WriteCsv("phases.csv");
+ * \endcode
+ */
+class PhaseTimer
+{
+  public:
+    /// Times a phase from construction to destruction
+    class Scope
+    {
+      public:
+        /**
+         * \param name the phase name, a string literal
+         */
+        explicit Scope(const char* name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        int64_t m_index;                               //!< phase index, -1 if disabled
+        std::chrono::steady_clock::time_point m_start; //!< wall clock at the start
+        uint64_t m_startRssKb;                         //!< resident set size at the start
+        int64_t m_previousLabel;                       //!< memory label to restore, -1 if none
+    };
+
+    /// Start recording phases
+    static void Enable();
+
+    /// \return true once Enable() was called
+    static bool IsEnabled();
+
+    /**
+     * Print the phases in start order, nested phases indented.
+     *
+     * \param os the output stream
+     * \param first index of the first phase printed, e.g. a GetPhaseCount()
+     *        taken earlier to print only the phases since then
+     */
+    static void Print(std::ostream& os, std::size_t first = 0);
+
+    /// \return the number of phases recorded so far
+    static std::size_t GetPhaseCount();
+
+    /**
+     * \param name a phase name
+     * \return the wall time of all completed phases of that name [s]
+     */
+    static double GetSeconds(const std::string& name);
+
+    /**
+     * Write one "phase,depth,wallSeconds,rssKb,rssDeltaKb" row per phase.
+     *
+     * \param filename the output file
+     */
+    static void WriteCsv(const std::string& filename);
+
+    /// Drop the recorded phases, e.g. between replications
+    static void Reset();
+
+    /// \return the current resident set size [KiB], 0 if unknown
+    static uint64_t GetRssKb();
+};
+
+} // namespace ns3
+
+#endif /* PHASE_TIMER_H */
@@ -0,0 +1,313 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "profiled-ff-mac-scheduler.h"
+
+#include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+
+#include <chrono>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ProfiledFfMacScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfiledFfMacScheduler);
+
+namespace
+{
+
+/// \return nanoseconds of the steady clock
+int64_t
+Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+class ProfiledFfMacScheduler::SchedProvider : public FfMacSchedSapProvider
+{
+  public:
+    /**
+     * \param owner the profiled scheduler
+     */
+    SchedProvider(ProfiledFfMacScheduler* owner)
+        : m_owner(owner)
+    {
+    }
+
+    // Inherited
+    void SchedDlRlcBufferReq(const SchedDlRlcBufferReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlRlcBufferReq, params, false);
+    }
+
+    void SchedDlPagingBufferReq(const SchedDlPagingBufferReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlPagingBufferReq, params, false);
+    }
+
+    void SchedDlMacBufferReq(const SchedDlMacBufferReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlMacBufferReq, params, false);
+    }
+
+    void SchedDlTriggerReq(const SchedDlTriggerReqParameters& params) override
+    {
+        m_owner->m_ttis++;
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlTriggerReq, params, true);
+    }
+
+    void SchedDlRachInfoReq(const SchedDlRachInfoReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlRachInfoReq, params, false);
+    }
+
+    void SchedDlCqiInfoReq(const SchedDlCqiInfoReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedDlCqiInfoReq, params, false);
+    }
+
+    void SchedUlTriggerReq(const SchedUlTriggerReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedUlTriggerReq, params, true);
+    }
+
+    void SchedUlNoiseInterferenceReq(const SchedUlNoiseInterferenceReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedUlNoiseInterferenceReq, params, false);
+    }
+
+    void SchedUlSrInfoReq(const SchedUlSrInfoReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedUlSrInfoReq, params, false);
+    }
+
+    void SchedUlMacCtrlInfoReq(const SchedUlMacCtrlInfoReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedUlMacCtrlInfoReq, params, false);
+    }
+
+    void SchedUlCqiInfoReq(const SchedUlCqiInfoReqParameters& params) override
+    {
+        m_owner->Call(&FfMacSchedSapProvider::SchedUlCqiInfoReq, params, false);
+    }
+
+  private:
+    ProfiledFfMacScheduler* m_owner; //!< the profiled scheduler
+};
+
+class ProfiledFfMacScheduler::SchedUser : public FfMacSchedSapUser
+{
+  public:
+    /**
+     * \param owner the profiled scheduler
+     */
+    SchedUser(ProfiledFfMacScheduler* owner)
+        : m_owner(owner)
+    {
+    }
+
+    // Inherited
+    void SchedDlConfigInd(const SchedDlConfigIndParameters& params) override
+    {
+        m_owner->Indicate(&FfMacSchedSapUser::SchedDlConfigInd, params);
+    }
+
+    void SchedUlConfigInd(const SchedUlConfigIndParameters& params) override
+    {
+        m_owner->Indicate(&FfMacSchedSapUser::SchedUlConfigInd, params);
+    }
+
+  private:
+    ProfiledFfMacScheduler* m_owner; //!< the profiled scheduler
+};
+
+TypeId
+ProfiledFfMacScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ProfiledFfMacScheduler")
+            .SetParent<FfMacScheduler>()
+            .SetGroupName("Lte")
+            .AddConstructor<ProfiledFfMacScheduler>()
+            .AddAttribute("Scheduler",
+                          "TypeId name of the FF MAC scheduler that is wrapped and timed",
+                          StringValue("ns3::PfFfMacScheduler"),
+                          MakeStringAccessor(&ProfiledFfMacScheduler::m_schedulerType),
+                          MakeStringChecker());
+    return tid;
+}
+
+ProfiledFfMacScheduler::ProfiledFfMacScheduler()
+    : m_macUser(nullptr),
+      m_depth(0),
+      m_macNanoseconds(0),
+      m_ttis(0),
+      m_nanoseconds(0),
+      m_triggerNanoseconds(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_provider = new SchedProvider(this);
+    m_user = new SchedUser(this);
+}
+
+ProfiledFfMacScheduler::~ProfiledFfMacScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ProfiledFfMacScheduler::DoInitialize()
+{
+    NS_LOG_FUNCTION(this);
+    GetScheduler()->Initialize();
+    FfMacScheduler::DoInitialize();
+}
+
+void
+ProfiledFfMacScheduler::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO(m_schedulerType << ": " << m_ttis << " TTIs, " << m_nanoseconds << " ns");
+    if (m_scheduler)
+    {
+        m_scheduler->Dispose();
+        m_scheduler = nullptr;
+    }
+    delete m_provider;
+    m_provider = nullptr;
+    delete m_user;
+    m_user = nullptr;
+    FfMacScheduler::DoDispose();
+}
+
+Ptr<FfMacScheduler>
+ProfiledFfMacScheduler::GetScheduler()
+{
+    if (!m_scheduler)
+    {
+        NS_ABORT_MSG_IF(m_schedulerType == GetTypeId().GetName(),
+                        "A profiled scheduler cannot wrap itself");
+        ObjectFactory factory(m_schedulerType);
+        NS_ABORT_MSG_IF(!factory.GetTypeId().IsChildOf(FfMacScheduler::GetTypeId()),
+                        m_schedulerType << " is not an FF MAC scheduler");
+        // The helper configures only the wrapper, so pass its attributes on
+        factory.Set("UlCqiFilter", EnumValue(m_ulCqiFilter));
+        m_scheduler = factory.Create<FfMacScheduler>();
+        m_scheduler->SetFfMacSchedSapUser(m_user);
+    }
+    return m_scheduler;
+}
+
+void
+ProfiledFfMacScheduler::SetFfMacCschedSapUser(FfMacCschedSapUser* s)
+{
+    GetScheduler()->SetFfMacCschedSapUser(s);
+}
+
+void
+ProfiledFfMacScheduler::SetFfMacSchedSapUser(FfMacSchedSapUser* s)
+{
+    m_macUser = s;
+}
+
+FfMacCschedSapProvider*
+ProfiledFfMacScheduler::GetFfMacCschedSapProvider()
+{
+    return GetScheduler()->GetFfMacCschedSapProvider();
+}
+
+FfMacSchedSapProvider*
+ProfiledFfMacScheduler::GetFfMacSchedSapProvider()
+{
+    return m_provider;
+}
+
+void
+ProfiledFfMacScheduler::SetLteFfrSapProvider(LteFfrSapProvider* s)
+{
+    GetScheduler()->SetLteFfrSapProvider(s);
+}
+
+LteFfrSapUser*
+ProfiledFfMacScheduler::GetLteFfrSapUser()
+{
+    return GetScheduler()->GetLteFfrSapUser();
+}
+
+uint64_t
+ProfiledFfMacScheduler::GetTtis() const
+{
+    return m_ttis;
+}
+
+int64_t
+ProfiledFfMacScheduler::GetNanoseconds() const
+{
+    return m_nanoseconds;
+}
+
+int64_t
+ProfiledFfMacScheduler::GetTriggerNanoseconds() const
+{
+    return m_triggerNanoseconds;
+}
+
+template <class Parameters>
+void
+ProfiledFfMacScheduler::Call(void (FfMacSchedSapProvider::*method)(const Parameters&),
+                             const Parameters& params,
+                             bool trigger)
+{
+    FfMacSchedSapProvider* provider = GetScheduler()->GetFfMacSchedSapProvider();
+    // Requests the MAC makes from within an indication are part of the MAC's time
+    if (m_depth > 0)
+    {
+        (provider->*method)(params);
+        return;
+    }
+    m_depth++;
+    int64_t macBefore = m_macNanoseconds;
+    int64_t start = Now();
+    (provider->*method)(params);
+    int64_t elapsed = Now() - start - (m_macNanoseconds - macBefore);
+    m_depth--;
+    m_nanoseconds += elapsed;
+    if (trigger)
+    {
+        m_triggerNanoseconds += elapsed;
+    }
+}
+
+template <class Parameters>
+void
+ProfiledFfMacScheduler::Indicate(void (FfMacSchedSapUser::*method)(const Parameters&),
+                                 const Parameters& params)
+{
+    NS_ASSERT_MSG(m_macUser, "No MAC SAP set");
+    int64_t start = Now();
+    (m_macUser->*method)(params);
+    m_macNanoseconds += Now() - start;
+}
+
+} // namespace ns3
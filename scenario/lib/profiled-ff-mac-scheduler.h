@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILED_FF_MAC_SCHEDULER_H
+#define PROFILED_FF_MAC_SCHEDULER_H
+
+#include "ns3/ff-mac-csched-sap.h"
+#include "ns3/ff-mac-sched-sap.h"
+#include "ns3/ff-mac-scheduler.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * FF MAC scheduler wrapping another one and timing it.
+ *
+ * The MAC calls its scheduler synchronously through the FF MAC SCHED SAP,
+ * from within its own subframe events, so the EventProfiler charges the
+ * scheduler to LteEnbMac. This wrapper sits between the two: every SCHED SAP
+ * request is forwarded to the wrapped scheduler and timed with a steady
+ * clock, minus the time the MAC spends in the SchedDlConfigInd() and
+ * SchedUlConfigInd() callbacks the scheduler makes from within. CSCHED
+ * (configuration) requests and the FFR SAP are passed through untimed.
+ *
+ * The wrapped scheduler gets the wrapper's UlCqiFilter attribute and is
+ * initialized and disposed with it.
+ *
+ * \code
+ *   lteHelper->SetSchedulerType("ns3::ProfiledFfMacScheduler");
+ *   lteHelper->SetSchedulerAttribute("Scheduler", StringValue("ns3::RrFfMacScheduler"));
+ * \endcode
+ */
+class ProfiledFfMacScheduler : public FfMacScheduler
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ProfiledFfMacScheduler();
+    ~ProfiledFfMacScheduler() override;
+
+    // Inherited
+    void SetFfMacCschedSapUser(FfMacCschedSapUser* s) override;
+    void SetFfMacSchedSapUser(FfMacSchedSapUser* s) override;
+    FfMacCschedSapProvider* GetFfMacCschedSapProvider() override;
+    FfMacSchedSapProvider* GetFfMacSchedSapProvider() override;
+    void SetLteFfrSapProvider(LteFfrSapProvider* s) override;
+    LteFfrSapUser* GetLteFfrSapUser() override;
+
+    /// \return the wrapped scheduler, created on first use
+    Ptr<FfMacScheduler> GetScheduler();
+
+    /// \return DL trigger requests so far, i.e. scheduled TTIs
+    uint64_t GetTtis() const;
+
+    /// \return wall time of all SCHED SAP requests [ns]
+    int64_t GetNanoseconds() const;
+
+    /// \return wall time of the DL and UL trigger requests [ns]
+    int64_t GetTriggerNanoseconds() const;
+
+  protected:
+    void DoInitialize() override;
+    void DoDispose() override;
+
+  private:
+    /// SCHED SAP given to the MAC
+    class SchedProvider;
+    /// SCHED SAP given to the wrapped scheduler
+    class SchedUser;
+
+    /**
+     * Forward a SCHED SAP request to the wrapped scheduler and time it.
+     *
+     * \param method the request
+     * \param params its parameters
+     * \param trigger whether it is a DL or UL trigger
+     */
+    template <class Parameters>
+    void Call(void (FfMacSchedSapProvider::*method)(const Parameters&),
+              const Parameters& params,
+              bool trigger);
+
+    /**
+     * Forward a SCHED SAP indication to the MAC, timing it to exclude it
+     * from the request it is made from.
+     *
+     * \param method the indication
+     * \param params its parameters
+     */
+    template <class Parameters>
+    void Indicate(void (FfMacSchedSapUser::*method)(const Parameters&), const Parameters& params);
+
+    std::string m_schedulerType;       //!< TypeId of the wrapped scheduler
+    Ptr<FfMacScheduler> m_scheduler;   //!< the wrapped scheduler
+    FfMacSchedSapProvider* m_provider; //!< SAP given to the MAC
+    FfMacSchedSapUser* m_user;         //!< SAP given to the wrapped scheduler
+    FfMacSchedSapUser* m_macUser;      //!< the MAC's SAP
+    uint32_t m_depth;                  //!< nested requests
+    int64_t m_macNanoseconds;          //!< time in the MAC's indications [ns]
+    uint64_t m_ttis;                   //!< DL trigger requests
+    int64_t m_nanoseconds;             //!< time in all requests [ns]
+    int64_t m_triggerNanoseconds;      //!< time in trigger requests [ns]
+};
+
+} // namespace ns3
+
+#endif /* PROFILED_FF_MAC_SCHEDULER_H */
@@ -0,0 +1,629 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "project-scenario.h"
+
+#include "cached-propagation-loss-model.h"
+#include "culled-spectrum-channel.h"
+#include "phase-timer.h"
+
+#include "ns3/mobility-module.h"
+
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ProjectScenario");
+
+void
+ProjectParameters::AddCommandLineValues(CommandLine& cmd)
+{
+    cmd.AddValue("numberOfUes", "Number of UEs", numberOfUes);
+    cmd.AddValue("numberOfEnbs", "Number of eNodeBs", numberOfEnbs);
+    cmd.AddValue("simTime", "Total duration of the simulation [s])", simTime);
+    cmd.AddValue("distance", "Distance between eNBs [m]", distance);
+    cmd.AddValue("useCa", "Whether to use carrier aggregation.", useCa);
+    cmd.AddValue("interval", "Inter-packet interval for UDP client [ms]", interval);
+    cmd.AddValue("dlBandwidth", "Downlink bandwidth of eNBs", dlBandwidth);
+    cmd.AddValue("upBandwidth", "Uplink bandwidth of eNBs", upBandwidth);
+    cmd.AddValue("txPower", "Transmission power of UEs", txPower);
+    cmd.AddValue("ftpPacketSize", "Size of FTP packets to sent", ftpPacketSize);
+    cmd.AddValue("ftpDataSize", "The amount of data to be sent through FTP", ftpDataSize);
+    cmd.AddValue("videoPacketSize",
+                 "Size of video packets to be sent by the remote server",
+                 videoPacketSize);
+    cmd.AddValue("videoDataSize", "The amount of video data to be sent", videoDataSize);
+    cmd.AddValue("walkSpeed", "The speed of pedestrians default=2.0", walkSpeed);
+    cmd.AddValue("layout", "Placement of eNBs and UEs (line, hex or clusters)", layout);
+    cmd.AddValue("clusters", "Hotspots of the clusters layout, 0 for one per eNB", clusters);
+    cmd.AddValue("clusterRadius", "Hotspot radius of the clusters layout [m]", clusterRadius);
+    cmd.AddValue("trafficMix",
+                 "Share of video and FTP UEs, e.g. video:20,ftp:10; empty for the fixed flows",
+                 trafficMix);
+    cmd.AddValue("positionStore",
+                 "Whether walking UEs are evaluated together from contiguous arrays (a "
+                 "UePositionStore) instead of one RandomWalk2dMobilityModel each",
+                 positionStore);
+    cmd.AddValue("pathlossCache",
+                 "If > 0, reuse the path loss of a transmitter/receiver pair while both stay "
+                 "within grid cells of this size [m]",
+                 pathlossCache);
+    cmd.AddValue("cullThreshold",
+                 "If >= 0, skip receivers whose signal would arrive more than this below "
+                 "the thermal noise, found through a spatial index [dB]",
+                 cullThreshold);
+}
+
+void
+ProjectParameters::AddResultsParameters(ResultsWriter& results) const
+{
+    results.AddParameter("numberOfUes", numberOfUes);
+    results.AddParameter("numberOfEnbs", numberOfEnbs);
+    results.AddParameter("simTime", simTime);
+    results.AddParameter("distance", distance);
+    results.AddParameter("useCa", useCa);
+    results.AddParameter("interval", interval);
+    results.AddParameter("dlBandwidth", dlBandwidth);
+    results.AddParameter("upBandwidth", upBandwidth);
+    results.AddParameter("txPower", txPower);
+    results.AddParameter("ftpPacketSize", ftpPacketSize);
+    results.AddParameter("ftpDataSize", ftpDataSize);
+    results.AddParameter("videoPacketSize", videoPacketSize);
+    results.AddParameter("videoDataSize", videoDataSize);
+    results.AddParameter("walkSpeed", walkSpeed);
+    results.AddParameter("layout", layout);
+    results.AddParameter("clusters", clusters);
+    results.AddParameter("clusterRadius", clusterRadius);
+    // The mix itself contains commas, which CSV results cannot hold
+    TrafficMix mix(trafficMix);
+    results.AddParameter("videoPercent", mix.GetPercent(TrafficMix::VIDEO));
+    results.AddParameter("ftpPercent", mix.GetPercent(TrafficMix::FTP));
+    results.AddParameter("pathlossCache", pathlossCache);
+    results.AddParameter("positionStore", positionStore);
+    results.AddParameter("cullThreshold", cullThreshold);
+    results.AddParameter("RngSeed", RngSeedManager::GetSeed());
+    results.AddParameter("RngRun", RngSeedManager::GetRun());
+}
+
+ProjectScenario::ProjectScenario(const ProjectParameters& params)
+    : m_params(params),
+      m_systemId(0),
+      m_systems(1)
+{
+}
+
+void
+ProjectScenario::SetPartition(uint32_t systemId, uint32_t systems)
+{
+    NS_ABORT_MSG_IF(systems < 1 || systems > 2, "The scenario splits into at most 2 partitions");
+    NS_ABORT_MSG_IF(systemId >= systems, "Rank " << systemId << " out of " << systems);
+    m_systemId = systemId;
+    m_systems = systems;
+    m_topology.SetRemoteHostSystemId(systems - 1);
+}
+
+void
+ProjectScenario::SetEnbPositions(const std::vector<Vector>& positions)
+{
+    m_enbPositions = positions;
+}
+
+void
+ProjectScenario::SetUeGroups(const std::vector<UeGroup>& groups)
+{
+    m_ueGroups = groups;
+}
+
+void
+ProjectScenario::SetFlows(const std::vector<FlowSpec>& flows)
+{
+    m_flowSpecs = flows;
+}
+
+bool
+ProjectScenario::IsRadioLocal() const
+{
+    return m_systemId == 0;
+}
+
+bool
+ProjectScenario::IsRemoteHostLocal() const
+{
+    return m_systemId == m_systems - 1;
+}
+
+void
+ProjectScenario::ConfigureDefaults()
+{
+    m_topology.SetCarrierAggregation(m_params.useCa);
+}
+
+void
+ProjectScenario::Build()
+{
+    BuildNetwork();
+    InstallApplications();
+}
+
+void
+ProjectScenario::BuildNetwork()
+{
+    NS_LOG_FUNCTION(this);
+    m_topology.SetBandwidth(m_params.dlBandwidth, m_params.upBandwidth);
+    m_topology.SetBackhaul(DataRate("100Gb/s"), 1500, Seconds(0.010));
+    // PGW, SGW, MME, the remote host with its p2p link and static route, eNBs and UEs
+    {
+        PhaseTimer::Scope phase("CreateTopology");
+        m_topology.Create(m_params.numberOfEnbs, m_params.numberOfUes);
+    }
+    {
+        PhaseTimer::Scope phase("InstallMobility");
+        InstallMobility();
+    }
+
+    // The radio side only runs in its own partition, where it would otherwise
+    // be simulated a second time
+    if (IsRadioLocal())
+    {
+        if (m_params.pathlossCache > 0)
+        {
+            InstallPathlossCache();
+        }
+        if (m_params.cullThreshold >= 0)
+        {
+            InstallInterferenceCulling();
+        }
+        // Install LTE Devices to the nodes, the IP stack and default routes to the UEs
+        m_topology.InstallLteDevices();
+
+        NetDeviceContainer ueLteDevs = m_topology.GetUeDevices();
+        for (uint32_t i = 0; i < ueLteDevs.GetN(); i++)
+        {
+            Ptr<LteUeNetDevice> ueLteNetDev = DynamicCast<LteUeNetDevice>(ueLteDevs.Get(i));
+            ueLteNetDev->GetPhy()->SetTxPower(m_params.txPower);
+        }
+
+        // Attach UEs to eNodeBs
+        m_topology.Attach();
+    }
+}
+
+const ProjectParameters&
+ProjectScenario::GetParameters() const
+{
+    return m_params;
+}
+
+ProjectParameters&
+ProjectScenario::GetParameters()
+{
+    return m_params;
+}
+
+LteEpcTopology&
+ProjectScenario::GetTopology()
+{
+    return m_topology;
+}
+
+ApplicationContainer
+ProjectScenario::GetVideoApplications() const
+{
+    return m_video;
+}
+
+ApplicationContainer
+ProjectScenario::GetFtpApplications() const
+{
+    return m_ftp;
+}
+
+ApplicationContainer
+ProjectScenario::GetFlowApplications() const
+{
+    return m_flows;
+}
+
+Ptr<UePositionStore>
+ProjectScenario::GetPositionStore() const
+{
+    return m_positions;
+}
+
+void
+ProjectScenario::InstallPathlossCache()
+{
+    // The LteHelper's path loss type has no getter, but its default holds
+    // what the command line or Config::SetDefault() chose
+    TypeId::AttributeInformation info;
+    LteHelper::GetTypeId().LookupAttributeByName("PathlossModel", &info);
+    std::string model = info.initialValue->SerializeToString(info.checker);
+
+    Ptr<LteHelper> lteHelper = m_topology.GetLteHelper();
+    lteHelper->SetPathlossModelType(CachedPropagationLossModel::GetTypeId());
+    lteHelper->SetPathlossModelAttribute("Model", StringValue(model));
+    lteHelper->SetPathlossModelAttribute("Resolution", DoubleValue(m_params.pathlossCache));
+}
+
+void
+ProjectScenario::InstallInterferenceCulling()
+{
+    Ptr<LteHelper> lteHelper = m_topology.GetLteHelper();
+    lteHelper->SetSpectrumChannelType(CulledSpectrumChannel::GetTypeId().GetName());
+    lteHelper->SetSpectrumChannelAttribute("CullThreshold", DoubleValue(m_params.cullThreshold));
+}
+
+void
+ProjectScenario::InstallMobility()
+{
+    // The walkers of a previous Build() belong to destroyed nodes
+    m_positions = nullptr;
+
+    UeLayout layout;
+    layout.SetType(UeLayout::ParseType(m_params.layout));
+    layout.SetSiteDistance(m_params.distance);
+    layout.SetClusters(m_params.clusters, m_params.clusterRadius);
+    std::vector<Vector> sites = m_enbPositions;
+    if (sites.empty())
+    {
+        sites = layout.GetSitePositions(m_params.numberOfEnbs);
+    }
+    NS_ABORT_MSG_IF(sites.size() != m_params.numberOfEnbs,
+                    sites.size() << " eNB positions for " << m_params.numberOfEnbs << " eNBs");
+
+    Ptr<ListPositionAllocator> positionAllocEnb = CreateObject<ListPositionAllocator>();
+    for (const auto& site : sites)
+    {
+        positionAllocEnb->Add(site);
+    }
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(positionAllocEnb);
+    mobility.Install(m_topology.GetEnbNodes());
+
+    // Core nodes only need a position for the animation
+    const std::pair<Ptr<Node>, Vector> coreNodes[] = {
+        {m_topology.GetRemoteHost(), Vector(300.0, 300.0, 0)},
+        {m_topology.GetPgw(), Vector(400.0, 400.0, 0)},
+        {m_topology.GetSgw(), Vector(500.0, 500.0, 0)},
+        {m_topology.GetMme(), Vector(600.0, 400.0, 0)}};
+    for (const auto& [node, position] : coreNodes)
+    {
+        mobility.Install(node);
+        node->GetObject<ConstantPositionMobilityModel>()->SetPosition(position);
+    }
+
+    // The random walks would only add events to the remote host's partition
+    if (!IsRadioLocal())
+    {
+        return;
+    }
+    if (!m_ueGroups.empty())
+    {
+        InstallUeGroups(mobility);
+        return;
+    }
+
+    Ptr<ListPositionAllocator> positionAllocUe = CreateObject<ListPositionAllocator>();
+    for (const auto& position : layout.GetUePositions(sites, m_params.numberOfUes))
+    {
+        positionAllocUe->Add(position);
+    }
+
+    // Then make UEs move
+    if (m_params.positionStore)
+    {
+        m_positions = Create<UePositionStore>();
+        m_positions->Install(m_topology.GetUeNodes(),
+                             positionAllocUe,
+                             m_params.walkSpeed,
+                             layout.GetBounds(sites));
+        return;
+    }
+    mobility.SetMobilityModel(
+        "ns3::RandomWalk2dMobilityModel",
+        "Mode",
+        StringValue("Time"),
+        "Time",
+        StringValue(std::to_string(m_params.simTime) + "s"),
+        "Speed",
+        StringValue("ns3::ConstantRandomVariable[Constant=" +
+                    std::to_string(m_params.walkSpeed) + "]"),
+        "Bounds",
+        RectangleValue(layout.GetBounds(sites)));
+    mobility.SetPositionAllocator(positionAllocUe);
+    mobility.Install(m_topology.GetUeNodes());
+}
+
+void
+ProjectScenario::InstallUeGroups(MobilityHelper& mobility)
+{
+    uint32_t total = 0;
+    for (const auto& group : m_ueGroups)
+    {
+        total += group.count;
+    }
+    NS_ABORT_MSG_IF(total != m_params.numberOfUes,
+                    "The UE groups hold " << total << " UEs, not " << m_params.numberOfUes);
+
+    NodeContainer ueNodes = m_topology.GetUeNodes();
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable>();
+    uint32_t ue = 0;
+    for (const auto& group : m_ueGroups)
+    {
+        Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+        NodeContainer nodes;
+        for (uint32_t i = 0; i < group.count; i++, ue++)
+        {
+            double r = group.radius * std::sqrt(uniform->GetValue());
+            double phi = uniform->GetValue(0, 2 * M_PI);
+            positions->Add(Vector(group.center.x + r * std::cos(phi),
+                                  group.center.y + r * std::sin(phi),
+                                  group.center.z));
+            nodes.Add(ueNodes.Get(ue));
+        }
+
+        double speed = group.speed < 0 ? m_params.walkSpeed : group.speed;
+        // Walkers stay within the square around their disc
+        Rectangle bounds(group.center.x - group.radius,
+                         group.center.x + group.radius,
+                         group.center.y - group.radius,
+                         group.center.y + group.radius);
+        if (speed == 0)
+        {
+            mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+        }
+        else if (m_params.positionStore)
+        {
+            if (!m_positions)
+            {
+                // One store for the walkers of all groups of this Build()
+                m_positions = Create<UePositionStore>();
+            }
+            m_positions->Install(nodes, positions, speed, bounds);
+            continue;
+        }
+        else
+        {
+            mobility.SetMobilityModel(
+                "ns3::RandomWalk2dMobilityModel",
+                "Mode",
+                StringValue("Time"),
+                "Time",
+                StringValue(std::to_string(m_params.simTime) + "s"),
+                "Speed",
+                StringValue("ns3::ConstantRandomVariable[Constant=" + std::to_string(speed) +
+                            "]"),
+                "Bounds",
+                RectangleValue(bounds));
+        }
+        mobility.SetPositionAllocator(positions);
+        mobility.Install(nodes);
+    }
+}
+
+void
+ProjectScenario::InstallApplications()
+{
+    NS_LOG_FUNCTION(this);
+    PhaseTimer::Scope phase("InstallApplications");
+    if (!m_flowSpecs.empty())
+    {
+        InstallFlows();
+        return;
+    }
+    NS_ABORT_MSG_IF(m_params.trafficMix.empty() && m_params.numberOfUes < 9,
+                    "The fixed video and FTP flows need at least 9 UEs");
+    NodeContainer ueNodes = m_topology.GetUeNodes();
+    TrafficInstaller video = CreateVideoInstaller();
+    TrafficInstaller ftp = CreateFtpInstaller();
+    if (!m_params.trafficMix.empty())
+    {
+        InstallTrafficMix(video, ftp);
+        return;
+    }
+
+    // ---------- STREAMING FLOW ----------
+    // Sinks on UEs 0-2, one UDP server per sink on the remote host
+    NodeContainer videoUes;
+    std::vector<Ipv4Address> videoAddresses;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        videoUes.Add(ueNodes.Get(i));
+        videoAddresses.push_back(m_topology.GetUeAddress(i));
+    }
+    Ptr<Node> remoteHost = m_topology.GetRemoteHost();
+    m_video = video.InstallDownlink(remoteHost, videoUes, videoAddresses, VIDEO_PORT);
+
+    // ---------- FTP FLOW ----------
+    // BulkSend from UE 4 (the FTP server) to a PacketSink on UE 8 (the client)
+    uint16_t firstUeID = 4;
+    uint16_t secondUeID = 8;
+    m_ftp = ftp.Install(NodeContainer(ueNodes.Get(firstUeID)),
+                        NodeContainer(ueNodes.Get(secondUeID)),
+                        {m_topology.GetUeAddress(secondUeID)},
+                        FTP_PORT);
+}
+
+void
+ProjectScenario::InstallTrafficMix(TrafficInstaller& video, TrafficInstaller& ftp)
+{
+    NodeContainer ueNodes = m_topology.GetUeNodes();
+    std::vector<TrafficMix::Class> classes =
+        TrafficMix(m_params.trafficMix).Assign(ueNodes.GetN());
+
+    // One video stream per video UE; FTP UEs are paired in turn, the first of
+    // a pair sending to the second, and a last unpaired one stays idle
+    NodeContainer videoUes;
+    std::vector<Ipv4Address> videoAddresses;
+    std::vector<uint32_t> ftpUes;
+    for (uint32_t i = 0; i < classes.size(); i++)
+    {
+        if (classes[i] == TrafficMix::VIDEO)
+        {
+            videoUes.Add(ueNodes.Get(i));
+            videoAddresses.push_back(m_topology.GetUeAddress(i));
+        }
+        else if (classes[i] == TrafficMix::FTP)
+        {
+            ftpUes.push_back(i);
+        }
+    }
+    NodeContainer ftpServers;
+    NodeContainer ftpClients;
+    std::vector<Ipv4Address> ftpAddresses;
+    for (std::size_t k = 0; k + 1 < ftpUes.size(); k += 2)
+    {
+        ftpServers.Add(ueNodes.Get(ftpUes[k]));
+        ftpClients.Add(ueNodes.Get(ftpUes[k + 1]));
+        ftpAddresses.push_back(m_topology.GetUeAddress(ftpUes[k + 1]));
+    }
+
+    Ptr<Node> remoteHost = m_topology.GetRemoteHost();
+    m_video = video.InstallDownlink(remoteHost, videoUes, videoAddresses, VIDEO_PORT);
+    m_ftp = ftp.Install(ftpServers, ftpClients, ftpAddresses, FTP_PORT);
+}
+
+void
+ProjectScenario::InstallFlows()
+{
+    m_flows = ApplicationContainer();
+    for (const auto& flow : m_flowSpecs)
+    {
+        TrafficInstaller installer(flow.client, flow.socketFactory);
+        installer.SetSystemId(m_systemId);
+        for (const auto& [name, value] : flow.attributes)
+        {
+            installer.SetClientAttribute(name, StringValue(value));
+        }
+        double stop = flow.stop < 0 ? m_params.simTime : flow.stop;
+        installer.SetStartTime(std::max(Seconds(flow.start) - Simulator::Now(), Seconds(0)));
+        installer.SetStopTime(Seconds(stop) - Simulator::Now());
+
+        NodeContainer clients;
+        NodeContainer sinks;
+        std::vector<Ipv4Address> clientAddresses;
+        std::vector<Ipv4Address> sinkAddresses;
+        ResolveEndpoint(flow.from, clients, clientAddresses);
+        ResolveEndpoint(flow.to, sinks, sinkAddresses);
+        NS_ABORT_MSG_IF(clients.GetN() > 1 && sinks.GetN() > 1 && clients.GetN() != sinks.GetN(),
+                        "Flow " << flow.from << " -> " << flow.to << " pairs " << clients.GetN()
+                                << " clients with " << sinks.GetN() << " sinks");
+        m_flows.Add(installer.Install(clients, sinks, sinkAddresses, flow.port, flow.portStep));
+    }
+}
+
+void
+ProjectScenario::ResolveEndpoint(const std::string& endpoint,
+                                 NodeContainer& nodes,
+                                 std::vector<Ipv4Address>& addresses) const
+{
+    if (endpoint == "remote")
+    {
+        nodes.Add(m_topology.GetRemoteHost());
+        addresses.push_back(m_topology.GetRemoteHostAddress());
+        return;
+    }
+
+    std::vector<uint32_t> ues;
+    if (endpoint.rfind("group:", 0) == 0)
+    {
+        std::string name = endpoint.substr(6);
+        uint32_t first = 0;
+        bool found = false;
+        for (const auto& group : m_ueGroups)
+        {
+            if (group.name == name)
+            {
+                for (uint32_t i = 0; i < group.count; i++)
+                {
+                    ues.push_back(first + i);
+                }
+                found = true;
+                break;
+            }
+            first += group.count;
+        }
+        NS_ABORT_MSG_IF(!found, "Unknown UE group " << name);
+    }
+    else if (endpoint.rfind("ue:", 0) == 0)
+    {
+        std::stringstream ss(endpoint.substr(3));
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            uint32_t first;
+            uint32_t last;
+            if (item == "*")
+            {
+                first = 0;
+                last = m_params.numberOfUes - 1;
+            }
+            else
+            {
+                std::size_t dash = item.find('-');
+                first = std::stoul(item.substr(0, dash));
+                last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+            }
+            NS_ABORT_MSG_IF(first > last || last >= m_params.numberOfUes,
+                            "UE range " << item << " out of 0-" << m_params.numberOfUes - 1);
+            for (uint32_t ue = first; ue <= last; ue++)
+            {
+                ues.push_back(ue);
+            }
+        }
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown flow endpoint " << endpoint
+                                                << ", use remote, ue:<list> or group:<name>");
+    }
+
+    NodeContainer ueNodes = m_topology.GetUeNodes();
+    for (uint32_t ue : ues)
+    {
+        nodes.Add(ueNodes.Get(ue));
+        addresses.push_back(m_topology.GetUeAddress(ue));
+    }
+}
+
+TrafficInstaller
+ProjectScenario::CreateVideoInstaller() const
+{
+    TrafficInstaller video("ns3::UdpClient", "ns3::UdpSocketFactory");
+    video.SetSystemId(m_systemId);
+    video.SetClientAttribute("MaxPackets", UintegerValue(m_params.videoDataSize));
+    video.SetClientAttribute("Interval", TimeValue(MilliSeconds(m_params.interval)));
+    video.SetClientAttribute("PacketSize", UintegerValue(m_params.videoPacketSize));
+    video.SetStartTime(std::max(Seconds(2.0) - Simulator::Now(), Seconds(0)));
+    video.SetStopTime(Seconds(m_params.simTime) - Simulator::Now());
+    return video;
+}
+
+TrafficInstaller
+ProjectScenario::CreateFtpInstaller() const
+{
+    TrafficInstaller ftp("ns3::BulkSendApplication", "ns3::TcpSocketFactory");
+    ftp.SetSystemId(m_systemId);
+    ftp.SetClientAttribute("MaxBytes", UintegerValue(m_params.ftpDataSize));
+    ftp.SetClientAttribute("SendSize", UintegerValue(m_params.ftpPacketSize));
+    ftp.SetStartTime(std::max(Seconds(2.0) - Simulator::Now(), Seconds(0)));
+    ftp.SetStopTime(Seconds(m_params.simTime) - Simulator::Now());
+    return ftp;
+}
+
+} // namespace ns3
@@ -0,0 +1,280 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROJECT_SCENARIO_H
+#define PROJECT_SCENARIO_H
+
+#include "lte-epc-topology.h"
+#include "results-writer.h"
+#include "traffic-installer.h"
+#include "traffic-mix.h"
+#include "ue-layout.h"
+#include "ue-position-store.h"
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-helper.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/// Parameters of the project scenario
+struct ProjectParameters
+{
+    uint16_t numberOfUes{15};        //!< number of UEs
+    uint16_t numberOfEnbs{3};        //!< number of eNBs
+    uint16_t dlBandwidth{75};        //!< eNB downlink bandwidth [RBs]
+    uint16_t upBandwidth{75};        //!< eNB uplink bandwidth [RBs]
+    uint16_t videoPacketSize{1500};  //!< video packet size [B]
+    uint16_t ftpPacketSize{200};     //!< FTP send size [B]
+    uint32_t ftpDataSize{10000000};  //!< FTP transfer size [B]
+    uint32_t videoDataSize{1000000}; //!< video packets per server
+    double simTime{60.0};            //!< simulation duration [s]
+    double interval{20.0};           //!< video inter-packet interval [ms]
+    double distance{300.0};          //!< distance between eNBs [m]
+    double txPower{10};              //!< UE transmission power [dBm]
+    double walkSpeed{2.0};           //!< UE walking speed [m/s]
+    bool useCa{true};                //!< carrier aggregation
+    std::string layout{"line"};      //!< UE layout, see UeLayout
+    uint32_t clusters{0};            //!< hotspots of the "clusters" layout
+    double clusterRadius{50.0};      //!< hotspot radius [m]
+    std::string trafficMix{""};      //!< traffic mix, see TrafficMix; empty for the fixed flows
+    double pathlossCache{0};         //!< path loss cache grid [m], 0 for none
+    bool positionStore{false};       //!< walkers in a UePositionStore
+    double cullThreshold{-1};        //!< interference culling below the noise [dB], < 0 for none
+
+    /**
+     * Register every parameter with the command line, under the names used
+     * by project.cc.
+     *
+     * \param cmd the command line
+     */
+    void AddCommandLineValues(CommandLine& cmd);
+
+    /**
+     * Add every parameter, plus the RNG seed and run, to the results schema.
+     *
+     * \param results the results writer
+     */
+    void AddResultsParameters(ResultsWriter& results) const;
+};
+
+/// A group of UEs placed uniformly in a disc, walking or static
+struct UeGroup
+{
+    std::string name;  //!< group name
+    uint32_t count{0}; //!< number of UEs
+    Vector center;     //!< disc center [m]
+    double radius{50}; //!< disc radius [m]
+    double speed{-1};  //!< walking speed [m/s], 0 for static UEs, < 0 for walkSpeed
+};
+
+/**
+ * A set of flows between two endpoints, installed with a TrafficInstaller.
+ *
+ * Endpoints are "remote" (the remote host), "ue:<list>" with a list of UE
+ * indexes and ranges like "0-2,5" or "*" for all UEs, or "group:<name>" for
+ * the UEs of a UeGroup. As for TrafficInstaller::Install(), either endpoint
+ * may be a single node used for every flow.
+ */
+struct FlowSpec
+{
+    std::string client;        //!< client application TypeId
+    std::string socketFactory; //!< socket factory TypeId of the sinks
+    std::string from;          //!< client endpoint
+    std::string to;            //!< sink endpoint
+    uint16_t port{0};          //!< port of the first flow
+    uint16_t portStep{0};      //!< port increment per flow
+    double start{2.0};         //!< start time [s]
+    double stop{-1};           //!< stop time [s], < 0 for the end of the simulation
+    /// Client attributes, name and value
+    std::vector<std::pair<std::string, std::string>> attributes;
+};
+
+/**
+ * The project scenario: eNBs on a line at 200 + distance * i, UEs walking
+ * randomly in the 150-850 m box, three UDP video servers on the remote host
+ * streaming to UEs 0-2 on port 100 and one BulkSend FTP transfer from UE 4 to
+ * UE 8 on port 21, all applications running from 2 s to the end.
+ *
+ * For larger scenarios the eNBs and UEs can instead be placed on a hexagonal
+ * grid or in hotspots (ProjectParameters::layout), and the flows assigned by a
+ * traffic mix (ProjectParameters::trafficMix): one video stream from the
+ * remote host per video UE, and FTP UEs paired in turn, each first UE of a
+ * pair sending to the second.
+ *
+ * Like LteEpcTopology, a scenario object can build many replications, one per
+ * Build() call after Simulator::Destroy().
+ *
+ * Scenario files (ScenarioFile) can replace the layout by explicit eNB
+ * positions and UE groups, and the video and FTP flows by any list of flows.
+ *
+ * Build() is BuildNetwork() followed by InstallApplications(); the latter can
+ * also be called once the simulation has run for a while, e.g. to install
+ * different traffic into copies of an attached network (project-warmstart).
+ */
+class ProjectScenario
+{
+  public:
+    /// Port of the video flows
+    static const uint16_t VIDEO_PORT = 100;
+    /// Port of the FTP flow
+    static const uint16_t FTP_PORT = 21;
+
+    /**
+     * \param params the scenario parameters
+     */
+    explicit ProjectScenario(const ProjectParameters& params);
+
+    /**
+     * Apply the attribute defaults the parameters need (carrier aggregation).
+     * Call before ConfigStore::ConfigureDefaults() so an input file can still
+     * override them.
+     */
+    void ConfigureDefaults();
+
+    /**
+     * Split the scenario over the ranks of a distributed (MPI) simulation: the
+     * remote host and its video servers go to rank 1, the EPC core and the
+     * radio side (eNBs, UEs, LTE devices, UE applications) stay on rank 0.
+     * The LTE spectrum channel and the zero-delay S1 links cannot be cut, so
+     * the 10 ms backhaul link is the only partition boundary.
+     *
+     * \param systemId the local rank
+     * \param systems the number of ranks, 1 or 2
+     */
+    void SetPartition(uint32_t systemId, uint32_t systems);
+
+    /**
+     * \param positions eNB positions replacing the layout's sites, one per eNB
+     */
+    void SetEnbPositions(const std::vector<Vector>& positions);
+
+    /**
+     * \param groups UE groups replacing the layout's UE positions; their
+     *        counts must add up to the number of UEs
+     */
+    void SetUeGroups(const std::vector<UeGroup>& groups);
+
+    /**
+     * \param flows flows replacing the video and FTP flows
+     */
+    void SetFlows(const std::vector<FlowSpec>& flows);
+
+    /**
+     * Build a replication: topology, mobility, LTE devices, attachment and
+     * applications, the latter three only for the nodes of the local
+     * partition. Simulator::Stop() is left to the caller.
+     */
+    void Build();
+
+    /**
+     * Build everything but the applications: topology, mobility, LTE devices
+     * and attachment.
+     */
+    void BuildNetwork();
+
+    /**
+     * Install the video and FTP applications, running from 2 s to the end of
+     * the simulation, or from now if later than 2 s.
+     */
+    void InstallApplications();
+
+    /// \return the parameters
+    const ProjectParameters& GetParameters() const;
+
+    /**
+     * \return the parameters, of which only the traffic parameters (packet and
+     *         data sizes, interval, traffic mix) may change between
+     *         BuildNetwork() and InstallApplications()
+     */
+    ProjectParameters& GetParameters();
+    /// \return the topology of the current replication
+    LteEpcTopology& GetTopology();
+    /// \return true if the local partition simulates the radio side
+    bool IsRadioLocal() const;
+    /// \return true if the local partition simulates the remote host
+    bool IsRemoteHostLocal() const;
+    /// \return the video servers and sinks
+    ApplicationContainer GetVideoApplications() const;
+    /// \return the FTP sender and sink
+    ApplicationContainer GetFtpApplications() const;
+    /// \return the applications of the flows set by SetFlows()
+    ApplicationContainer GetFlowApplications() const;
+    /// \return the store of the walking UEs, or nullptr without positionStore
+    Ptr<UePositionStore> GetPositionStore() const;
+
+  private:
+    /// Place the core nodes, the eNBs and the walking UEs
+    void InstallMobility();
+
+    /// Wrap the LteHelper's path loss model in a CachedPropagationLossModel
+    void InstallPathlossCache();
+
+    /// Make the LteHelper's spectrum channels CulledSpectrumChannels
+    void InstallInterferenceCulling();
+
+    /**
+     * Place the UEs of the groups.
+     *
+     * \param mobility the helper, with the eNBs' settings
+     */
+    void InstallUeGroups(MobilityHelper& mobility);
+
+    /// Install the flows set by SetFlows()
+    void InstallFlows();
+
+    /**
+     * \param endpoint "remote", "ue:<list>" or "group:<name>"
+     * \param nodes receives the endpoint's nodes
+     * \param addresses receives their addresses
+     */
+    void ResolveEndpoint(const std::string& endpoint,
+                         NodeContainer& nodes,
+                         std::vector<Ipv4Address>& addresses) const;
+
+    /**
+     * Install the video and FTP applications of the traffic mix.
+     *
+     * \param video installer of the video flows
+     * \param ftp installer of the FTP flows
+     */
+    void InstallTrafficMix(TrafficInstaller& video, TrafficInstaller& ftp);
+
+    /// \return an installer of video flows, from 2 s to the end
+    TrafficInstaller CreateVideoInstaller() const;
+    /// \return an installer of FTP flows, from 2 s to the end
+    TrafficInstaller CreateFtpInstaller() const;
+
+    ProjectParameters m_params;         //!< parameters
+    LteEpcTopology m_topology;          //!< topology builder
+    uint32_t m_systemId;                //!< local rank
+    uint32_t m_systems;                 //!< number of ranks
+    ApplicationContainer m_video;       //!< video applications
+    ApplicationContainer m_ftp;         //!< FTP applications
+    ApplicationContainer m_flows;       //!< applications of m_flowSpecs
+    std::vector<Vector> m_enbPositions; //!< explicit eNB positions
+    std::vector<UeGroup> m_ueGroups;    //!< UE groups
+    std::vector<FlowSpec> m_flowSpecs;  //!< explicit flows
+    Ptr<UePositionStore> m_positions;   //!< walkers, with positionStore
+};
+
+} // namespace ns3
+
+#endif /* PROJECT_SCENARIO_H */
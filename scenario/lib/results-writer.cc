@@ -0,0 +1,402 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "results-writer.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <iomanip>
+#include <limits>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The binary results format is little-endian and written in host byte order"
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ResultsWriter");
+
+FlowRecord
+MakeFlowRecord(FlowId flowId,
+               const Ipv4FlowClassifier::FiveTuple& t,
+               const FlowMonitor::FlowStats& stats)
+{
+    FlowRecord r;
+    r.flowId = flowId;
+    r.srcAddress = t.sourceAddress;
+    r.srcPort = t.sourcePort;
+    r.dstAddress = t.destinationAddress;
+    r.dstPort = t.destinationPort;
+    r.protocol = t.protocol;
+    r.txPackets = stats.txPackets;
+    r.rxPackets = stats.rxPackets;
+    r.txBytes = stats.txBytes;
+    r.rxBytes = stats.rxBytes;
+    double duration = stats.timeLastRxPacket.GetSeconds() - stats.timeFirstTxPacket.GetSeconds();
+    if (duration > 0)
+    {
+        r.throughputKbps = stats.rxBytes * 8.0 / duration / 1024;
+    }
+    if (stats.rxPackets > 0)
+    {
+        r.meanDelayMs = stats.delaySum.GetSeconds() / stats.rxPackets * 1000;
+    }
+    if (stats.rxPackets > 1)
+    {
+        r.meanJitterMs = stats.jitterSum.GetSeconds() / (stats.rxPackets - 1) * 1000;
+    }
+    r.lostPackets = stats.txPackets - stats.rxPackets;
+    if (stats.txPackets > 0)
+    {
+        r.lossPercent = r.lostPackets * 100.0 / stats.txPackets;
+    }
+    return r;
+}
+
+ResultsWriter::Format
+ResultsWriter::ParseFormat(const std::string& name)
+{
+    if (name == "binary")
+    {
+        return BINARY;
+    }
+    if (name == "csv")
+    {
+        return CSV;
+    }
+    NS_FATAL_ERROR("Unknown results format " << name << ", use binary or csv");
+}
+
+ResultsWriter::ResultsWriter()
+    : m_format(BINARY),
+      m_chunkRows(65536),
+      m_open(false)
+{
+    m_flows.id = 1;
+    m_flows.name = "flows";
+    m_flows.columns = {{"flowId", UINT32, {}},
+                       {"srcAddress", IPV4, {}},
+                       {"srcPort", UINT32, {}},
+                       {"dstAddress", IPV4, {}},
+                       {"dstPort", UINT32, {}},
+                       {"protocol", UINT32, {}},
+                       {"txPackets", UINT64, {}},
+                       {"rxPackets", UINT64, {}},
+                       {"txBytes", UINT64, {}},
+                       {"rxBytes", UINT64, {}},
+                       {"throughputKbps", DOUBLE, {}},
+                       {"meanDelayMs", DOUBLE, {}},
+                       {"meanJitterMs", DOUBLE, {}},
+                       {"lostPackets", UINT64, {}},
+                       {"lossPercent", DOUBLE, {}}};
+
+    m_intervals.id = 2;
+    m_intervals.name = "intervals";
+    m_intervals.columns = {{"time", DOUBLE, {}},
+                           {"flowId", UINT32, {}},
+                           {"txPackets", UINT64, {}},
+                           {"rxPackets", UINT64, {}},
+                           {"rxBytes", UINT64, {}},
+                           {"throughputKbps", DOUBLE, {}},
+                           {"meanDelayMs", DOUBLE, {}},
+                           {"meanJitterMs", DOUBLE, {}},
+                           {"lostPackets", UINT64, {}}};
+}
+
+ResultsWriter::~ResultsWriter()
+{
+    Close();
+}
+
+void
+ResultsWriter::SetFormat(Format format)
+{
+    NS_ABORT_MSG_IF(m_open, "The format must be set before Open()");
+    m_format = format;
+}
+
+void
+ResultsWriter::SetChunkRows(uint32_t rows)
+{
+    NS_ABORT_MSG_IF(rows == 0, "A chunk needs at least one row");
+    m_chunkRows = rows;
+}
+
+void
+ResultsWriter::Open(const std::string& prefix)
+{
+    NS_LOG_FUNCTION(this << prefix);
+    NS_ABORT_MSG_IF(m_open, "Results already open");
+    m_open = true;
+
+    if (m_format == CSV)
+    {
+        std::string header;
+        m_csvPrefix.clear();
+        for (const auto& [name, value] : m_parameters)
+        {
+            header += name + ",";
+            m_csvPrefix += value + ",";
+        }
+        for (Table* table : {&m_flows, &m_intervals})
+        {
+            std::string filename = prefix + "-" + table->name + ".csv";
+            table->csv.open(filename);
+            NS_ABORT_MSG_IF(!table->csv.is_open(), "Cannot open " << filename);
+            // As many digits as the binary format keeps
+            table->csv << std::setprecision(std::numeric_limits<double>::max_digits10);
+            table->csv << header;
+            for (std::size_t c = 0; c < table->columns.size(); c++)
+            {
+                table->csv << (c > 0 ? "," : "") << table->columns[c].name;
+            }
+            table->csv << "\n";
+        }
+        return;
+    }
+
+    std::string filename = prefix + ".kpmr";
+    m_file.open(filename, std::ios::binary);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Cannot open " << filename);
+
+    const uint32_t version = 1;
+    m_file.write("KPMR", 4);
+    m_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+
+    uint32_t n = m_parameters.size();
+    m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    for (const auto& [name, value] : m_parameters)
+    {
+        WriteString(name);
+        WriteString(value);
+    }
+
+    n = 2;
+    m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    for (const Table* table : {&m_flows, &m_intervals})
+    {
+        m_file.write(reinterpret_cast<const char*>(&table->id), sizeof(table->id));
+        WriteString(table->name);
+        n = table->columns.size();
+        m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (const auto& column : table->columns)
+        {
+            WriteString(column.name);
+            m_file.write(reinterpret_cast<const char*>(&column.type), sizeof(column.type));
+        }
+    }
+}
+
+bool
+ResultsWriter::IsOpen() const
+{
+    return m_open;
+}
+
+template <typename T>
+void
+ResultsWriter::Put(Table& table, T value)
+{
+    NS_ASSERT(table.cursor < table.columns.size());
+    Column& column = table.columns[table.cursor++];
+    switch (column.type)
+    {
+    case UINT32:
+    case IPV4: {
+        uint32_t v = static_cast<uint32_t>(value);
+        column.data.insert(column.data.end(),
+                           reinterpret_cast<const char*>(&v),
+                           reinterpret_cast<const char*>(&v) + sizeof(v));
+        break;
+    }
+    case UINT64: {
+        uint64_t v = static_cast<uint64_t>(value);
+        column.data.insert(column.data.end(),
+                           reinterpret_cast<const char*>(&v),
+                           reinterpret_cast<const char*>(&v) + sizeof(v));
+        break;
+    }
+    case DOUBLE: {
+        double v = static_cast<double>(value);
+        column.data.insert(column.data.end(),
+                           reinterpret_cast<const char*>(&v),
+                           reinterpret_cast<const char*>(&v) + sizeof(v));
+        break;
+    }
+    }
+}
+
+void
+ResultsWriter::Write(const FlowRecord& r)
+{
+    if (!m_open)
+    {
+        return;
+    }
+    Put(m_flows, r.flowId);
+    Put(m_flows, r.srcAddress.Get());
+    Put(m_flows, r.srcPort);
+    Put(m_flows, r.dstAddress.Get());
+    Put(m_flows, r.dstPort);
+    Put(m_flows, r.protocol);
+    Put(m_flows, r.txPackets);
+    Put(m_flows, r.rxPackets);
+    Put(m_flows, r.txBytes);
+    Put(m_flows, r.rxBytes);
+    Put(m_flows, r.throughputKbps);
+    Put(m_flows, r.meanDelayMs);
+    Put(m_flows, r.meanJitterMs);
+    Put(m_flows, r.lostPackets);
+    Put(m_flows, r.lossPercent);
+    EndRow(m_flows);
+}
+
+void
+ResultsWriter::Write(const FlowIntervalRecord& r)
+{
+    if (!m_open)
+    {
+        return;
+    }
+    Put(m_intervals, r.time);
+    Put(m_intervals, r.flowId);
+    Put(m_intervals, r.txPackets);
+    Put(m_intervals, r.rxPackets);
+    Put(m_intervals, r.rxBytes);
+    Put(m_intervals, r.throughputKbps);
+    Put(m_intervals, r.meanDelayMs);
+    Put(m_intervals, r.meanJitterMs);
+    Put(m_intervals, r.lostPackets);
+    EndRow(m_intervals);
+}
+
+void
+ResultsWriter::Close()
+{
+    if (!m_open)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+
+    for (Table* table : {&m_flows, &m_intervals})
+    {
+        WriteChunk(*table);
+        if (table->csv.is_open())
+        {
+            table->csv.close();
+        }
+    }
+    if (m_file.is_open())
+    {
+        const uint8_t end = 0;
+        m_file.write(reinterpret_cast<const char*>(&end), sizeof(end));
+        m_file.close();
+    }
+    m_open = false;
+}
+
+void
+ResultsWriter::EndRow(Table& table)
+{
+    NS_ASSERT_MSG(table.cursor == table.columns.size(), "Incomplete row in " << table.name);
+    table.cursor = 0;
+    table.rows++;
+    if (table.rows >= m_chunkRows)
+    {
+        WriteChunk(table);
+    }
+}
+
+void
+ResultsWriter::WriteChunk(Table& table)
+{
+    if (table.rows == 0 || !m_open)
+    {
+        return;
+    }
+
+    if (m_format == BINARY)
+    {
+        m_file.write(reinterpret_cast<const char*>(&table.id), sizeof(table.id));
+        m_file.write(reinterpret_cast<const char*>(&table.rows), sizeof(table.rows));
+        for (const auto& column : table.columns)
+        {
+            m_file.write(column.data.data(), column.data.size());
+        }
+    }
+    else
+    {
+        for (uint32_t row = 0; row < table.rows; row++)
+        {
+            table.csv << m_csvPrefix;
+            for (std::size_t c = 0; c < table.columns.size(); c++)
+            {
+                const Column& column = table.columns[c];
+                if (c > 0)
+                {
+                    table.csv << ",";
+                }
+                switch (column.type)
+                {
+                case UINT32: {
+                    uint32_t v;
+                    std::memcpy(&v, column.data.data() + row * sizeof(v), sizeof(v));
+                    table.csv << v;
+                    break;
+                }
+                case IPV4: {
+                    uint32_t v;
+                    std::memcpy(&v, column.data.data() + row * sizeof(v), sizeof(v));
+                    table.csv << Ipv4Address(v);
+                    break;
+                }
+                case UINT64: {
+                    uint64_t v;
+                    std::memcpy(&v, column.data.data() + row * sizeof(v), sizeof(v));
+                    table.csv << v;
+                    break;
+                }
+                case DOUBLE: {
+                    double v;
+                    std::memcpy(&v, column.data.data() + row * sizeof(v), sizeof(v));
+                    table.csv << v;
+                    break;
+                }
+                }
+            }
+            table.csv << "\n";
+        }
+    }
+
+    for (auto& column : table.columns)
+    {
+        column.data.clear();
+    }
+    table.rows = 0;
+}
+
+void
+ResultsWriter::WriteString(const std::string& s)
+{
+    uint32_t length = s.size();
+    m_file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    m_file.write(s.data(), length);
+}
+
+} // namespace ns3
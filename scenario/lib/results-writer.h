@@ -0,0 +1,248 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RESULTS_WRITER_H
+#define RESULTS_WRITER_H
+
+#include "ns3/flow-monitor-module.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Totals of one flow over a whole run
+struct FlowRecord
+{
+    uint32_t flowId{0};       //!< flow id
+    Ipv4Address srcAddress;   //!< source address
+    uint16_t srcPort{0};      //!< source port
+    Ipv4Address dstAddress;   //!< destination address
+    uint16_t dstPort{0};      //!< destination port
+    uint8_t protocol{0};      //!< IP protocol number
+    uint64_t txPackets{0};    //!< transmitted packets
+    uint64_t rxPackets{0};    //!< received packets
+    uint64_t txBytes{0};      //!< transmitted bytes
+    uint64_t rxBytes{0};      //!< received bytes
+    double throughputKbps{0}; //!< rx throughput between first tx and last rx [kb/s]
+    double meanDelayMs{0};    //!< mean delay [ms]
+    double meanJitterMs{0};   //!< mean jitter [ms]
+    uint64_t lostPackets{0};  //!< tx - rx packets
+    double lossPercent{0};    //!< lost packets over tx packets [%]
+};
+
+/// Change of one flow between two samples
+struct FlowIntervalRecord
+{
+    double time{0};           //!< end of the interval [s]
+    uint32_t flowId{0};       //!< flow id
+    uint64_t txPackets{0};    //!< transmitted packets
+    uint64_t rxPackets{0};    //!< received packets
+    uint64_t rxBytes{0};      //!< received bytes
+    double throughputKbps{0}; //!< rx throughput over the interval [kb/s]
+    double meanDelayMs{0};    //!< mean delay [ms]
+    double meanJitterMs{0};   //!< mean jitter [ms]
+    uint64_t lostPackets{0};  //!< packets declared lost by the monitor
+};
+
+/**
+ * Compute the totals of a flow the way the project scenarios print them.
+ *
+ * \param flowId the flow
+ * \param t the five-tuple of the flow
+ * \param stats the monitor statistics of the flow
+ * \return the record
+ */
+FlowRecord MakeFlowRecord(FlowId flowId,
+                          const Ipv4FlowClassifier::FiveTuple& t,
+                          const FlowMonitor::FlowStats& stats);
+
+/**
+ * Writes the results of a run: a "flows" table with one FlowRecord per flow and
+ * an "intervals" table with the FlowIntervalRecord rows of a FlowStatsSampler,
+ * both tagged with the parameters of the run.
+ *
+ * Rows are buffered per column and written in chunks, never flushed line by
+ * line. Rows written while the writer is not open are dropped. Two formats are
+ * supported:
+ *
+ * - BINARY, one self-describing columnar file <prefix>.kpmr. Numbers are
+ *   written as they are in memory, so the format is little-endian and the
+ *   writer builds on little-endian hosts only. Strings are uint32 length + bytes:
+ *   \verbatim
+     "KPMR" uint32 version (1)
+     uint32 parameters, then per parameter: string name, string value
+     uint32 tables, then per table: uint8 id, string name, uint32 columns,
+            then per column: string name, uint8 type (0 uint32, 1 uint64, 2 double,
+            3 IPv4 address as uint32)
+     chunks: uint8 table id, uint32 rows,
+            then per column all the values of the chunk's rows
+     uint8 0, the end marker written by Close()
+     \endverbatim
+ *   A file without the end marker is from a run that did not complete.
+ * - CSV, <prefix>-flows.csv and <prefix>-intervals.csv, with every parameter
+ *   repeated as a leading column so files of several runs can be concatenated;
+ *   doubles are written with max_digits10 digits, so they read back exactly.
+ */
+class ResultsWriter
+{
+  public:
+    /// Output formats
+    enum Format
+    {
+        BINARY,
+        CSV
+    };
+
+    /**
+     * \param name "binary" or "csv"
+     * \return the format
+     */
+    static Format ParseFormat(const std::string& name);
+
+    ResultsWriter();
+    ~ResultsWriter();
+
+    /**
+     * \param format the output format
+     */
+    void SetFormat(Format format);
+
+    /**
+     * \param rows number of buffered rows per table before a chunk is written
+     */
+    void SetChunkRows(uint32_t rows);
+
+    /**
+     * Add a run parameter to the schema; must be called before Open().
+     *
+     * \param name the parameter name
+     * \param value the parameter value
+     */
+    template <typename T>
+    void AddParameter(const std::string& name, const T& value);
+
+    /**
+     * Create the output file(s).
+     *
+     * \param prefix the output path without extension
+     */
+    void Open(const std::string& prefix);
+
+    /// \return true between Open() and Close()
+    bool IsOpen() const;
+
+    /**
+     * Add a row to the flows table; does nothing unless the writer is open.
+     *
+     * \param record a row of the flows table
+     */
+    void Write(const FlowRecord& record);
+
+    /**
+     * Add a row to the intervals table; does nothing unless the writer is open.
+     *
+     * \param record a row of the intervals table
+     */
+    void Write(const FlowIntervalRecord& record);
+
+    /**
+     * Write the buffered rows and, in the binary format, the end marker, and
+     * close the output file(s).
+     */
+    void Close();
+
+  private:
+    /// Column value types, as stored in the binary format
+    enum ColumnType : uint8_t
+    {
+        UINT32 = 0,
+        UINT64 = 1,
+        DOUBLE = 2,
+        IPV4 = 3
+    };
+
+    /// Buffered values of one column
+    struct Column
+    {
+        std::string name;       //!< column name
+        ColumnType type;        //!< value type
+        std::vector<char> data; //!< values of the buffered rows
+    };
+
+    /// A table of the output
+    struct Table
+    {
+        uint8_t id;                  //!< table id in the binary format
+        std::string name;            //!< table name
+        std::vector<Column> columns; //!< columns
+        uint32_t rows{0};            //!< buffered rows
+        std::size_t cursor{0};       //!< next column of the current row
+        std::ofstream csv;           //!< CSV output
+    };
+
+    /**
+     * Append a value to the next column of the current row.
+     *
+     * \param table the table
+     * \param value the value, converted to the column type
+     */
+    template <typename T>
+    void Put(Table& table, T value);
+
+    /**
+     * Complete the current row, writing a chunk when enough rows are buffered.
+     *
+     * \param table the table
+     */
+    void EndRow(Table& table);
+
+    /**
+     * Write the buffered rows of a table.
+     *
+     * \param table the table
+     */
+    void WriteChunk(Table& table);
+
+    /**
+     * \param s the string to write in the binary format
+     */
+    void WriteString(const std::string& s);
+
+    Format m_format;                                               //!< output format
+    uint32_t m_chunkRows;                                          //!< rows per chunk
+    std::vector<std::pair<std::string, std::string>> m_parameters; //!< run parameters
+    std::string m_csvPrefix;                                       //!< CSV row prefix
+    std::ofstream m_file;                                          //!< binary output
+    bool m_open;                                                   //!< Open() was called
+    Table m_flows;                                                 //!< flows table
+    Table m_intervals;                                             //!< intervals table
+};
+
+template <typename T>
+void
+ResultsWriter::AddParameter(const std::string& name, const T& value)
+{
+    std::ostringstream oss;
+    oss << value;
+    m_parameters.emplace_back(name, oss.str());
+}
+
+} // namespace ns3
+
+#endif /* RESULTS_WRITER_H */
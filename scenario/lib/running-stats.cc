@@ -0,0 +1,98 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "running-stats.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+namespace
+{
+
+/**
+ * \param df degrees of freedom
+ * \return the 97.5% quantile of the Student t distribution
+ */
+double
+StudentT975(uint32_t df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                   2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                   2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df <= 30)
+    {
+        return table[df - 1];
+    }
+    // Within 0.002 of the exact quantile above 30 degrees of freedom
+    return 1.960 + 2.5 / df;
+}
+
+} // namespace
+
+RunningStats::RunningStats()
+    : m_count(0),
+      m_mean(0),
+      m_m2(0)
+{
+}
+
+void
+RunningStats::Add(double x)
+{
+    m_count++;
+    double delta = x - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (x - m_mean);
+}
+
+uint32_t
+RunningStats::GetCount() const
+{
+    return m_count;
+}
+
+double
+RunningStats::GetMean() const
+{
+    return m_mean;
+}
+
+double
+RunningStats::GetStddev() const
+{
+    return m_count < 2 ? 0 : std::sqrt(m_m2 / (m_count - 1));
+}
+
+double
+RunningStats::GetConfidenceHalfWidth() const
+{
+    return m_count < 2 ? 0 : StudentT975(m_count - 1) * GetStddev() / std::sqrt(m_count);
+}
+
+double
+RunningStats::GetRelativePrecision() const
+{
+    if (m_count < 2 || m_mean == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return GetConfidenceHalfWidth() / std::fabs(m_mean);
+}
+
+} // namespace ns3
@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <cstdint>
+
+namespace ns3
+{
+
+/**
+ * Mean, standard deviation and 95% confidence interval of a series of
+ * independent samples (batch means, replications), updated one sample at a
+ * time with Welford's algorithm.
+ */
+class RunningStats
+{
+  public:
+    RunningStats();
+
+    /**
+     * \param x a sample
+     */
+    void Add(double x);
+
+    /// \return the number of samples
+    uint32_t GetCount() const;
+    /// \return the mean
+    double GetMean() const;
+    /// \return the sample standard deviation, 0 below two samples
+    double GetStddev() const;
+
+    /**
+     * Student-t half-width of the two-sided 95% confidence interval of the mean.
+     *
+     * \return the half-width, 0 below two samples
+     */
+    double GetConfidenceHalfWidth() const;
+
+    /**
+     * \return the half-width relative to the absolute mean, infinite below two
+     *         samples or for a zero mean
+     */
+    double GetRelativePrecision() const;
+
+  private:
+    uint32_t m_count; //!< samples
+    double m_mean;    //!< running mean
+    double m_m2;      //!< sum of squared deviations from the mean
+};
+
+} // namespace ns3
+
+#endif /* RUNNING_STATS_H */
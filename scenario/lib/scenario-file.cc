@@ -0,0 +1,396 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "scenario-file.h"
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/log.h"
+#include "ns3/type-id.h"
+
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ScenarioFile");
+
+namespace
+{
+
+/**
+ * \param s a string
+ * \return the string without leading and trailing white space
+ */
+std::string
+Trim(const std::string& s)
+{
+    std::size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    std::size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+/**
+ * \param text a number
+ * \param value receives the number
+ * \return whether the whole text is a number
+ */
+bool
+ParseDouble(const std::string& text, double& value)
+{
+    std::istringstream in(text);
+    in >> value;
+    return !in.fail() && in.eof();
+}
+
+/**
+ * \param text an unsigned number
+ * \param max largest allowed value
+ * \param value receives the number
+ * \return whether the whole text is a number up to max
+ */
+bool
+ParseUnsigned(const std::string& text, uint64_t max, uint64_t& value)
+{
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+    std::istringstream in(text);
+    in >> value;
+    return !in.fail() && value <= max;
+}
+
+/**
+ * \param endpoint a flow endpoint
+ * \return whether it has the form of FlowSpec endpoints
+ */
+bool
+IsEndpoint(const std::string& endpoint)
+{
+    if (endpoint == "remote")
+    {
+        return true;
+    }
+    if (endpoint.rfind("group:", 0) == 0)
+    {
+        return endpoint.size() > 6;
+    }
+    if (endpoint.rfind("ue:", 0) == 0)
+    {
+        return endpoint.size() > 3 &&
+               endpoint.find_first_not_of("0123456789,-*", 3) == std::string::npos;
+    }
+    return false;
+}
+
+} // namespace
+
+ScenarioFile::ScenarioFile()
+    : m_line(0)
+{
+}
+
+std::string
+ScenarioFile::Where() const
+{
+    return m_filename + ":" + std::to_string(m_line) + ": ";
+}
+
+void
+ScenarioFile::Load(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ifstream in(filename);
+    NS_ABORT_MSG_IF(!in.is_open(), "Cannot open " << filename);
+    m_filename = filename;
+    m_line = 0;
+
+    std::string section;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        m_line++;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            continue;
+        }
+        if (line.front() == '[')
+        {
+            NS_ABORT_MSG_IF(line.back() != ']', Where() << "Expected [section]");
+            section = Trim(line.substr(1, line.size() - 2));
+            NS_ABORT_MSG_IF(section != "parameters" && section != "enbs" && section != "ues" &&
+                                section != "flows",
+                            Where() << "Unknown section [" << section
+                                    << "], use parameters, enbs, ues or flows");
+            continue;
+        }
+        NS_ABORT_MSG_IF(section.empty(), Where() << "Line outside of a section");
+        if (section == "parameters")
+        {
+            ParseParameter(line);
+        }
+        else if (section == "enbs")
+        {
+            ParseEnb(line);
+        }
+        else if (section == "ues")
+        {
+            ParseUeGroup(line);
+        }
+        else
+        {
+            ParseFlow(line);
+        }
+    }
+    NS_LOG_INFO(filename << ": " << m_parameters.size() << " parameters, " << m_enbs.size()
+                         << " eNBs, " << m_ueGroups.size() << " UE groups, " << m_flows.size()
+                         << " flows");
+}
+
+bool
+ScenarioFile::IsLoaded() const
+{
+    return !m_filename.empty();
+}
+
+void
+ScenarioFile::ParseParameter(const std::string& line)
+{
+    std::size_t eq = line.find('=');
+    NS_ABORT_MSG_IF(eq == std::string::npos, Where() << "Expected name = value");
+    std::string name = Trim(line.substr(0, eq));
+    std::string value = Trim(line.substr(eq + 1));
+    NS_ABORT_MSG_IF(name.empty(), Where() << "Missing parameter name");
+    NS_ABORT_MSG_IF(name == "scenario", Where() << "A scenario file cannot load another one");
+    m_parameters.emplace_back(name, value);
+}
+
+void
+ScenarioFile::ParseEnb(const std::string& line)
+{
+    std::istringstream in(line);
+    std::vector<double> coordinates;
+    std::string token;
+    while (in >> token)
+    {
+        double value;
+        NS_ABORT_MSG_IF(!ParseDouble(token, value), Where() << "Bad coordinate " << token);
+        coordinates.push_back(value);
+    }
+    NS_ABORT_MSG_IF(coordinates.size() < 2 || coordinates.size() > 3,
+                    Where() << "Expected x y [z]");
+    double z = coordinates.size() > 2 ? coordinates[2] : 0;
+    m_enbs.emplace_back(coordinates[0], coordinates[1], z);
+}
+
+void
+ScenarioFile::ParseUeGroup(const std::string& line)
+{
+    std::istringstream in(line);
+    UeGroup group;
+    in >> group.name;
+    NS_ABORT_MSG_IF(group.name.find('=') != std::string::npos,
+                    Where() << "A UE group starts with its name");
+    for (const auto& existing : m_ueGroups)
+    {
+        NS_ABORT_MSG_IF(existing.name == group.name,
+                        Where() << "Duplicate UE group " << group.name);
+    }
+
+    bool hasCenter = false;
+    std::string token;
+    while (in >> token)
+    {
+        std::size_t eq = token.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, Where() << "Expected key=value, got " << token);
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        uint64_t count;
+        if (key == "count")
+        {
+            NS_ABORT_MSG_IF(!ParseUnsigned(value, std::numeric_limits<uint16_t>::max(), count) ||
+                                count == 0,
+                            Where() << "Bad UE count " << value);
+            group.count = count;
+        }
+        else if (key == "center")
+        {
+            std::size_t comma = value.find(',');
+            NS_ABORT_MSG_IF(comma == std::string::npos ||
+                                !ParseDouble(value.substr(0, comma), group.center.x) ||
+                                !ParseDouble(value.substr(comma + 1), group.center.y),
+                            Where() << "Expected center=x,y, got " << value);
+            hasCenter = true;
+        }
+        else if (key == "radius")
+        {
+            NS_ABORT_MSG_IF(!ParseDouble(value, group.radius) || group.radius <= 0,
+                            Where() << "Bad radius " << value);
+        }
+        else if (key == "speed")
+        {
+            NS_ABORT_MSG_IF(!ParseDouble(value, group.speed) || group.speed < 0,
+                            Where() << "Bad speed " << value);
+        }
+        else
+        {
+            NS_FATAL_ERROR(Where() << "Unknown UE group key " << key
+                                   << ", use count, center, radius or speed");
+        }
+    }
+    NS_ABORT_MSG_IF(group.count == 0, Where() << "UE group " << group.name << " needs a count");
+    NS_ABORT_MSG_IF(!hasCenter, Where() << "UE group " << group.name << " needs a center");
+    m_ueGroups.push_back(group);
+}
+
+void
+ScenarioFile::ParseFlow(const std::string& line)
+{
+    std::istringstream in(line);
+    std::string type;
+    in >> type;
+    FlowSpec flow;
+    std::string socket;
+    if (type == "udp")
+    {
+        flow.client = "ns3::UdpClient";
+        socket = "udp";
+    }
+    else if (type == "bulk")
+    {
+        flow.client = "ns3::BulkSendApplication";
+        socket = "tcp";
+    }
+    else
+    {
+        TypeId tid;
+        NS_ABORT_MSG_IF(!TypeId::LookupByNameFailSafe(type, &tid) ||
+                            !tid.IsChildOf(Application::GetTypeId()),
+                        Where() << "Unknown flow type " << type
+                                << ", use udp, bulk or an application TypeId");
+        flow.client = type;
+    }
+
+    bool hasPort = false;
+    std::string token;
+    while (in >> token)
+    {
+        std::size_t eq = token.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, Where() << "Expected key=value, got " << token);
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        uint64_t number;
+        if (key == "from" || key == "to")
+        {
+            NS_ABORT_MSG_IF(!IsEndpoint(value),
+                            Where() << "Bad endpoint " << value
+                                    << ", use remote, ue:<list> or group:<name>");
+            (key == "from" ? flow.from : flow.to) = value;
+        }
+        else if (key == "port" || key == "portStep")
+        {
+            NS_ABORT_MSG_IF(!ParseUnsigned(value, std::numeric_limits<uint16_t>::max(), number),
+                            Where() << "Bad " << key << " " << value);
+            (key == "port" ? flow.port : flow.portStep) = number;
+            hasPort = hasPort || key == "port";
+        }
+        else if (key == "start" || key == "stop")
+        {
+            double seconds;
+            NS_ABORT_MSG_IF(!ParseDouble(value, seconds) || seconds < 0,
+                            Where() << "Bad " << key << " time " << value << " [s]");
+            (key == "start" ? flow.start : flow.stop) = seconds;
+        }
+        else if (key == "socket")
+        {
+            NS_ABORT_MSG_IF(value != "udp" && value != "tcp",
+                            Where() << "Bad socket " << value << ", use udp or tcp");
+            socket = value;
+        }
+        else if (!key.empty() && std::isupper(key[0]))
+        {
+            flow.attributes.emplace_back(key, value);
+        }
+        else
+        {
+            NS_FATAL_ERROR(Where() << "Unknown flow key " << key
+                                   << ", use from, to, port, portStep, start, stop, socket or"
+                                      " a client attribute");
+        }
+    }
+    NS_ABORT_MSG_IF(flow.from.empty() || flow.to.empty(), Where() << "A flow needs from and to");
+    NS_ABORT_MSG_IF(!hasPort, Where() << "A flow needs a port");
+    NS_ABORT_MSG_IF(socket.empty(), Where() << "Flows of " << type << " need socket=udp|tcp");
+    NS_ABORT_MSG_IF(flow.stop >= 0 && flow.stop <= flow.start,
+                    Where() << "The flow stops before it starts");
+    flow.socketFactory = socket == "udp" ? "ns3::UdpSocketFactory" : "ns3::TcpSocketFactory";
+    m_flows.push_back(flow);
+}
+
+const std::vector<FlowSpec>&
+ScenarioFile::GetFlows() const
+{
+    return m_flows;
+}
+
+std::vector<std::string>
+ScenarioFile::GetArguments(const std::string& program) const
+{
+    std::vector<std::string> args{program};
+    for (const auto& [name, value] : m_parameters)
+    {
+        args.push_back("--" + name + "=" + value);
+    }
+    return args;
+}
+
+void
+ScenarioFile::Apply(ProjectParameters& params) const
+{
+    if (!m_enbs.empty())
+    {
+        params.numberOfEnbs = m_enbs.size();
+    }
+    if (!m_ueGroups.empty())
+    {
+        uint32_t ues = 0;
+        for (const auto& group : m_ueGroups)
+        {
+            ues += group.count;
+        }
+        NS_ABORT_MSG_IF(ues > std::numeric_limits<uint16_t>::max(),
+                        m_filename << ": " << ues << " UEs are too many");
+        params.numberOfUes = ues;
+    }
+}
+
+void
+ScenarioFile::Configure(ProjectScenario& scenario) const
+{
+    scenario.SetEnbPositions(m_enbs);
+    scenario.SetUeGroups(m_ueGroups);
+    scenario.SetFlows(m_flows);
+}
+
+} // namespace ns3
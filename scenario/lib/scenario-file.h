@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCENARIO_FILE_H
+#define SCENARIO_FILE_H
+
+#include "project-scenario.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * A project scenario described in a text file, loaded at startup so that a
+ * prebuilt project binary runs any topology and flow mix.
+ *
+ * The file has up to four sections; '#' starts a comment:
+ *
+ * \verbatim
+   [parameters]
+   # any command line option of the program, e.g. ProjectParameters, output
+   # options and ns-3 attribute defaults; the real command line still wins
+   simTime = 30
+   animation = off
+   ns3::LteEnbRrc::SrsPeriodicity = 80
+
+   [enbs]
+   # one eNB per line: x y [z], replaces numberOfEnbs and the layout's sites
+   200 500
+   800 500
+
+   [ues]
+   # one group per line: name count=N center=x,y radius=R [speed=S]
+   # replaces numberOfUes and the layout's UE positions; speed 0 is static,
+   # no speed walks at walkSpeed
+   mall count=20 center=300,500 radius=60 speed=0
+   street count=10 center=700,500 radius=200
+
+   [flows]
+   # one flow set per line: type from=<endpoint> to=<endpoint> port=P
+   #   [portStep=S] [start=s] [stop=s] [Attribute=value ...]
+   # type is udp (UdpClient to UDP sinks), bulk (BulkSendApplication to TCP
+   # sinks) or a client TypeId with socket=udp|tcp; capitalised keys are
+   # attributes of the client. Replaces the video and FTP flows.
+   udp from=remote to=group:mall port=100 Interval=20ms PacketSize=1500
+   bulk from=ue:0 to=ue:25 port=21 SendSize=200 MaxBytes=10000000
+   \endverbatim
+ *
+ * Endpoints are described with FlowSpec. Errors are reported with the file
+ * name and line.
+ *
+ * \code
+ *   ScenarioFile file;
+ *   file.Load("mall.scenario");
+ *   cmd.Parse(file.GetArguments(argv[0]));
+ *   cmd.Parse(argc, argv);
+ *   file.Apply(params);
+ *   ProjectScenario scenario(params);
+ *   file.Configure(scenario);
+ * \endcode
+ */
+class ScenarioFile
+{
+  public:
+    ScenarioFile();
+
+    /**
+     * \param filename the scenario file
+     */
+    void Load(const std::string& filename);
+
+    /// \return true once a file was loaded
+    bool IsLoaded() const;
+
+    /**
+     * \param program the program name, first of the arguments
+     * \return the [parameters] as command line arguments for CommandLine::Parse()
+     */
+    std::vector<std::string> GetArguments(const std::string& program) const;
+
+    /// \return the flows of the [flows] section
+    const std::vector<FlowSpec>& GetFlows() const;
+
+    /**
+     * Set the number of eNBs and UEs of the [enbs] and [ues] sections.
+     *
+     * \param params the parameters
+     */
+    void Apply(ProjectParameters& params) const;
+
+    /**
+     * Hand the eNB positions, UE groups and flows to the scenario.
+     *
+     * \param scenario the scenario
+     */
+    void Configure(ProjectScenario& scenario) const;
+
+  private:
+    /**
+     * \param line a line of the [parameters] section
+     */
+    void ParseParameter(const std::string& line);
+
+    /**
+     * \param line a line of the [enbs] section
+     */
+    void ParseEnb(const std::string& line);
+
+    /**
+     * \param line a line of the [ues] section
+     */
+    void ParseUeGroup(const std::string& line);
+
+    /**
+     * \param line a line of the [flows] section
+     */
+    void ParseFlow(const std::string& line);
+
+    /**
+     * \return the "file:line: " prefix of error messages
+     */
+    std::string Where() const;
+
+    std::string m_filename;                                        //!< file loaded
+    uint32_t m_line;                                               //!< line being parsed
+    std::vector<std::pair<std::string, std::string>> m_parameters; //!< [parameters]
+    std::vector<Vector> m_enbs;                                    //!< [enbs]
+    std::vector<UeGroup> m_ueGroups;                               //!< [ues]
+    std::vector<FlowSpec> m_flows;                                 //!< [flows]
+};
+
+} // namespace ns3
+
+#endif /* SCENARIO_FILE_H */
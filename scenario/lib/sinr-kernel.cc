@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "sinr-kernel.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SINR_KERNEL_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SinrKernel");
+
+namespace
+{
+
+/// Implementation in use
+SinrKernel::Implementation g_implementation = SinrKernel::SCALAR;
+
+/// Whether g_implementation was chosen yet
+bool g_selected = false;
+
+/**
+ * \param sum the accumulated signals
+ * \param psd a signal
+ * \param n number of RBs
+ */
+void
+AccumulateScalar(double* sum, const double* psd, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        sum[i] += psd[i];
+    }
+}
+
+/**
+ * \param all all signals
+ * \param rx the signal being received
+ * \param noise the noise
+ * \param sinr receives the SINR
+ * \param n number of RBs
+ */
+void
+ComputeSinrScalar(const double* all,
+                  const double* rx,
+                  const double* noise,
+                  double* sinr,
+                  std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        sinr[i] = rx[i] / ((all[i] - rx[i]) + noise[i]);
+    }
+}
+
+#ifdef SINR_KERNEL_AVX2
+/// AccumulateScalar() on four RBs at a time
+__attribute__((target("avx2"))) void
+AccumulateAvx2(double* sum, const double* psd, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d s = _mm256_loadu_pd(sum + i);
+        __m256d p = _mm256_loadu_pd(psd + i);
+        _mm256_storeu_pd(sum + i, _mm256_add_pd(s, p));
+    }
+    for (; i < n; i++)
+    {
+        sum[i] += psd[i];
+    }
+}
+
+/// ComputeSinrScalar() on four RBs at a time
+__attribute__((target("avx2"))) void
+ComputeSinrAvx2(const double* all,
+                const double* rx,
+                const double* noise,
+                double* sinr,
+                std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d a = _mm256_loadu_pd(all + i);
+        __m256d r = _mm256_loadu_pd(rx + i);
+        __m256d w = _mm256_loadu_pd(noise + i);
+        // Same order as the scalar loop, so the results are identical
+        __m256d interference = _mm256_add_pd(_mm256_sub_pd(a, r), w);
+        _mm256_storeu_pd(sinr + i, _mm256_div_pd(r, interference));
+    }
+    for (; i < n; i++)
+    {
+        sinr[i] = rx[i] / ((all[i] - rx[i]) + noise[i]);
+    }
+}
+#endif
+
+/// \return the implementation, selecting AUTO on first use
+SinrKernel::Implementation
+Selected()
+{
+    if (!g_selected)
+    {
+        SinrKernel::SetImplementation(SinrKernel::AUTO);
+    }
+    return g_implementation;
+}
+
+} // namespace
+
+SinrKernel::Implementation
+SinrKernel::ParseImplementation(const std::string& name)
+{
+    if (name == "auto")
+    {
+        return AUTO;
+    }
+    if (name == "scalar")
+    {
+        return SCALAR;
+    }
+    if (name == "avx2")
+    {
+        return AVX2;
+    }
+    NS_FATAL_ERROR("Unknown SINR kernel " << name << ", use auto, scalar or avx2");
+}
+
+bool
+SinrKernel::IsAvx2Supported()
+{
+#ifdef SINR_KERNEL_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void
+SinrKernel::SetImplementation(Implementation implementation)
+{
+    if (implementation == AUTO)
+    {
+        implementation = IsAvx2Supported() ? AVX2 : SCALAR;
+    }
+    NS_ABORT_MSG_IF(implementation == AVX2 && !IsAvx2Supported(),
+                    "The AVX2 SINR kernel is not supported by this build or CPU");
+    g_implementation = implementation;
+    g_selected = true;
+    NS_LOG_INFO("SINR kernel " << GetImplementationName());
+}
+
+SinrKernel::Implementation
+SinrKernel::GetImplementation()
+{
+    return Selected();
+}
+
+std::string
+SinrKernel::GetImplementationName()
+{
+    return Selected() == AVX2 ? "avx2" : "scalar";
+}
+
+void
+SinrKernel::Accumulate(double* sum, const double* psd, std::size_t n)
+{
+#ifdef SINR_KERNEL_AVX2
+    if (Selected() == AVX2)
+    {
+        AccumulateAvx2(sum, psd, n);
+        return;
+    }
+#endif
+    AccumulateScalar(sum, psd, n);
+}
+
+void
+SinrKernel::ComputeSinr(const double* all,
+                        const double* rx,
+                        const double* noise,
+                        double* sinr,
+                        std::size_t n)
+{
+#ifdef SINR_KERNEL_AVX2
+    if (Selected() == AVX2)
+    {
+        ComputeSinrAvx2(all, rx, noise, sinr, n);
+        return;
+    }
+#endif
+    ComputeSinrScalar(all, rx, noise, sinr, n);
+}
+
+void
+SinrKernel::Accumulate(SpectrumValue& sum, const SpectrumValue& psd)
+{
+    NS_ASSERT_MSG(sum.GetSpectrumModel() == psd.GetSpectrumModel(), "Different spectrum models");
+    Accumulate(&*sum.ValuesBegin(), &*psd.ConstValuesBegin(), sum.GetValuesN());
+}
+
+SpectrumValue
+SinrKernel::ComputeSinr(const SpectrumValue& all,
+                        const SpectrumValue& rx,
+                        const SpectrumValue& noise)
+{
+    NS_ASSERT_MSG(all.GetSpectrumModel() == rx.GetSpectrumModel() &&
+                      all.GetSpectrumModel() == noise.GetSpectrumModel(),
+                  "Different spectrum models");
+    SpectrumValue sinr(all.GetSpectrumModel());
+    ComputeSinr(&*all.ConstValuesBegin(),
+                &*rx.ConstValuesBegin(),
+                &*noise.ConstValuesBegin(),
+                &*sinr.ValuesBegin(),
+                all.GetValuesN());
+    return sinr;
+}
+
+} // namespace ns3
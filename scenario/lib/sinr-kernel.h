@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SINR_KERNEL_H
+#define SINR_KERNEL_H
+
+#include "ns3/spectrum-value.h"
+
+#include <cstddef>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Per-resource-block interference accumulation and SINR, as done by
+ * LteInterference for every chunk of every received transmission:
+ *
+ * \verbatim
+   allSignals += psd                          for every signal on the channel
+   sinr = rx / ((allSignals - rx) + noise)    per RB, at every chunk end
+   \endverbatim
+ *
+ * Two implementations are selectable at run time:
+ * - "scalar": the plain loops of SpectrumValue's operators
+ * - "avx2": four RBs per instruction; compiled for AVX2 through a function
+ *   target attribute, so the library itself needs no -mavx2, and only used
+ *   if the CPU supports it
+ *
+ * Both perform the same IEEE operations in the same order per RB (no fused
+ * multiply-add, no reassociation), so their results are bit-for-bit equal
+ * to each other and to the SpectrumValue operators; sinr-bench checks that.
+ *
+ * \code
+ *   SinrKernel::SetImplementation(SinrKernel::ParseImplementation("auto"));
+ *   SinrKernel::Accumulate(allSignals, *psd);
+ *   SpectrumValue sinr = SinrKernel::ComputeSinr(allSignals, rxSignal, noise);
+ * \endcode
+ */
+class SinrKernel
+{
+  public:
+    /// Kernel implementations
+    enum Implementation
+    {
+        AUTO,
+        SCALAR,
+        AVX2
+    };
+
+    /**
+     * \param name "auto", "scalar" or "avx2"
+     * \return the implementation
+     */
+    static Implementation ParseImplementation(const std::string& name);
+
+    /**
+     * Select the implementation; AUTO picks AVX2 if the CPU supports it.
+     *
+     * \param implementation the implementation
+     */
+    static void SetImplementation(Implementation implementation);
+
+    /// \return the implementation in use, never AUTO
+    static Implementation GetImplementation();
+
+    /// \return the name of the implementation in use
+    static std::string GetImplementationName();
+
+    /// \return whether this build and CPU can run the AVX2 kernel
+    static bool IsAvx2Supported();
+
+    /**
+     * sum += psd, per RB.
+     *
+     * \param sum the accumulated signals
+     * \param psd a signal
+     * \param n number of RBs
+     */
+    static void Accumulate(double* sum, const double* psd, std::size_t n);
+
+    /**
+     * sinr = rx / ((all - rx) + noise), per RB.
+     *
+     * \param all all signals on the channel, including rx
+     * \param rx the signal being received
+     * \param noise the noise
+     * \param sinr receives the SINR
+     * \param n number of RBs
+     */
+    static void ComputeSinr(const double* all,
+                            const double* rx,
+                            const double* noise,
+                            double* sinr,
+                            std::size_t n);
+
+    /**
+     * \param sum the accumulated signals
+     * \param psd a signal, of the same spectrum model
+     */
+    static void Accumulate(SpectrumValue& sum, const SpectrumValue& psd);
+
+    /**
+     * \param all all signals on the channel, including rx
+     * \param rx the signal being received
+     * \param noise the noise
+     * \return the SINR, of the same spectrum model
+     */
+    static SpectrumValue ComputeSinr(const SpectrumValue& all,
+                                     const SpectrumValue& rx,
+                                     const SpectrumValue& noise);
+};
+
+} // namespace ns3
+
+#endif /* SINR_KERNEL_H */
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "traffic-installer.h"
+
+#include "ns3/abort.h"
+#include "ns3/applications-module.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TrafficInstaller");
+
+TrafficInstaller::TrafficInstaller(const std::string& clientType,
+                                   const std::string& socketFactory)
+    : m_systemId(0)
+{
+    m_client.SetTypeId(clientType);
+    m_sink.SetTypeId("ns3::PacketSink");
+    m_sink.Set("Protocol", StringValue(socketFactory));
+}
+
+void
+TrafficInstaller::SetClientAttribute(const std::string& name, const AttributeValue& value)
+{
+    m_client.Set(name, value);
+}
+
+void
+TrafficInstaller::SetSinkAttribute(const std::string& name, const AttributeValue& value)
+{
+    m_sink.Set(name, value);
+}
+
+void
+TrafficInstaller::SetStartTime(Time start)
+{
+    m_client.Set("StartTime", TimeValue(start));
+    m_sink.Set("StartTime", TimeValue(start));
+}
+
+void
+TrafficInstaller::SetStopTime(Time stop)
+{
+    m_client.Set("StopTime", TimeValue(stop));
+    m_sink.Set("StopTime", TimeValue(stop));
+}
+
+void
+TrafficInstaller::SetSystemId(uint32_t systemId)
+{
+    m_systemId = systemId;
+}
+
+ApplicationContainer
+TrafficInstaller::Install(const NodeContainer& clients,
+                          const NodeContainer& sinks,
+                          const std::vector<Ipv4Address>& sinkAddresses,
+                          uint16_t port,
+                          uint16_t portStep)
+{
+    uint32_t flows = std::max({clients.GetN(), sinks.GetN(), uint32_t(sinkAddresses.size())});
+    if (flows == 0)
+    {
+        return ApplicationContainer();
+    }
+    NS_ABORT_MSG_IF(clients.GetN() == 0 || sinks.GetN() == 0 || sinkAddresses.empty(),
+                    "Flows need clients, sinks and sink addresses");
+    NS_ABORT_MSG_IF((clients.GetN() != 1 && clients.GetN() != flows) ||
+                        (sinks.GetN() != 1 && sinks.GetN() != flows) ||
+                        (sinkAddresses.size() != 1 && sinkAddresses.size() != flows),
+                    "Clients, sinks and sink addresses must have one or " << flows << " entries");
+    NS_LOG_FUNCTION(this << flows << port << portStep);
+
+    ApplicationContainer apps;
+    bool sharedSink = sinks.GetN() == 1 && portStep == 0;
+    for (uint32_t i = 0; i < flows; i++)
+    {
+        uint16_t flowPort = port + i * portStep;
+        Ipv4Address address = sinkAddresses[sinkAddresses.size() == 1 ? 0 : i];
+
+        Ptr<Node> sinkNode = sinks.Get(sinks.GetN() == 1 ? 0 : i);
+        if ((!sharedSink || i == 0) && IsLocal(sinkNode))
+        {
+            m_sink.Set("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny(), flowPort)));
+            Ptr<Application> sink = m_sink.Create<Application>();
+            sinkNode->AddApplication(sink);
+            apps.Add(sink);
+        }
+
+        Ptr<Node> clientNode = clients.Get(clients.GetN() == 1 ? 0 : i);
+        if (!IsLocal(clientNode))
+        {
+            continue;
+        }
+        Ptr<Application> client = m_client.Create<Application>();
+        if (Ptr<UdpClient> udpClient = DynamicCast<UdpClient>(client))
+        {
+            udpClient->SetRemote(InetSocketAddress(address, flowPort));
+        }
+        else
+        {
+            client->SetAttribute("Remote", AddressValue(InetSocketAddress(address, flowPort)));
+        }
+        clientNode->AddApplication(client);
+        apps.Add(client);
+    }
+    return apps;
+}
+
+ApplicationContainer
+TrafficInstaller::InstallDownlink(Ptr<Node> server,
+                                  const NodeContainer& ues,
+                                  const std::vector<Ipv4Address>& ueAddresses,
+                                  uint16_t port)
+{
+    if (ues.GetN() == 0)
+    {
+        return ApplicationContainer();
+    }
+    return Install(NodeContainer(server), ues, ueAddresses, port);
+}
+
+ApplicationContainer
+TrafficInstaller::InstallUplink(const NodeContainer& ues,
+                                Ptr<Node> server,
+                                Ipv4Address serverAddress,
+                                uint16_t firstPort)
+{
+    if (ues.GetN() == 0)
+    {
+        return ApplicationContainer();
+    }
+    return Install(ues, NodeContainer(server), {serverAddress}, firstPort, 1);
+}
+
+ApplicationContainer
+TrafficInstaller::InstallPeer(const NodeContainer& ues,
+                              const std::vector<Ipv4Address>& ueAddresses,
+                              uint16_t firstPort)
+{
+    NodeContainer peers;
+    for (uint32_t i = 0; i < ues.GetN(); i++)
+    {
+        peers.Add(ues.Get((i + 1) % ues.GetN()));
+    }
+    return Install(peers, ues, ueAddresses, firstPort, 1);
+}
+
+std::vector<Ipv4Address>
+TrafficInstaller::GetAddresses(const Ipv4InterfaceContainer& interfaces)
+{
+    std::vector<Ipv4Address> addresses;
+    addresses.reserve(interfaces.GetN());
+    for (uint32_t i = 0; i < interfaces.GetN(); i++)
+    {
+        addresses.push_back(interfaces.GetAddress(i));
+    }
+    return addresses;
+}
+
+bool
+TrafficInstaller::IsLocal(Ptr<Node> node) const
+{
+    return node->GetSystemId() == m_systemId;
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRAFFIC_INSTALLER_H
+#define TRAFFIC_INSTALLER_H
+
+#include "ns3/application-container.h"
+#include "ns3/internet-module.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Installs client/sink flows for whole node containers in one pass.
+ *
+ * The per-UE helper loops of the examples construct a PacketSinkHelper and a
+ * UdpClientHelper per UE and direction, parsing every attribute again. Here
+ * the client and sink factories, start and stop time included, are configured
+ * once; every flow then costs two Create() calls and setting the remote
+ * address, directly on UdpClient and through the "Remote" attribute for other
+ * clients (e.g. BulkSendApplication).
+ *
+ * In a distributed simulation only the applications of nodes belonging to the
+ * local system (rank) are installed, see SetSystemId().
+ *
+ * \code
+ *   TrafficInstaller dl("ns3::UdpClient", "ns3::UdpSocketFactory");
+ *   dl.SetClientAttribute("Interval", TimeValue(MilliSeconds(100)));
+ *   dl.SetStartTime(MilliSeconds(500));
+ *   dl.InstallDownlink(remoteHost, ueNodes, ueAddresses, 1100);
+ * \endcode
+ */
+class TrafficInstaller
+{
+  public:
+    /**
+     * \param clientType TypeId name of the client application
+     * \param socketFactory TypeId name of the sinks' socket factory
+     */
+    TrafficInstaller(const std::string& clientType, const std::string& socketFactory);
+
+    /**
+     * \param name attribute name
+     * \param value attribute value
+     */
+    void SetClientAttribute(const std::string& name, const AttributeValue& value);
+
+    /**
+     * \param name attribute name
+     * \param value attribute value
+     */
+    void SetSinkAttribute(const std::string& name, const AttributeValue& value);
+
+    /**
+     * \param start start time of the applications installed from now on; like
+     *        every Application start time it counts from the installation
+     */
+    void SetStartTime(Time start);
+
+    /**
+     * \param stop stop time of the applications installed from now on, also
+     *        counted from the installation
+     */
+    void SetStopTime(Time stop);
+
+    /**
+     * \param systemId the local system (MPI rank); applications of nodes of other
+     *        systems are skipped, default 0
+     */
+    void SetSystemId(uint32_t systemId);
+
+    /**
+     * Install flow i from clients[i] to a sink on sinks[i], listening on
+     * port + i * portStep of sinkAddresses[i]. A container or address list
+     * holding a single entry is used for every flow; a single sink node with
+     * portStep 0 gets a single sink. Nothing is installed if all are empty.
+     *
+     * \param clients client nodes
+     * \param sinks sink nodes
+     * \param sinkAddresses sink addresses
+     * \param port port of the first flow
+     * \param portStep port increment per flow
+     * \return the clients and sinks installed
+     */
+    ApplicationContainer Install(const NodeContainer& clients,
+                                 const NodeContainer& sinks,
+                                 const std::vector<Ipv4Address>& sinkAddresses,
+                                 uint16_t port,
+                                 uint16_t portStep = 0);
+
+    /**
+     * One flow from the server to every UE, all on the same port.
+     *
+     * \param server the server node
+     * \param ues the UE nodes
+     * \param ueAddresses the UE addresses
+     * \param port the port
+     * \return the clients and sinks installed
+     */
+    ApplicationContainer InstallDownlink(Ptr<Node> server,
+                                         const NodeContainer& ues,
+                                         const std::vector<Ipv4Address>& ueAddresses,
+                                         uint16_t port);
+
+    /**
+     * One flow from every UE to the server, on ports firstPort, firstPort + 1, ...
+     *
+     * \param ues the UE nodes
+     * \param server the server node
+     * \param serverAddress the server address
+     * \param firstPort the port of the first UE
+     * \return the clients and sinks installed
+     */
+    ApplicationContainer InstallUplink(const NodeContainer& ues,
+                                       Ptr<Node> server,
+                                       Ipv4Address serverAddress,
+                                       uint16_t firstPort);
+
+    /**
+     * One flow from UE (i + 1) % N to every UE i, on ports firstPort,
+     * firstPort + 1, ...
+     *
+     * \param ues the UE nodes
+     * \param ueAddresses the UE addresses
+     * \param firstPort the port of the first UE
+     * \return the clients and sinks installed
+     */
+    ApplicationContainer InstallPeer(const NodeContainer& ues,
+                                     const std::vector<Ipv4Address>& ueAddresses,
+                                     uint16_t firstPort);
+
+    /**
+     * \param interfaces IPv4 interfaces
+     * \return their addresses
+     */
+    static std::vector<Ipv4Address> GetAddresses(const Ipv4InterfaceContainer& interfaces);
+
+  private:
+    /**
+     * \param node a node
+     * \return whether the node belongs to the local system
+     */
+    bool IsLocal(Ptr<Node> node) const;
+
+    ObjectFactory m_client; //!< client factory
+    ObjectFactory m_sink;   //!< PacketSink factory
+    uint32_t m_systemId;    //!< local system
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_INSTALLER_H */
@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "traffic-mix.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TrafficMix");
+
+namespace
+{
+
+/**
+ * Stream of the class shuffle. It is fixed, unlike the automatically numbered
+ * streams, so that the assignment does not depend on how many random variables
+ * the process created before, e.g. on an MPI rank without LTE devices.
+ */
+const int64_t SHUFFLE_STREAM = 1000000;
+
+} // namespace
+
+TrafficMix::TrafficMix(const std::string& mix)
+    : m_percent{100, 0, 0}
+{
+    std::stringstream ss(mix);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (token.empty())
+        {
+            continue;
+        }
+        std::size_t colon = token.find(':');
+        NS_ABORT_MSG_IF(colon == std::string::npos, "Expected class:percent, got " << token);
+        std::string name = token.substr(0, colon);
+        double percent = std::stod(token.substr(colon + 1));
+        NS_ABORT_MSG_IF(percent < 0, "Negative share for " << name);
+        if (name == "video")
+        {
+            m_percent[VIDEO] += percent;
+        }
+        else if (name == "ftp")
+        {
+            m_percent[FTP] += percent;
+        }
+        else
+        {
+            NS_FATAL_ERROR("Unknown traffic class " << name << ", expected video or ftp");
+        }
+    }
+    // Shares like video:66.7,ftp:33.3 may add up to a hair above 100
+    m_percent[IDLE] = 100 - m_percent[VIDEO] - m_percent[FTP];
+    NS_ABORT_MSG_IF(m_percent[IDLE] < -1e-9, "The traffic mix " << mix << " exceeds 100%");
+    m_percent[IDLE] = std::max(m_percent[IDLE], 0.0);
+}
+
+double
+TrafficMix::GetPercent(Class c) const
+{
+    return m_percent[c];
+}
+
+std::vector<TrafficMix::Class>
+TrafficMix::Assign(uint32_t ues) const
+{
+    // Every UE goes to the class furthest behind its share so far, which
+    // ends within one UE of every share
+    std::vector<Class> classes;
+    classes.reserve(ues);
+    uint32_t assigned[CLASSES] = {0, 0, 0};
+    for (uint32_t i = 0; i < ues; i++)
+    {
+        int best = IDLE;
+        double bestDeficit = -1;
+        for (int c = IDLE; c < CLASSES; c++)
+        {
+            double deficit = m_percent[c] / 100 * (i + 1) - assigned[c];
+            if (m_percent[c] > 0 && deficit > bestDeficit)
+            {
+                best = c;
+                bestDeficit = deficit;
+            }
+        }
+        assigned[best]++;
+        classes.push_back(static_cast<Class>(best));
+    }
+
+    // The interleave is periodic, and so is the placement of UEs on sites
+    // (UE i at site i % sites); shuffle so that no class piles up on a site
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable>();
+    uniform->SetStream(SHUFFLE_STREAM);
+    for (uint32_t i = ues; i > 1; i--)
+    {
+        std::swap(classes[i - 1], classes[uniform->GetInteger(0, i - 1)]);
+    }
+    return classes;
+}
+
+} // namespace ns3
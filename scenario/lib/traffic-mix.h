@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRAFFIC_MIX_H
+#define TRAFFIC_MIX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Assignment of traffic classes to UEs by percentages.
+ *
+ * A mix is written "video:20,ftp:10": 20% of the UEs receive a video stream,
+ * 10% take part in an FTP transfer and the remaining 70% are idle. The count
+ * of every class is within one UE of its share; which UEs get it is shuffled
+ * with a fixed random stream, so that it does not follow the placement of the
+ * UEs on the sites in turn and every site gets about the same mix, while every
+ * process of a run (e.g. every MPI rank) draws the same assignment.
+ *
+ * \code
+ *   TrafficMix mix("video:20,ftp:10");
+ *   std::vector<TrafficMix::Class> classes = mix.Assign(ueNodes.GetN());
+ * \endcode
+ */
+class TrafficMix
+{
+  public:
+    /// Traffic classes
+    enum Class
+    {
+        IDLE,
+        VIDEO,
+        FTP,
+        CLASSES
+    };
+
+    /**
+     * \param mix comma separated list of class:percent, empty for no traffic
+     */
+    explicit TrafficMix(const std::string& mix = "");
+
+    /**
+     * \param c a traffic class
+     * \return the share of the UEs in that class [%]
+     */
+    double GetPercent(Class c) const;
+
+    /**
+     * Draw the class of every UE; the shuffle uses a fixed stream, so it
+     * depends on the RngRun only.
+     *
+     * \param ues number of UEs
+     * \return the class of every UE
+     */
+    std::vector<Class> Assign(uint32_t ues) const;
+
+  private:
+    double m_percent[CLASSES]; //!< share per class [%]
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_MIX_H */
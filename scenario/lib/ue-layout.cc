@@ -0,0 +1,200 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ue-layout.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("UeLayout");
+
+namespace
+{
+
+/// Position of the first site, matching the "line" layout
+const double ORIGIN_X = 200;
+/// Position of the first site, matching the "line" layout
+const double ORIGIN_Y = 700;
+
+} // namespace
+
+UeLayout::Type
+UeLayout::ParseType(const std::string& name)
+{
+    if (name == "line")
+    {
+        return LINE;
+    }
+    if (name == "hex")
+    {
+        return HEX;
+    }
+    if (name == "clusters")
+    {
+        return CLUSTERS;
+    }
+    NS_FATAL_ERROR("Unknown UE layout " << name << ", expected line, hex or clusters");
+}
+
+UeLayout::UeLayout()
+    : m_type(LINE),
+      m_siteDistance(300),
+      m_clusters(0),
+      m_clusterRadius(50)
+{
+}
+
+void
+UeLayout::SetType(Type type)
+{
+    m_type = type;
+}
+
+void
+UeLayout::SetSiteDistance(double distance)
+{
+    NS_ABORT_MSG_IF(distance <= 0, "The inter-site distance must be positive");
+    m_siteDistance = distance;
+}
+
+void
+UeLayout::SetClusters(uint32_t clusters, double radius)
+{
+    NS_ABORT_MSG_IF(radius <= 0, "The cluster radius must be positive");
+    m_clusters = clusters;
+    m_clusterRadius = radius;
+}
+
+std::vector<Vector>
+UeLayout::GetSitePositions(uint32_t sites) const
+{
+    std::vector<Vector> positions;
+    if (m_type == LINE)
+    {
+        for (uint32_t i = 0; i < sites; i++)
+        {
+            positions.emplace_back(ORIGIN_X + m_siteDistance * i, ORIGIN_Y, 0);
+        }
+        return positions;
+    }
+
+    // Rows of a roughly square hexagonal grid, odd rows shifted by half a site
+    uint32_t columns = std::ceil(std::sqrt(sites));
+    double rowDistance = m_siteDistance * std::sqrt(3.0) / 2;
+    for (uint32_t i = 0; i < sites; i++)
+    {
+        uint32_t row = i / columns;
+        uint32_t column = i % columns;
+        double x = ORIGIN_X + m_siteDistance * (column + (row % 2) * 0.5);
+        positions.emplace_back(x, ORIGIN_Y + rowDistance * row, 0);
+    }
+    return positions;
+}
+
+std::vector<Vector>
+UeLayout::GetUePositions(const std::vector<Vector>& sites, uint32_t ues) const
+{
+    NS_ABORT_MSG_IF(sites.empty(), "UEs need at least one site");
+    std::vector<Vector> positions;
+    positions.reserve(ues);
+
+    if (m_type == LINE)
+    {
+        for (uint32_t i = 0; i < ues; i++)
+        {
+            double x = 200 + 300.0 * (i % 3) + 20.0 * std::cos(2 * M_PI * i / ues);
+            double y = 700 + 20.0 * std::sin(2 * M_PI * i / ues);
+            positions.emplace_back(x, y, 0);
+        }
+        return positions;
+    }
+
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable>();
+    if (m_type == HEX)
+    {
+        for (uint32_t i = 0; i < ues; i++)
+        {
+            positions.push_back(DrawInHexagon(sites[i % sites.size()], uniform));
+        }
+        return positions;
+    }
+
+    Rectangle bounds = GetBounds(sites);
+    std::vector<Vector> hotspots;
+    uint32_t clusters = m_clusters == 0 ? sites.size() : m_clusters;
+    for (uint32_t c = 0; c < clusters; c++)
+    {
+        hotspots.emplace_back(uniform->GetValue(bounds.xMin, bounds.xMax),
+                              uniform->GetValue(bounds.yMin, bounds.yMax),
+                              0);
+    }
+    for (uint32_t i = 0; i < ues; i++)
+    {
+        const Vector& hotspot = hotspots[i % clusters];
+        double r = m_clusterRadius * std::sqrt(uniform->GetValue());
+        double phi = uniform->GetValue(0, 2 * M_PI);
+        double x = std::clamp(hotspot.x + r * std::cos(phi), bounds.xMin, bounds.xMax);
+        double y = std::clamp(hotspot.y + r * std::sin(phi), bounds.yMin, bounds.yMax);
+        positions.emplace_back(x, y, 0);
+    }
+    return positions;
+}
+
+Rectangle
+UeLayout::GetBounds(const std::vector<Vector>& sites) const
+{
+    if (m_type == LINE)
+    {
+        return Rectangle(150, 850, 150, 850);
+    }
+
+    // Sites extended by one hexagon radius
+    double radius = m_siteDistance / std::sqrt(3.0);
+    Rectangle bounds(sites.front().x, sites.front().x, sites.front().y, sites.front().y);
+    for (const auto& site : sites)
+    {
+        bounds.xMin = std::min(bounds.xMin, site.x - radius);
+        bounds.xMax = std::max(bounds.xMax, site.x + radius);
+        bounds.yMin = std::min(bounds.yMin, site.y - radius);
+        bounds.yMax = std::max(bounds.yMax, site.y + radius);
+    }
+    return bounds;
+}
+
+Vector
+UeLayout::DrawInHexagon(const Vector& center, Ptr<UniformRandomVariable> uniform) const
+{
+    // Rows of sites make pointy-top hexagons, whose inradius is half the
+    // inter-site distance; rejection sampling from their bounding box
+    double inradius = m_siteDistance / 2;
+    double radius = m_siteDistance / std::sqrt(3.0);
+    while (true)
+    {
+        double dx = uniform->GetValue(-inradius, inradius);
+        double dy = uniform->GetValue(-radius, radius);
+        if (std::abs(dx) / 2 + std::abs(dy) * std::sqrt(3.0) / 2 <= inradius)
+        {
+            return Vector(center.x + dx, center.y + dy, 0);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef UE_LAYOUT_H
+#define UE_LAYOUT_H
+
+#include "ns3/random-variable-stream.h"
+#include "ns3/rectangle.h"
+#include "ns3/vector.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Placement of eNB sites and UEs.
+ *
+ * Layouts:
+ * - "line": the original project layout, eNBs on a line at 200 + distance * i
+ *   and UEs on 20 m circles around x = 200, 500 and 800, in turn
+ * - "hex": eNB sites on a hexagonal grid with the given inter-site distance,
+ *   UEs spread evenly over the sites, uniformly within each site's hexagon
+ * - "clusters": eNB sites as for "hex", UEs uniformly within discs (hotspots)
+ *   whose centers are drawn uniformly over the deployment area
+ *
+ * \code
+ *   UeLayout layout;
+ *   layout.SetType(UeLayout::HEX);
+ *   layout.SetSiteDistance(500);
+ *   std::vector<Vector> sites = layout.GetSitePositions(30);
+ *   std::vector<Vector> ues = layout.GetUePositions(sites, 3000);
+ * \endcode
+ */
+class UeLayout
+{
+  public:
+    /// Layout types
+    enum Type
+    {
+        LINE,
+        HEX,
+        CLUSTERS
+    };
+
+    /**
+     * \param name "line", "hex" or "clusters"
+     * \return the layout type
+     */
+    static Type ParseType(const std::string& name);
+
+    UeLayout();
+
+    /**
+     * \param type the layout type
+     */
+    void SetType(Type type);
+
+    /**
+     * \param distance distance between neighbouring eNB sites [m]
+     */
+    void SetSiteDistance(double distance);
+
+    /**
+     * Configure the hotspots of the "clusters" layout.
+     *
+     * \param clusters number of hotspots, 0 for one per site
+     * \param radius hotspot radius [m]
+     */
+    void SetClusters(uint32_t clusters, double radius);
+
+    /**
+     * \param sites number of eNB sites
+     * \return the site positions
+     */
+    std::vector<Vector> GetSitePositions(uint32_t sites) const;
+
+    /**
+     * Draw UE positions, from the simulator's random number generator.
+     *
+     * \param sites the site positions, from GetSitePositions()
+     * \param ues number of UEs
+     * \return the UE positions, inside GetBounds()
+     */
+    std::vector<Vector> GetUePositions(const std::vector<Vector>& sites, uint32_t ues) const;
+
+    /**
+     * \param sites the site positions
+     * \return the area UEs are placed and walk in
+     */
+    Rectangle GetBounds(const std::vector<Vector>& sites) const;
+
+  private:
+    /**
+     * \param center the site position
+     * \param uniform uniform random variable
+     * \return a point uniformly within the site's hexagon
+     */
+    Vector DrawInHexagon(const Vector& center, Ptr<UniformRandomVariable> uniform) const;
+
+    Type m_type;            //!< layout type
+    double m_siteDistance;  //!< inter-site distance [m]
+    uint32_t m_clusters;    //!< hotspots, 0 for one per site
+    double m_clusterRadius; //!< hotspot radius [m]
+};
+
+} // namespace ns3
+
+#endif /* UE_LAYOUT_H */
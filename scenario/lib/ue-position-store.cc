@@ -0,0 +1,232 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ue-position-store.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("UePositionStore");
+
+NS_OBJECT_ENSURE_REGISTERED(StoredMobilityModel);
+
+namespace
+{
+
+/**
+ * Fold a straight walk back into [min, max], bouncing off both ends.
+ *
+ * \param start start coordinate [m]
+ * \param speed start velocity [m/s]
+ * \param t time since the start [s]
+ * \param min lower bound [m]
+ * \param max upper bound [m]
+ * \param position receives the coordinate [m]
+ * \param velocity receives the velocity [m/s]
+ */
+inline void
+Fold(double start,
+     double speed,
+     double t,
+     double min,
+     double max,
+     double& position,
+     double& velocity)
+{
+    double length = max - min;
+    if (length <= 0)
+    {
+        position = min;
+        velocity = 0;
+        return;
+    }
+    // Unfolded, the walk repeats every 2 * length: forth, then back
+    double u = std::fmod(start - min + speed * t, 2 * length);
+    if (u < 0)
+    {
+        u += 2 * length;
+    }
+    bool back = u > length;
+    position = min + (back ? 2 * length - u : u);
+    velocity = back ? -speed : speed;
+}
+
+} // namespace
+
+UePositionStore::UePositionStore()
+    : m_valid(false),
+      m_updates(0)
+{
+}
+
+uint32_t
+UePositionStore::Add(const Vector& position, const Vector& velocity, const Rectangle& bounds)
+{
+    NS_ABORT_MSG_IF(!bounds.IsInside(position),
+                    "Walker at " << position << " outside of its bounds " << bounds);
+    m_startX.push_back(position.x);
+    m_startY.push_back(position.y);
+    m_startTime.push_back(Simulator::Now().GetSeconds());
+    m_speedX.push_back(velocity.x);
+    m_speedY.push_back(velocity.y);
+    m_minX.push_back(bounds.xMin);
+    m_minY.push_back(bounds.yMin);
+    m_maxX.push_back(bounds.xMax);
+    m_maxY.push_back(bounds.yMax);
+    m_z.push_back(position.z);
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_vx.push_back(velocity.x);
+    m_vy.push_back(velocity.y);
+    m_valid = false;
+    return m_startX.size() - 1;
+}
+
+void
+UePositionStore::Install(const NodeContainer& nodes,
+                         Ptr<PositionAllocator> positions,
+                         double speed,
+                         const Rectangle& bounds)
+{
+    if (!m_direction)
+    {
+        m_direction = CreateObject<UniformRandomVariable>();
+    }
+    Ptr<UePositionStore> self(this);
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        NS_ABORT_MSG_IF(node->GetObject<MobilityModel>(),
+                        "Node " << node->GetId() << " already has a mobility model");
+        double direction = m_direction->GetValue(0, 2 * M_PI);
+        Vector velocity(speed * std::cos(direction), speed * std::sin(direction), 0);
+        Ptr<StoredMobilityModel> model = CreateObject<StoredMobilityModel>();
+        model->SetStore(self, Add(positions->GetNext(), velocity, bounds));
+        node->AggregateObject(model);
+    }
+}
+
+void
+UePositionStore::SetPosition(uint32_t index, const Vector& position)
+{
+    Update();
+    m_startX[index] = position.x;
+    m_startY[index] = position.y;
+    m_startTime[index] = m_time.GetSeconds();
+    m_speedX[index] = m_vx[index];
+    m_speedY[index] = m_vy[index];
+    m_z[index] = position.z;
+    m_x[index] = position.x;
+    m_y[index] = position.y;
+}
+
+void
+UePositionStore::Update()
+{
+    Time now = Simulator::Now();
+    if (m_valid && now == m_time)
+    {
+        return;
+    }
+    m_time = now;
+    m_valid = true;
+    m_updates++;
+
+    // One pass over contiguous arrays, no virtual calls or events per walker
+    double t = now.GetSeconds();
+    std::size_t n = m_startX.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        double dt = t - m_startTime[i];
+        Fold(m_startX[i], m_speedX[i], dt, m_minX[i], m_maxX[i], m_x[i], m_vx[i]);
+        Fold(m_startY[i], m_speedY[i], dt, m_minY[i], m_maxY[i], m_y[i], m_vy[i]);
+    }
+}
+
+Vector
+UePositionStore::GetPosition(uint32_t index)
+{
+    Update();
+    return Vector(m_x[index], m_y[index], m_z[index]);
+}
+
+Vector
+UePositionStore::GetVelocity(uint32_t index)
+{
+    Update();
+    return Vector(m_vx[index], m_vy[index], 0);
+}
+
+uint32_t
+UePositionStore::GetN() const
+{
+    return m_startX.size();
+}
+
+uint64_t
+UePositionStore::GetUpdates() const
+{
+    return m_updates;
+}
+
+TypeId
+StoredMobilityModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::StoredMobilityModel")
+                            .SetParent<MobilityModel>()
+                            .SetGroupName("Mobility")
+                            .AddConstructor<StoredMobilityModel>();
+    return tid;
+}
+
+StoredMobilityModel::StoredMobilityModel()
+    : m_index(0)
+{
+}
+
+void
+StoredMobilityModel::SetStore(Ptr<UePositionStore> store, uint32_t index)
+{
+    NS_ABORT_MSG_IF(index >= store->GetN(), "No walker " << index << " in the store");
+    m_store = store;
+    m_index = index;
+}
+
+Vector
+StoredMobilityModel::DoGetPosition() const
+{
+    return m_store->GetPosition(m_index);
+}
+
+void
+StoredMobilityModel::DoSetPosition(const Vector& position)
+{
+    m_store->SetPosition(m_index, position);
+    NotifyCourseChange();
+}
+
+Vector
+StoredMobilityModel::DoGetVelocity() const
+{
+    return m_store->GetVelocity(m_index);
+}
+
+} // namespace ns3
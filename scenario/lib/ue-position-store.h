@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef UE_POSITION_STORE_H
+#define UE_POSITION_STORE_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rectangle.h"
+#include "ns3/simple-ref-count.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Positions and velocities of a whole UE population in contiguous arrays,
+ * one array per coordinate.
+ *
+ * The project's walkers move in a straight line at constant speed and
+ * bounce off the edges of their rectangle, like a RandomWalk2dMobilityModel
+ * whose walk lasts the whole run. Their position is thus a closed-form
+ * function of time: unfold the bounces into a straight line and fold it back
+ * into the rectangle. The store evaluates that function for every UE in one
+ * pass over the arrays the first time a position is asked for at a new
+ * simulation time, and serves the per-node queries of the PHY, NetAnim and
+ * others at that time from the result. No rebound or course change events
+ * are scheduled.
+ *
+ * Nodes use the store through a StoredMobilityModel each:
+ *
+ * \code
+ *   Ptr<UePositionStore> store = Create<UePositionStore>();
+ *   store->Install(ueNodes, positionAlloc, 2.0, Rectangle(0, 1000, 0, 1000));
+ * \endcode
+ */
+class UePositionStore : public SimpleRefCount<UePositionStore>
+{
+  public:
+    UePositionStore();
+
+    /**
+     * Add a walker, starting now.
+     *
+     * \param position its position
+     * \param velocity its velocity [m/s], z is ignored
+     * \param bounds the rectangle it bounces in
+     * \return its index
+     */
+    uint32_t Add(const Vector& position, const Vector& velocity, const Rectangle& bounds);
+
+    /**
+     * Add a StoredMobilityModel walker to every node, heading in a direction
+     * drawn uniformly from [0, 2 pi).
+     *
+     * \param nodes the nodes, without a mobility model
+     * \param positions allocator of the start positions
+     * \param speed walking speed [m/s]
+     * \param bounds the rectangle they bounce in
+     */
+    void Install(const NodeContainer& nodes,
+                 Ptr<PositionAllocator> positions,
+                 double speed,
+                 const Rectangle& bounds);
+
+    /**
+     * Move a walker; it keeps its velocity.
+     *
+     * \param index the walker
+     * \param position its new position
+     */
+    void SetPosition(uint32_t index, const Vector& position);
+
+    /**
+     * \param index a walker
+     * \return its position now
+     */
+    Vector GetPosition(uint32_t index);
+
+    /**
+     * \param index a walker
+     * \return its velocity now
+     */
+    Vector GetVelocity(uint32_t index);
+
+    /// \return number of walkers
+    uint32_t GetN() const;
+
+    /// \return passes over the population so far
+    uint64_t GetUpdates() const;
+
+  private:
+    /// Evaluate every walker at the current simulation time, once per time
+    void Update();
+
+    // Walk of every walker: start position and time, velocity and bounds
+    std::vector<double> m_startX;    //!< start x [m]
+    std::vector<double> m_startY;    //!< start y [m]
+    std::vector<double> m_startTime; //!< start time [s]
+    std::vector<double> m_speedX;    //!< start x velocity [m/s]
+    std::vector<double> m_speedY;    //!< start y velocity [m/s]
+    std::vector<double> m_minX;      //!< bounds [m]
+    std::vector<double> m_minY;      //!< bounds [m]
+    std::vector<double> m_maxX;      //!< bounds [m]
+    std::vector<double> m_maxY;      //!< bounds [m]
+    std::vector<double> m_z;         //!< height [m]
+
+    // Evaluated at m_time
+    std::vector<double> m_x;  //!< x [m]
+    std::vector<double> m_y;  //!< y [m]
+    std::vector<double> m_vx; //!< x velocity [m/s]
+    std::vector<double> m_vy; //!< y velocity [m/s]
+
+    Time m_time;                            //!< time of the evaluation
+    bool m_valid;                           //!< the evaluation is of m_time
+    uint64_t m_updates;                     //!< passes so far
+    Ptr<UniformRandomVariable> m_direction; //!< heading of installed walkers
+};
+
+/**
+ * Mobility model of one walker of a UePositionStore.
+ */
+class StoredMobilityModel : public MobilityModel
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    StoredMobilityModel();
+
+    /**
+     * \param store the store
+     * \param index the walker in the store
+     */
+    void SetStore(Ptr<UePositionStore> store, uint32_t index);
+
+  private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    Ptr<UePositionStore> m_store; //!< the store
+    uint32_t m_index;             //!< the walker in the store
+};
+
+} // namespace ns3
+
+#endif /* UE_POSITION_STORE_H */
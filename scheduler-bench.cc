@@ -0,0 +1,324 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// CPU cost and fairness benchmark of the LTE FF MAC schedulers.
+//
+// Runs the scenario of project.cc once per scheduler of --schedulers, each
+// wrapped in a ProfiledFfMacScheduler, and reports per run:
+// - the wall time the scheduler spends per TTI and carrier, in all SCHED SAP
+//   requests and in the DL/UL trigger requests alone, and its share of the run
+// - the application throughput delivered per cell
+// - Jain's fairness index of the DL throughput of the UEs that have a flow
+//   addressed to them
+// - the mean delay and loss of the video flows
+// Every run is a forked process, one at a time, like project-bench. The other
+// project parameters (--numberOfUes, --numberOfEnbs, --layout, --trafficMix,
+// ...) apply to every run. Schedulers are given by their short name (rr, pf,
+// pss, cqa, tdmt, tta, fdmt, tdbet, fdbet, fdtbfq, tdtbfq) or TypeId name.
+//
+// The report is a CSV file with one row per run; --label tags the rows.
+//
+//   ./ns3 run "scheduler-bench --numberOfUes=600 --numberOfEnbs=3 --trafficMix=video:30,ftp:10"
+
+#include "scenario/lib/flow-post-processor.h"
+#include "scenario/lib/profiled-ff-mac-scheduler.h"
+#include "scenario/lib/project-scenario.h"
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/lte-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SchedulerBench");
+
+/// Measurements of one benchmark run, passed from the child through a pipe
+struct BenchResult
+{
+    double runSeconds{0};         //!< wall time of Simulator::Run() [s]
+    uint64_t ttis{0};             //!< scheduled TTIs, summed over the carriers
+    int64_t schedulerNs{0};       //!< wall time in the schedulers [ns]
+    int64_t triggerNs{0};         //!< wall time in the trigger requests [ns]
+    double cellThroughputMbps{0}; //!< received application data per cell [Mb/s]
+    double jainFairness{0};       //!< Jain's index of the UEs' DL throughput
+    uint32_t fairnessUes{0};      //!< UEs in the fairness index
+    double videoDelayMs{0};       //!< mean delay of the video packets [ms]
+    double videoLossPercent{0};   //!< lost video packets [%]
+};
+
+/**
+ * \param name short name or TypeId name of a scheduler
+ * \return its TypeId name
+ */
+static std::string
+ResolveScheduler(const std::string& name)
+{
+    static const std::map<std::string, std::string> schedulers{
+        {"rr", "ns3::RrFfMacScheduler"},
+        {"pf", "ns3::PfFfMacScheduler"},
+        {"pss", "ns3::PssFfMacScheduler"},
+        {"cqa", "ns3::CqaFfMacScheduler"},
+        {"tdmt", "ns3::TdMtFfMacScheduler"},
+        {"tta", "ns3::TtaFfMacScheduler"},
+        {"fdmt", "ns3::FdMtFfMacScheduler"},
+        {"tdbet", "ns3::TdBetFfMacScheduler"},
+        {"fdbet", "ns3::FdBetFfMacScheduler"},
+        {"fdtbfq", "ns3::FdTbfqFfMacScheduler"},
+        {"tdtbfq", "ns3::TdTbfqFfMacScheduler"},
+    };
+    auto it = schedulers.find(name);
+    std::string type = it != schedulers.end() ? it->second : name;
+    TypeId tid;
+    NS_ABORT_MSG_IF(!TypeId::LookupByNameFailSafe(type, &tid) ||
+                        !tid.IsChildOf(FfMacScheduler::GetTypeId()),
+                    "Unknown FF MAC scheduler " << name);
+    return type;
+}
+
+/**
+ * Split a comma separated list.
+ *
+ * \param text the list
+ * \return the items
+ */
+static std::vector<std::string>
+ParseList(const std::string& text)
+{
+    std::vector<std::string> values;
+    std::stringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (!token.empty())
+        {
+            values.push_back(token);
+        }
+    }
+    return values;
+}
+
+/**
+ * Build and run the scenario once with a scheduler, in the calling process.
+ *
+ * \param params the scenario parameters
+ * \param scheduler TypeId name of the scheduler
+ * \return the measurements
+ */
+static BenchResult
+RunScenario(const ProjectParameters& params, const std::string& scheduler)
+{
+    using Clock = std::chrono::steady_clock;
+    BenchResult result;
+
+    Config::SetDefault("ns3::LteHelper::Scheduler",
+                       StringValue(ProfiledFfMacScheduler::GetTypeId().GetName()));
+    Config::SetDefault("ns3::ProfiledFfMacScheduler::Scheduler", StringValue(scheduler));
+    // Beyond a few dozen UEs per cell the default SRS period runs out of
+    // configuration indexes; 320 ms allows for 320 UEs per cell
+    if (params.numberOfUes > 20 * params.numberOfEnbs)
+    {
+        Config::SetDefault("ns3::LteEnbRrc::SrsPeriodicity", UintegerValue(320));
+    }
+
+    ProjectScenario scenario(params);
+    scenario.ConfigureDefaults();
+    scenario.Build();
+    LteEpcTopology& topology = scenario.GetTopology();
+    FlowMonitorHelper flowMonHelper;
+    flowMonHelper.Install(topology.GetEnbNodes());
+    flowMonHelper.Install(topology.GetUeNodes());
+    flowMonHelper.Install(topology.GetRemoteHost());
+
+    Simulator::Stop(Seconds(params.simTime));
+    auto start = Clock::now();
+    Simulator::Run();
+    result.runSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Scheduler cost, over every carrier of every eNB
+    NetDeviceContainer enbDevices = topology.GetEnbDevices();
+    for (auto it = enbDevices.Begin(); it != enbDevices.End(); ++it)
+    {
+        Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(*it);
+        for (const auto& cc : enb->GetCcMap())
+        {
+            Ptr<ComponentCarrierEnb> carrier = DynamicCast<ComponentCarrierEnb>(cc.second);
+            Ptr<ProfiledFfMacScheduler> profiled =
+                DynamicCast<ProfiledFfMacScheduler>(carrier->GetFfMacScheduler());
+            NS_ABORT_MSG_IF(!profiled, "The LteHelper did not install the profiled scheduler");
+            result.ttis += profiled->GetTtis();
+            result.schedulerNs += profiled->GetNanoseconds();
+            result.triggerNs += profiled->GetTriggerNanoseconds();
+        }
+    }
+
+    Ptr<FlowMonitor> monitor = flowMonHelper.GetMonitor();
+    monitor->CheckForLostPackets();
+    FlowPostProcessor post;
+    post.SetClasses("video:" + std::to_string(ProjectScenario::VIDEO_PORT) +
+                    ",ftp:" + std::to_string(ProjectScenario::FTP_PORT));
+    post.Process(monitor, DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier()));
+
+    // Cell throughput and the DL throughput of every UE with traffic; -1
+    // marks UEs no flow is addressed to
+    std::map<uint32_t, double> ueThroughput;
+    for (uint32_t i = 0; i < topology.GetUeNodes().GetN(); i++)
+    {
+        ueThroughput[topology.GetUeAddress(i).Get()] = -1;
+    }
+    uint64_t rxBytes = 0;
+    for (const auto& flow : post.GetFlows())
+    {
+        rxBytes += flow.rxBytes;
+        auto ue = ueThroughput.find(flow.dstAddress.Get());
+        if (ue != ueThroughput.end() && flow.txPackets > 0)
+        {
+            ue->second = std::max(ue->second, 0.0) + flow.rxBytes * 8 / params.simTime;
+        }
+    }
+    result.cellThroughputMbps = rxBytes * 8 / params.simTime / 1e6 / params.numberOfEnbs;
+
+    double sum = 0;
+    double sumOfSquares = 0;
+    for (const auto& ue : ueThroughput)
+    {
+        if (ue.second >= 0)
+        {
+            sum += ue.second;
+            sumOfSquares += ue.second * ue.second;
+            result.fairnessUes++;
+        }
+    }
+    if (sumOfSquares > 0)
+    {
+        result.jainFairness = sum * sum / (result.fairnessUes * sumOfSquares);
+    }
+
+    for (const auto& stats : post.GetClasses())
+    {
+        if (stats.name == "video" && stats.rxPackets > 0)
+        {
+            result.videoDelayMs = stats.delaySum / stats.rxPackets * 1000;
+            result.videoLossPercent =
+                100.0 * (stats.txPackets - stats.rxPackets) / stats.txPackets;
+        }
+    }
+    Simulator::Destroy();
+    return result;
+}
+
+/**
+ * Run the scenario in a child process and collect its measurements.
+ *
+ * \param params the scenario parameters
+ * \param scheduler TypeId name of the scheduler
+ * \param result the measurements, valid if true is returned
+ * \return whether the child completed
+ */
+static bool
+RunChild(const ProjectParameters& params, const std::string& scheduler, BenchResult& result)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+
+    std::cout.flush();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        BenchResult r = RunScenario(params, scheduler);
+        bool ok = write(fds[1], &r, sizeof(r)) == static_cast<ssize_t>(sizeof(r));
+        close(fds[1]);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t n = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return n == static_cast<ssize_t>(sizeof(result)) && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    ProjectParameters params;
+    params.simTime = 10.0;
+    std::string schedulers = "rr,pf,pss,cqa,tdmt,tta,fdmt,tdbet,fdbet,fdtbfq,tdtbfq";
+    uint32_t repetitions = 1;
+    std::string report = "scheduler-bench.csv";
+    std::string label = "";
+
+    CommandLine cmd;
+    params.AddCommandLineValues(cmd);
+    cmd.AddValue("schedulers", "Comma separated list of schedulers", schedulers);
+    cmd.AddValue("repetitions", "Runs of every scheduler", repetitions);
+    cmd.AddValue("report", "CSV file receiving the measurements", report);
+    cmd.AddValue("label", "Tag written in every row of the report", label);
+    cmd.Parse(argc, argv);
+
+    std::ofstream out(report);
+    NS_ABORT_MSG_IF(!out.is_open(), "Cannot open " << report);
+    out << "label,scheduler,numberOfUes,numberOfEnbs,simTime,repetition,status,runSeconds,"
+           "ttis,schedulerNsPerTti,triggerNsPerTti,schedulerPercent,cellThroughputMbps,"
+           "jainFairness,fairnessUes,videoDelayMs,videoLossPercent\n";
+
+    for (const std::string& name : ParseList(schedulers))
+    {
+        std::string scheduler = ResolveScheduler(name);
+        for (uint32_t rep = 0; rep < repetitions; rep++)
+        {
+            std::cout << scheduler << ", run " << rep << ": " << std::flush;
+
+            BenchResult r;
+            bool ok = RunChild(params, scheduler, r);
+            out << label << "," << scheduler << "," << params.numberOfUes << ","
+                << params.numberOfEnbs << "," << params.simTime << "," << rep << ","
+                << (ok ? "ok" : "failed");
+            if (!ok || r.ttis == 0)
+            {
+                out << ",,,,,,,,,,\n";
+                std::cout << "FAILED\n";
+                continue;
+            }
+            double nsPerTti = double(r.schedulerNs) / r.ttis;
+            double triggerNsPerTti = double(r.triggerNs) / r.ttis;
+            double percent = r.schedulerNs / 1e9 / r.runSeconds * 100;
+            out << "," << r.runSeconds << "," << r.ttis << "," << nsPerTti << ","
+                << triggerNsPerTti << "," << percent << "," << r.cellThroughputMbps << ","
+                << r.jainFairness << "," << r.fairnessUes << "," << r.videoDelayMs << ","
+                << r.videoLossPercent << "\n";
+            out.flush();
+            std::cout << nsPerTti / 1e3 << " us/TTI (" << percent << "% of the run), "
+                      << r.cellThroughputMbps << " Mb/s per cell, Jain " << r.jainFairness
+                      << ", video " << r.videoDelayMs << " ms / " << r.videoLossPercent
+                      << "% lost\n";
+        }
+    }
+    std::cout << "Report written to " << report << std::endl;
+    return 0;
+}
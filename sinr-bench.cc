@@ -0,0 +1,265 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Verification and benchmark of the SINR kernel.
+//
+// Replays the per-RB work of LteInterference for a project-like deployment:
+// every TTI, for every UE and component carrier, the signals of all eNBs are
+// accumulated and the SINR of the serving eNB's signal is computed. This is
+// done with the SpectrumValue operators, exactly as LteInterference does it,
+// and with every SinrKernel implementation the build and CPU support. The
+// results of every implementation must be bit-for-bit equal to the
+// SpectrumValue ones; the program aborts otherwise and reports nanoseconds per
+// RB and the speedup of each implementation.
+//
+// The speedups are relative to the SpectrumValue operators on preallocated
+// values (+=, -=, /=), so they measure the kernel and not the allocations.
+// LteInterference's binary operators allocate a temporary per operation; their
+// time is reported on a row of its own.
+//
+//   ./ns3 run "sinr-bench --rbs=75 --enbs=3 --ues=300 --carriers=2 --ttis=1000"
+
+#include "scenario/lib/sinr-kernel.h"
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-model.h"
+#include "ns3/spectrum-value.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SinrBench");
+
+/// Received signals of one UE on one carrier
+struct Reception
+{
+    std::vector<Ptr<SpectrumValue>> psds; //!< PSD of every eNB, serving one first
+};
+
+/**
+ * SINR of every reception with the SpectrumValue operators, as in
+ * LteInterference::AddSignal() and LteInterference::ConditionallyEvaluateChunk(),
+ * which allocate a temporary SpectrumValue per operation.
+ *
+ * \param receptions the receptions
+ * \param noise the noise PSD
+ * \param sinrs receives the SINR of every reception
+ */
+static void
+RunTemporaries(const std::vector<Reception>& receptions,
+               const SpectrumValue& noise,
+               std::vector<SpectrumValue>& sinrs)
+{
+    for (std::size_t r = 0; r < receptions.size(); r++)
+    {
+        const Reception& reception = receptions[r];
+        SpectrumValue allSignals(noise.GetSpectrumModel());
+        for (const auto& psd : reception.psds)
+        {
+            allSignals += *psd;
+        }
+        const SpectrumValue& rxSignal = *reception.psds.front();
+        SpectrumValue interf = allSignals - rxSignal + noise;
+        sinrs[r] = rxSignal / interf;
+    }
+}
+
+/**
+ * SINR of every reception with the in-place SpectrumValue operators on
+ * preallocated values, in the same order of operations as RunTemporaries().
+ *
+ * \param receptions the receptions
+ * \param noise the noise PSD
+ * \param allSignals buffer of the accumulated signals
+ * \param interf buffer of the interference and noise
+ * \param sinrs receives the SINR of every reception
+ */
+static void
+RunSpectrumValue(const std::vector<Reception>& receptions,
+                 const SpectrumValue& noise,
+                 SpectrumValue& allSignals,
+                 SpectrumValue& interf,
+                 std::vector<SpectrumValue>& sinrs)
+{
+    for (std::size_t r = 0; r < receptions.size(); r++)
+    {
+        const Reception& reception = receptions[r];
+        allSignals = 0.0;
+        for (const auto& psd : reception.psds)
+        {
+            allSignals += *psd;
+        }
+        const SpectrumValue& rxSignal = *reception.psds.front();
+        interf = allSignals;
+        interf -= rxSignal;
+        interf += noise;
+        sinrs[r] = rxSignal;
+        sinrs[r] /= interf;
+    }
+}
+
+/**
+ * SINR of every reception with the SinrKernel.
+ *
+ * \param receptions the receptions
+ * \param noise the noise PSD
+ * \param allSignals buffer of the accumulated signals
+ * \param sinrs receives the SINR of every reception
+ */
+static void
+RunKernel(const std::vector<Reception>& receptions,
+          const SpectrumValue& noise,
+          SpectrumValue& allSignals,
+          std::vector<SpectrumValue>& sinrs)
+{
+    std::size_t n = noise.GetValuesN();
+    for (std::size_t r = 0; r < receptions.size(); r++)
+    {
+        const Reception& reception = receptions[r];
+        double* all = &*allSignals.ValuesBegin();
+        std::fill(all, all + n, 0.0);
+        for (const auto& psd : reception.psds)
+        {
+            SinrKernel::Accumulate(all, &*psd->ConstValuesBegin(), n);
+        }
+        SinrKernel::ComputeSinr(all,
+                                &*reception.psds.front()->ConstValuesBegin(),
+                                &*noise.ConstValuesBegin(),
+                                &*sinrs[r].ValuesBegin(),
+                                n);
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t rbs = 75;
+    uint32_t enbs = 3;
+    uint32_t ues = 300;
+    uint32_t carriers = 2;
+    uint32_t ttis = 1000;
+
+    CommandLine cmd;
+    cmd.AddValue("rbs", "Resource blocks per carrier", rbs);
+    cmd.AddValue("enbs", "eNBs heard by every UE", enbs);
+    cmd.AddValue("ues", "UEs", ues);
+    cmd.AddValue("carriers", "Component carriers per UE", carriers);
+    cmd.AddValue("ttis", "TTIs replayed", ttis);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(rbs == 0 || enbs == 0 || ues == 0 || carriers == 0 || ttis == 0,
+                    "All sizes must be positive");
+
+    // 180 kHz RBs from 2.12 GHz, as the LTE spectrum models
+    std::vector<double> frequencies;
+    for (uint32_t i = 0; i < rbs; i++)
+    {
+        frequencies.push_back(2.12e9 + 180e3 * i);
+    }
+    Ptr<SpectrumModel> model = Create<SpectrumModel>(frequencies);
+
+    // Received PSDs spread over 60 dB, thermal noise with a 9 dB noise figure
+    Ptr<UniformRandomVariable> exponent = CreateObject<UniformRandomVariable>();
+    std::vector<Reception> receptions(ues * carriers);
+    for (auto& reception : receptions)
+    {
+        for (uint32_t e = 0; e < enbs; e++)
+        {
+            Ptr<SpectrumValue> psd = Create<SpectrumValue>(model);
+            for (auto it = psd->ValuesBegin(); it != psd->ValuesEnd(); ++it)
+            {
+                *it = std::pow(10.0, exponent->GetValue(-19, -13));
+            }
+            reception.psds.push_back(psd);
+        }
+    }
+    SpectrumValue noise(model);
+    noise = 1.38e-23 * 290 * std::pow(10.0, 0.9);
+
+    std::vector<SpectrumValue> reference(receptions.size(), SpectrumValue(model));
+    SpectrumValue referenceSignals(model);
+    SpectrumValue referenceInterf(model);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < ttis; t++)
+    {
+        RunSpectrumValue(receptions, noise, referenceSignals, referenceInterf, reference);
+    }
+    double referenceSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double rbCount = double(ttis) * receptions.size() * rbs;
+
+    std::vector<SpectrumValue> temporaries(receptions.size(), SpectrumValue(model));
+    start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < ttis; t++)
+    {
+        RunTemporaries(receptions, noise, temporaries);
+    }
+    double temporariesSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (std::size_t r = 0; r < receptions.size(); r++)
+    {
+        NS_ABORT_MSG_IF(std::memcmp(&*temporaries[r].ConstValuesBegin(),
+                                    &*reference[r].ConstValuesBegin(),
+                                    rbs * sizeof(double)) != 0,
+                        "The in-place operators differ from the binary ones in reception "
+                            << r);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "implementation     ns/RB  speedup\n";
+    std::cout << "SpectrumValue+tmp  " << temporariesSeconds * 1e9 / rbCount << "  "
+              << referenceSeconds / temporariesSeconds << "\n";
+    std::cout << "SpectrumValue      " << referenceSeconds * 1e9 / rbCount << "  1.000\n";
+
+    std::vector<SinrKernel::Implementation> implementations{SinrKernel::SCALAR};
+    if (SinrKernel::IsAvx2Supported())
+    {
+        implementations.push_back(SinrKernel::AVX2);
+    }
+    for (auto implementation : implementations)
+    {
+        SinrKernel::SetImplementation(implementation);
+        SpectrumValue allSignals(model);
+        std::vector<SpectrumValue> sinrs(receptions.size(), SpectrumValue(model));
+        start = std::chrono::steady_clock::now();
+        for (uint32_t t = 0; t < ttis; t++)
+        {
+            RunKernel(receptions, noise, allSignals, sinrs);
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (std::size_t r = 0; r < receptions.size(); r++)
+        {
+            NS_ABORT_MSG_IF(std::memcmp(&*sinrs[r].ConstValuesBegin(),
+                                        &*reference[r].ConstValuesBegin(),
+                                        rbs * sizeof(double)) != 0,
+                            "The " << SinrKernel::GetImplementationName()
+                                   << " kernel differs from SpectrumValue in reception " << r);
+        }
+        std::cout << std::left << std::setw(19) << SinrKernel::GetImplementationName()
+                  << std::right << seconds * 1e9 / rbCount << "  "
+                  << referenceSeconds / seconds << "\n";
+    }
+    std::cout << "all kernels bit-for-bit equal to SpectrumValue over " << receptions.size()
+              << " receptions of " << rbs << " RBs\n";
+    return 0;
+}